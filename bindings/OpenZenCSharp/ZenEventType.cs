@@ -14,6 +14,11 @@ public enum ZenEventType {
   ZenEventType_SensorFound = 1,
   ZenEventType_SensorListingProgress = 2,
   ZenEventType_SensorDisconnected = 3,
+  ZenEventType_SensorLost = 4,
+  ZenEventType_SensorObtained = 5,
+  ZenEventType_SensorConnectionLost = 6,
+  ZenEventType_SensorReconnected = 7,
+  ZenEventType_UpdateProgress = 8,
   ZenEventType_ImuData = 100,
   ZenEventType_GnssData = 200,
   ZenEventType_SensorSpecific_Start = 1000,
@@ -45,6 +45,7 @@ ZenEvents about sensor discovery results and incoming measurement data.
 #include <chrono>
 #include <cstddef>
 #include <cstring>
+#include <future>
 #include <string>
 #include <thread>
 #include <utility>
@@ -102,6 +103,33 @@ namespace details
     {
         using type = std::integral_constant<ZenPropertyType, ZenPropertyType_UInt64>;
     };
+
+    /** Owns the values of an asynchronous batch of properties until the sensor has processed it */
+    struct AsyncProperties
+    {
+        using Result = std::pair<ZenError, std::vector<ZenPropertyValue>>;
+
+        std::promise<Result> promise;
+        std::vector<ZenPropertyValue> values;
+
+        static void complete(ZenError error, ZenPropertyValue*, size_t, void* userData)
+        {
+            auto batch = static_cast<AsyncProperties*>(userData);
+            batch->promise.set_value(std::make_pair(error, std::move(batch->values)));
+            delete batch;
+        }
+
+        template <typename F>
+        static std::future<Result> queue(std::vector<ZenPropertyValue> values, F&& queueFunc)
+        {
+            auto batch = new AsyncProperties{ {}, std::move(values) };
+            auto future = batch->promise.get_future();
+            if (auto error = queueFunc(batch->values.data(), batch->values.size(), &AsyncProperties::complete, batch))
+                complete(error, nullptr, 0, batch);
+
+            return future;
+        }
+    };
 }
 
 namespace zen
@@ -279,6 +307,46 @@ namespace zen
             return ZenSensorComponentSetUInt64Property(m_clientHandle, m_sensorHandle, m_componentHandle, property, value);
         }
 
+        /**
+         * Reads a batch of properties on this sensor component, while streaming is
+         * suspended only once. The result of every property is stored in its entry.
+         */
+        ZenError getProperties(std::vector<ZenPropertyValue>& values) noexcept
+        {
+            return ZenSensorComponentGetProperties(m_clientHandle, m_sensorHandle, m_componentHandle, values.data(), values.size());
+        }
+
+        /**
+         * Writes a batch of properties on this sensor component, while streaming is
+         * suspended only once. The result of every property is stored in its entry.
+         */
+        ZenError setProperties(std::vector<ZenPropertyValue>& values) noexcept
+        {
+            return ZenSensorComponentSetProperties(m_clientHandle, m_sensorHandle, m_componentHandle, values.data(), values.size());
+        }
+
+        /**
+         * Reads a batch of properties on this sensor component without blocking, see
+         * ZenSensor::getPropertiesAsync
+         */
+        std::future<std::pair<ZenError, std::vector<ZenPropertyValue>>> getPropertiesAsync(std::vector<ZenPropertyValue> values)
+        {
+            return details::AsyncProperties::queue(std::move(values), [this](ZenPropertyValue* data, size_t size, ZenPropertiesCallback callback, void* userData) {
+                return ZenSensorComponentGetPropertiesAsync(m_clientHandle, m_sensorHandle, m_componentHandle, data, size, callback, userData);
+            });
+        }
+
+        /**
+         * Writes a batch of properties on this sensor component without blocking, see
+         * ZenSensor::getPropertiesAsync
+         */
+        std::future<std::pair<ZenError, std::vector<ZenPropertyValue>>> setPropertiesAsync(std::vector<ZenPropertyValue> values)
+        {
+            return details::AsyncProperties::queue(std::move(values), [this](ZenPropertyValue* data, size_t size, ZenPropertiesCallback callback, void* userData) {
+                return ZenSensorComponentSetPropertiesAsync(m_clientHandle, m_sensorHandle, m_componentHandle, data, size, callback, userData);
+            });
+        }
+
         /**
          * Starts forwarding the RTK-GPS corrections to the sensor.
          * This method call is only supported on components of type GNSS.
@@ -403,6 +471,81 @@ namespace zen
             return ZenPublishEvents(m_clientHandle, m_sensorHandle, endpoint.c_str());
         }
 
+        /**
+         * Publish all data events from this sensor over a network interface, see ZenPublishOptions
+         */
+        ZenError publishEvents(std::string const& endpoint, ZenPublishOptions const& options) noexcept {
+            return ZenPublishEventsWithOptions(m_clientHandle, m_sensorHandle, endpoint.c_str(), &options);
+        }
+
+        /**
+         * Reconnect the sensor in the background when its connection is lost and
+         * restore its configuration, see ZenSensorSetAutoReconnect
+         */
+        ZenError setAutoReconnect(bool enabled) noexcept
+        {
+            return ZenSensorSetAutoReconnect(m_clientHandle, m_sensorHandle, enabled);
+        }
+
+        /**
+         * Returns the configuration of the sensor and its components as a binary blob,
+         * which can be applied to this or another sensor of the same type with
+         * importConfiguration, see ZenSensorExportConfiguration
+         */
+        std::pair<ZenError, std::vector<unsigned char>> exportConfiguration() noexcept
+        {
+            std::vector<unsigned char> configuration(4096);
+            size_t size = configuration.size();
+            auto error = ZenSensorExportConfiguration(m_clientHandle, m_sensorHandle, configuration.data(), &size);
+            if (error == ZenError_BufferTooSmall)
+            {
+                configuration.resize(size);
+                error = ZenSensorExportConfiguration(m_clientHandle, m_sensorHandle, configuration.data(), &size);
+            }
+
+            configuration.resize(error == ZenError_None ? size : 0);
+            return std::make_pair(error, std::move(configuration));
+        }
+
+        /**
+         * Applies a configuration obtained with exportConfiguration
+         */
+        ZenError importConfiguration(const std::vector<unsigned char>& configuration) noexcept
+        {
+            return ZenSensorImportConfiguration(m_clientHandle, m_sensorHandle, configuration.data(), configuration.size());
+        }
+
+        /**
+         * Returns the round-trip times of the requests sent to the sensor
+         */
+        std::pair<ZenError, ZenRoundTripStatistics> roundTripStatistics() noexcept
+        {
+            ZenRoundTripStatistics statistics{};
+            const auto error = ZenSensorRoundTripStatistics(m_clientHandle, m_sensorHandle, &statistics);
+            return std::make_pair(error, statistics);
+        }
+
+        /**
+         * Returns the lost and reordered messages and their latency, for a sensor which receives the events of another OpenZen instance.
+         * Requires the publisher to send sequence numbers, see ZenPublishOptions::sequenceNumbers.
+         */
+        std::pair<ZenError, ZenStreamingStatistics> streamingStatistics() noexcept
+        {
+            ZenStreamingStatistics statistics{};
+            const auto error = ZenSensorStreamingStatistics(m_clientHandle, m_sensorHandle, &statistics);
+            return std::make_pair(error, statistics);
+        }
+
+        /**
+         * Returns the sent and dropped messages of the endpoint on which this sensor publishes its events
+         */
+        std::pair<ZenError, ZenPublishStatistics> publishStatistics() noexcept
+        {
+            ZenPublishStatistics statistics{};
+            const auto error = ZenSensorPublishStatistics(m_clientHandle, m_sensorHandle, &statistics);
+            return std::make_pair(error, statistics);
+        }
+
         /**
          * Execute a sensor property which supports to be executed
          */
@@ -539,6 +682,46 @@ namespace zen
             return ZenSensorSetUInt64Property(m_clientHandle, m_sensorHandle, property, value);
         }
 
+        /**
+         * Reads a batch of properties of this sensor, while streaming is suspended
+         * only once. The result of every property is stored in its entry.
+         */
+        ZenError getProperties(std::vector<ZenPropertyValue>& values) noexcept
+        {
+            return ZenSensorGetProperties(m_clientHandle, m_sensorHandle, values.data(), values.size());
+        }
+
+        /**
+         * Writes a batch of properties of this sensor, while streaming is suspended
+         * only once. The result of every property is stored in its entry.
+         */
+        ZenError setProperties(std::vector<ZenPropertyValue>& values) noexcept
+        {
+            return ZenSensorSetProperties(m_clientHandle, m_sensorHandle, values.data(), values.size());
+        }
+
+        /**
+         * Reads a batch of properties of this sensor without blocking. The future holds the
+         * first error of the batch, and the values with the result of every property. Batches
+         * of one sensor are processed in order, different sensors are configured concurrently.
+         */
+        std::future<std::pair<ZenError, std::vector<ZenPropertyValue>>> getPropertiesAsync(std::vector<ZenPropertyValue> values)
+        {
+            return details::AsyncProperties::queue(std::move(values), [this](ZenPropertyValue* data, size_t size, ZenPropertiesCallback callback, void* userData) {
+                return ZenSensorGetPropertiesAsync(m_clientHandle, m_sensorHandle, data, size, callback, userData);
+            });
+        }
+
+        /**
+         * Writes a batch of properties of this sensor without blocking, see getPropertiesAsync
+         */
+        std::future<std::pair<ZenError, std::vector<ZenPropertyValue>>> setPropertiesAsync(std::vector<ZenPropertyValue> values)
+        {
+            return details::AsyncProperties::queue(std::move(values), [this](ZenPropertyValue* data, size_t size, ZenPropertiesCallback callback, void* userData) {
+                return ZenSensorSetPropertiesAsync(m_clientHandle, m_sensorHandle, data, size, callback, userData);
+            });
+        }
+
         /**
          * Returns an instance of a sensor component on this sensor. type can be either
          * g_zenSensorType_Imu or g_zenSensorType_Gnss. If a requested sensor component
@@ -631,6 +814,15 @@ namespace zen
             return ZenListSensorsAsync(m_handle);
         }
 
+        /** After calling ZenClient::subscribeToDeviceChanges, a ZenSensorEvent_SensorFound event is queued
+         * whenever a sensor is plugged in and a ZenSensorEvent_SensorLost event whenever a sensor is removed.
+         * This allows to react to new sensors without repeatedly calling ZenClient::listSensorsAsync.
+         */
+        ZenError subscribeToDeviceChanges() noexcept
+        {
+            return ZenSubscribeToDeviceChanges(m_handle);
+        }
+
         /**
          * Connect to a sensor with the ZenSensorDesc which was obtained via a call to listSensorsAsync
          */
@@ -641,6 +833,50 @@ namespace zen
             return std::make_pair(error, ZenSensor(m_handle, sensorHandle));
         }
 
+        /**
+         * Connect to multiple sensors in parallel. The method returns immediately and a
+         * ZenEventType_SensorObtained event is queued for every sensor description once its
+         * connection is established or has failed. Use ZenClient::sensorFromHandle to access the
+         * sensor of a successful event.
+         */
+        ZenError obtainSensorsAsync(const std::vector<ZenSensorDesc>& descs) noexcept
+        {
+            return ZenObtainSensorsAsync(m_handle, descs.data(), descs.size());
+        }
+
+        /**
+         * Starts firmware updates of several sensors in parallel, which share a single copy
+         * of the firmware. Returns the status of every sensor, and each sensor queues
+         * ZenEventType_UpdateProgress events. ZenSensor::updateFirmwareAsync reports when
+         * the update of a sensor is complete.
+         */
+        std::pair<ZenError, std::vector<ZenAsyncStatus>> updateFirmwareAsync(const std::vector<ZenSensorHandle_t>& sensors,
+            const std::vector<unsigned char>& firmware) noexcept
+        {
+            std::vector<ZenAsyncStatus> statuses(sensors.size(), ZenAsync_InvalidArgument);
+            const auto error = ZenSensorsUpdateFirmwareAsync(m_handle, sensors.data(), sensors.size(), firmware.data(), firmware.size(), statuses.data());
+            return std::make_pair(error, std::move(statuses));
+        }
+
+        /**
+         * Starts IAP updates of several sensors in parallel, see updateFirmwareAsync
+         */
+        std::pair<ZenError, std::vector<ZenAsyncStatus>> updateIAPAsync(const std::vector<ZenSensorHandle_t>& sensors,
+            const std::vector<unsigned char>& iap) noexcept
+        {
+            std::vector<ZenAsyncStatus> statuses(sensors.size(), ZenAsync_InvalidArgument);
+            const auto error = ZenSensorsUpdateIAPAsync(m_handle, sensors.data(), sensors.size(), iap.data(), iap.size(), statuses.data());
+            return std::make_pair(error, std::move(statuses));
+        }
+
+        /**
+         * Returns the sensor of a ZenEvent, e.g. of a successful ZenEventType_SensorObtained event
+         */
+        ZenSensor sensorFromHandle(ZenSensorHandle_t sensorHandle) noexcept
+        {
+            return ZenSensor(m_handle, sensorHandle);
+        }
+
         /**
          * Sensors can also connected directly if the IO system they are connected too and their name
          * is known already. Here, the method ZenClient::obtainSensorByName can be called with the
@@ -54,11 +54,27 @@ extern "C" {
      */
     ZEN_API ZenError ZenListSensorsAsync(ZenClientHandle_t handle);
 
+    /** Opts in to notifications about sensors which are plugged in or removed while the client is running.
+     * ZenEventData_SensorFound events will be queued when a sensor is attached.
+     * ZenEventData_SensorLost events will be queued when a sensor is detached.
+     * Only IO systems which can monitor their devices (e.g. LinuxDevice) report these changes.
+     */
+    ZEN_API ZenError ZenSubscribeToDeviceChanges(ZenClientHandle_t handle);
+
     /** Obtain a sensor from the client */
     ZEN_API ZenSensorInitError ZenObtainSensor(ZenClientHandle_t clientHandle,
         const ZenSensorDesc* const desc,
         ZenSensorHandle_t* outSensorHandle);
 
+    /** Obtain multiple sensors in parallel. The call returns immediately and one
+     * ZenEventData_SensorObtained event will be queued for every sensor description, once the
+     * connection is established or has failed. On success, the sensor field of the event holds
+     * the handle of the obtained sensor.
+     */
+    ZEN_API ZenError ZenObtainSensorsAsync(ZenClientHandle_t clientHandle,
+        const ZenSensorDesc* const descs,
+        size_t nDescs);
+
     /** Obtain a sensor from the client giving directly the IO sub-system and sensor identifier.
         This method can be called without listing the sensor first with a call to ZenListSensorsAsync
         if the ioType and identifier of a sensor is known.
@@ -87,9 +103,53 @@ extern "C" {
     /** Returns true and fills the next event on the queue when there is a new one, otherwise returns false upon a call to ZenShutdown() */
     ZEN_API bool ZenWaitForNextEvent(ZenClientHandle_t handle, ZenEvent* const outEvent);
 
-    /** Publish all data events encountered by OpenZen over a network interface */
+    /** Publish all data events encountered by OpenZen over a network interface. Sensors which publish
+     * on the same endpoint share one socket and sender thread, and are told apart by their sensor topic,
+     * see ZenPublishEventsWithOptions. On Linux, the endpoint "shm://<name>" writes the events to a
+     * shared memory ring instead, which processes on the same host read with the "SharedMemory" IO type
+     * and the ring name as sensor identifier. The publish options do not apply to shared memory rings.
+     */
     ZEN_API ZenError ZenPublishEvents(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const char* endpoint);
 
+    /** Publish all data events of the sensor over a network interface, e.g. packing several events into one message */
+    ZEN_API ZenError ZenPublishEventsWithOptions(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const char* endpoint, const ZenPublishOptions* options);
+
+    /** Enables automatic reconnects of the sensor. If its IO interface fails, e.g. because it was unplugged, a
+     * ZenEventType_SensorConnectionLost event is queued and OpenZen tries to reconnect the sensor in the background.
+     * Once the sensor is back, all properties changed before are set again, streaming last, and a ZenEventType_SensorReconnected
+     * event reports the estimated number of missed data frames and whether a property could not be set again.
+     * The sensor handle stays valid throughout.
+     * Returns ZenError_NotSupported for sensors which are not connected through a low-level IO system.
+     */
+    ZEN_API ZenError ZenSensorSetAutoReconnect(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, bool enabled);
+
+    /** Returns the round-trip times of the requests sent to the sensor, and the timeout currently used for replies.
+     * Returns ZenError_NotSupported for sensors which are not connected through a low-level IO system.
+     */
+    ZEN_API ZenError ZenSensorRoundTripStatistics(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenRoundTripStatistics* const outStatistics);
+
+    /** Returns the lost and reordered messages and their one-way latency for a sensor which receives the events of another
+     * OpenZen instance. Returns ZenError_NotSupported for sensors whose IO type does not keep track of them, currently all but ZeroMQ.
+     */
+    ZEN_API ZenError ZenSensorStreamingStatistics(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenStreamingStatistics* const outStatistics);
+
+    /** Returns the sent and dropped messages of the endpoint on which the sensor publishes its events.
+     * Returns ZenError_NotSupported if the sensor does not publish its events with ZeroMQ.
+     */
+    ZEN_API ZenError ZenSensorPublishStatistics(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPublishStatistics* const outStatistics);
+
+    /** Serializes all properties which configure the sensor and its components into a compact binary blob, while streaming is
+     * suspended once. If the buffer is null or too small, ZenError_BufferTooSmall is returned and bufferSize is set to the required
+     * size. A few kilobytes are enough for current sensors.
+     */
+    ZEN_API ZenError ZenSensorExportConfiguration(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, unsigned char* const buffer, size_t* const bufferSize);
+
+    /** Applies a configuration exported with ZenSensorExportConfiguration, while streaming is suspended once. Returns
+     * ZenError_Sensor_VersionNotSupported or ZenError_WrongSensorType if the configuration was exported from a sensor of a
+     * different protocol version or with different components, and ZenError_InvalidArgument if the blob is corrupt.
+     */
+    ZEN_API ZenError ZenSensorImportConfiguration(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const unsigned char* const buffer, size_t bufferSize);
+
     /** If successful, directs the outComponents pointer to a list of sensor components and sets its length to outLength, otherwise, returns an error.
      * If the type variable points to a string, only components of that type are returned. If it is a nullptr, all components are returned, irrespective of type.
      */
@@ -122,6 +182,17 @@ extern "C" {
      */
     ZEN_API ZenAsyncStatus ZenSensorUpdateIAPAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const unsigned char* const buffer, size_t bufferSize);
 
+    /** Starts firmware updates of several sensors at once, which share a single copy of the firmware. The status of every
+     * sensor is written to outStatuses, see ZenSensorUpdateFirmwareAsync, which also reports the status once updates started.
+     * Each sensor queues ZenEventType_UpdateProgress events while updating.
+     */
+    ZEN_API ZenError ZenSensorsUpdateFirmwareAsync(ZenClientHandle_t clientHandle, const ZenSensorHandle_t* sensorHandles, size_t nSensors,
+        const unsigned char* const buffer, size_t bufferSize, ZenAsyncStatus* outStatuses);
+
+    /** Starts IAP updates of several sensors at once, see ZenSensorsUpdateFirmwareAsync */
+    ZEN_API ZenError ZenSensorsUpdateIAPAsync(ZenClientHandle_t clientHandle, const ZenSensorHandle_t* sensorHandles, size_t nSensors,
+        const unsigned char* const buffer, size_t bufferSize, ZenAsyncStatus* outStatuses);
+
     /** If successful executes the property, otherwise returns an error. */
     ZEN_API ZenError ZenSensorExecuteProperty(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenProperty_t property);
 
@@ -157,6 +228,32 @@ extern "C" {
     /** If successful sets the unsigned integer property, otherwise returns an error. */
     ZEN_API ZenError ZenSensorSetUInt64Property(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenProperty_t property, uint64_t value);
 
+    /** Reads a batch of properties, and stores the result of every property in its entry. Streaming is suspended once for
+     * the whole batch. Returns ZenError_None if all properties were read, otherwise the first error of the batch.
+     */
+    ZEN_API ZenError ZenSensorGetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues);
+
+    /** Writes a batch of properties, and stores the result of every property in its entry. Streaming is suspended once for
+     * the whole batch. Returns ZenError_None if all properties were written, otherwise the first error of the batch.
+     */
+    ZEN_API ZenError ZenSensorSetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues);
+
+    /** Called with the result of an asynchronous batch of properties, on a worker thread of the sensor.
+     * The callback must not release the sensor.
+     */
+    typedef void (*ZenPropertiesCallback)(ZenError error, ZenPropertyValue* values, size_t nValues, void* userData);
+
+    /** Queues a batch of properties to be read, and returns without waiting for the sensor. Batches of one sensor are processed
+     * in order, while several sensors are configured concurrently. The values need to stay valid until the callback has been called.
+     * Returns an error, and does not call the callback, if the batch could not be queued.
+     */
+    ZEN_API ZenError ZenSensorGetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues,
+        ZenPropertiesCallback callback, void* userData);
+
+    /** Queues a batch of properties to be written, see ZenSensorGetPropertiesAsync */
+    ZEN_API ZenError ZenSensorSetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues,
+        ZenPropertiesCallback callback, void* userData);
+
     /** Returns whether the property is an array type */
     ZEN_API bool ZenSensorIsArrayProperty(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenProperty_t property);
 
@@ -207,6 +304,20 @@ extern "C" {
     /** If successful sets the unsigned integer property, otherwise returns an error. */
     ZEN_API ZenError ZenSensorComponentSetUInt64Property(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenProperty_t property, uint64_t value);
 
+    /** Reads a batch of component properties, see ZenSensorGetProperties */
+    ZEN_API ZenError ZenSensorComponentGetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenPropertyValue* values, size_t nValues);
+
+    /** Writes a batch of component properties, see ZenSensorSetProperties */
+    ZEN_API ZenError ZenSensorComponentSetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenPropertyValue* values, size_t nValues);
+
+    /** Queues a batch of component properties to be read, see ZenSensorGetPropertiesAsync */
+    ZEN_API ZenError ZenSensorComponentGetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle,
+        ZenPropertyValue* values, size_t nValues, ZenPropertiesCallback callback, void* userData);
+
+    /** Queues a batch of component properties to be written, see ZenSensorGetPropertiesAsync */
+    ZEN_API ZenError ZenSensorComponentSetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle,
+        ZenPropertyValue* values, size_t nValues, ZenPropertiesCallback callback, void* userData);
+
     /** Returns whether the property is an array type */
     ZEN_API bool ZenSensorComponentIsArrayProperty(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenProperty_t property);
 
@@ -11,6 +11,8 @@
 #ifndef ZEN_API_ZENTYPES_H_
 #define ZEN_API_ZENTYPES_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef _WIN32
@@ -420,6 +422,42 @@ typedef struct ZenEventData_SensorDisconnected
 
 typedef ZenSensorDesc ZenEventData_SensorFound;
 
+/* Description of a sensor whose IO device has been removed from the system */
+typedef ZenSensorDesc ZenEventData_SensorLost;
+
+typedef struct ZenEventData_SensorObtained
+{
+    /* Description the sensor was requested with */
+    ZenSensorDesc desc;
+    /* ZenSensorInitError_None if the sensor handle of the event is valid */
+    ZenSensorInitError error;
+} ZenEventData_SensorObtained;
+
+typedef struct ZenEventData_SensorConnection
+{
+    /* IO error which caused the connection loss, or after a reconnect the first error restoring the changed properties */
+    ZenError_t error;
+    /* Number of reconnect attempts since the connection was lost */
+    uint32_t reconnectAttempts;
+    /* Estimated number of data frames the sensor sent while it was disconnected */
+    uint64_t missedFrames;
+} ZenEventData_SensorConnection;
+
+typedef struct ZenEventData_UpdateProgress
+{
+    /* Error of the update once it is complete, ZenError_None before */
+    ZenError_t error;
+    /* Pages acknowledged by the sensor, of the total number of pages */
+    uint32_t pagesWritten;
+    uint32_t pagesTotal;
+    /* Number of times the update started over after a page was lost or rejected */
+    uint32_t retries;
+    /* This variable is != zero for an IAP update, zero for a firmware update */
+    char iap;
+    /* This variable is != zero once the update has finished or failed */
+    char complete;
+} ZenEventData_UpdateProgress;
+
 typedef struct ZenEventData_SensorListingProgress
 {
     float progress;
@@ -433,7 +471,11 @@ typedef union
     ZenEventData_Gnss gnssData;
     ZenEventData_SensorDisconnected sensorDisconnected;
     ZenEventData_SensorFound sensorFound;
+    ZenEventData_SensorLost sensorLost;
+    ZenEventData_SensorObtained sensorObtained;
+    ZenEventData_SensorConnection sensorConnection;
     ZenEventData_SensorListingProgress sensorListingProgress;
+    ZenEventData_UpdateProgress updateProgress;
 } ZenEventData;
 
 typedef enum ZenEventType
@@ -443,6 +485,13 @@ typedef enum ZenEventType
     ZenEventType_SensorFound = 1,
     ZenEventType_SensorListingProgress = 2,
     ZenEventType_SensorDisconnected = 3,
+    ZenEventType_SensorLost = 4,
+    ZenEventType_SensorObtained = 5,
+    // Only sent for sensors with automatic reconnect, see ZenSensorSetAutoReconnect
+    ZenEventType_SensorConnectionLost = 6,
+    ZenEventType_SensorReconnected = 7,
+    // Sent while a firmware or IAP update is running
+    ZenEventType_UpdateProgress = 8,
 
     ZenEventType_ImuData = 100,
 
@@ -670,6 +719,147 @@ typedef enum ZenPropertyType
     ZenPropertyType_Max
 } ZenPropertyType;
 
+/* Round-trip times of the requests sent to a sensor */
+typedef struct ZenRoundTripStatistics
+{
+    /* Number of answered requests, and of requests which were not answered in time */
+    uint64_t samples;
+    uint64_t timeouts;
+
+    /* Round-trip times of the answered requests (ms). Mean and standard deviation are
+       smoothed, percentiles cover the 256 most recent requests */
+    float min;
+    float mean;
+    float stdDev;
+    float max;
+    float median;
+    float p90;
+    float p99;
+
+    /* Time the next request waits for its reply (ms) */
+    float timeout;
+
+    /* Time it took to negotiate the connection when the sensor was obtained (ms). A sensor whose
+       configuration was cached only needs to answer one request */
+    float negotiationTime;
+} ZenRoundTripStatistics;
+
+/* Messages received from a publishing OpenZen instance, e.g. by a sensor with the ZeroMQ IO type */
+typedef struct ZenStreamingStatistics
+{
+    /* Number of received messages, and of the events they contained */
+    uint64_t messages;
+    uint64_t events;
+
+    /* Messages which are missing in the sequence of their stream, e.g. because they were dropped at
+       the publisher's high-water mark, and the number of gaps in which they went missing */
+    uint64_t lostMessages;
+    uint64_t gaps;
+
+    /* Messages which arrived after a later message of their stream, they are not counted as lost */
+    uint64_t reorderedMessages;
+
+    /* Messages of publishers which do not send sequence numbers */
+    uint64_t unsequencedMessages;
+
+    /* One-way latency between sending and receiving the messages (ms). Only measured if publisher and
+       subscriber share the monotonic clock, i.e. run on the same host. Median and p99 cover the 256
+       most recent messages */
+    uint64_t latencySamples;
+    float latencyMin;
+    float latencyMean;
+    float latencyMax;
+    float latencyMedian;
+    float latencyP99;
+} ZenStreamingStatistics;
+
+/* Options for publishing the data events of a sensor over the network. Zero-initialized
+   options send every event in its own message. */
+typedef struct ZenPublishOptions
+{
+    /* Maximum number of events which are packed into one message. 0 or 1 sends every
+       event right away, which keeps the latency lowest. */
+    uint32_t batchSize;
+
+    /* Maximum time (us) an event waits for further events before an incomplete batch is
+       sent. With 0, a batch only packs the events which are already queued. */
+    uint32_t batchIntervalUs;
+
+    /* Maximum size (bytes) of a batched message, 0 for no limit besides batchSize */
+    uint32_t batchBytes;
+
+    /* Identifies the sensor in the topic "<imu|gnss>/<sensorTopic>/" which is sent in a
+       frame before every message, so libzmq can filter on the publisher's side. Must not
+       contain '/'. If empty, no topic is sent, as by earlier versions of OpenZen.
+       A ZeroMQ sensor obtained with the name "<endpoint>#<sensorTopic>" only receives the
+       messages of that sensor, with "<endpoint>#<sensorTopic>/<imu|gnss>" only the messages
+       of one type. The sensor topic "*" selects all sensors. */
+    char sensorTopic[64];
+
+    /* Maximum number of messages which are queued for each subscriber (ZMQ_SNDHWM). Further messages
+       are dropped for that subscriber. 0 keeps the default of libzmq (1000). */
+    uint32_t sendHighWaterMark;
+
+    /* Size (bytes) of the kernel's send buffer of each connection (ZMQ_SNDBUF), 0 for the default of the OS */
+    uint32_t sendBufferBytes;
+
+    /* Time (ms) which queued messages are still sent after publishing stopped (ZMQ_LINGER). 0 keeps the
+       default of libzmq, which waits until all of them are sent, a negative value discards them right away. */
+    int32_t lingerMs;
+
+    /* Only keep the most recent message queued for each subscriber (ZMQ_CONFLATE), which gives slow
+       subscribers the latest data instead of a backlog. Requires an empty sensorTopic, as libzmq cannot
+       conflate messages with topic frames. */
+    bool conflate;
+
+    /* Drop a message for all subscribers if any of them reached its high-water mark (ZMQ_XPUB_NODROP),
+       which lets OpenZen count the dropped messages, see ZenPublishStatistics. Otherwise libzmq drops
+       messages for slow subscribers without reporting them. */
+    bool countDrops;
+
+    /* Send a sequence number and the send time in the header of every message, which lets the subscriber
+       count lost messages and measure the latency, see ZenStreamingStatistics. Subscribers of earlier
+       OpenZen versions cannot decode these messages, so this is off by default. */
+    bool sequenceNumbers;
+} ZenPublishOptions;
+
+/* Messages sent on the endpoint a sensor publishes to, including those of other sensors on the same endpoint */
+typedef struct ZenPublishStatistics
+{
+    /* Messages which were queued for sending */
+    uint64_t sentMessages;
+
+    /* Messages which were dropped because a subscriber reached its high-water mark, only counted with
+       ZenPublishOptions.countDrops */
+    uint64_t droppedMessages;
+} ZenPublishStatistics;
+
+/* Entry of a batch of properties which are read or written with one call */
+typedef struct ZenPropertyValue
+{
+    ZenProperty_t property;
+
+    /* Type of the property, or of the elements of an array property */
+    ZenPropertyType type;
+
+    /* Value of a property which is not an array */
+    union
+    {
+        bool boolValue;
+        float floatValue;
+        int32_t int32Value;
+        uint64_t uint64Value;
+    } value;
+
+    /* Elements of an array property. When reading an array, bufferSize holds the capacity of
+       the buffer and is updated to the size of the array */
+    void* buffer;
+    size_t bufferSize;
+
+    /* Result of reading or writing this property */
+    ZenError_t error;
+} ZenPropertyValue;
+
 static const char g_zenSensorType_Imu[] = "imu";
 static const char g_zenSensorType_Gnss[] = "gnss";
 
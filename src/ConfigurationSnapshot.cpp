@@ -0,0 +1,302 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "ConfigurationSnapshot.h"
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "utility/LittleEndian.h"
+
+namespace zen
+{
+    namespace
+    {
+        constexpr std::byte SNAPSHOT_MAGIC[] = { std::byte{'Z'}, std::byte{'S'}, std::byte{'N'}, std::byte{'P'} };
+        constexpr uint8_t SNAPSHOT_FORMAT = 1;
+
+        /** Properties which identify the sensor or its connection, or report its state, instead of configuring it.
+         * Streaming is suspended while a snapshot is taken or applied, and resumed afterwards.
+         */
+        bool isSnapshotProperty(ZenProperty_t property, std::string_view type) noexcept
+        {
+            if (type.empty())
+            {
+                switch (property)
+                {
+                case ZenSensorProperty_DeviceName:
+                case ZenSensorProperty_FirmwareInfo:
+                case ZenSensorProperty_FirmwareVersion:
+                case ZenSensorProperty_SerialNumber:
+                case ZenSensorProperty_SensorModel:
+                case ZenSensorProperty_BaudRate:
+                case ZenSensorProperty_BatteryCharging:
+                case ZenSensorProperty_BatteryLevel:
+                case ZenSensorProperty_BatteryVoltage:
+                    return false;
+
+                default:
+                    return true;
+                }
+            }
+
+            return !(type == g_zenSensorType_Imu && property == ZenImuProperty_StreamData);
+        }
+
+        std::pair<ZenProperty_t, ZenProperty_t> propertyRange(std::string_view type) noexcept
+        {
+            if (type.empty())
+                return std::make_pair(ZenSensorProperty_DeviceName, ZenSensorProperty_SensorSpecific_Start);
+            if (type == g_zenSensorType_Imu)
+                return std::make_pair(ZenImuProperty_StreamData, ZenImuProperty_Max);
+            if (type == g_zenSensorType_Gnss)
+                return std::make_pair(ZenGnssProperty_Invalid + 1, ZenGnssProperty_Max);
+
+            return std::make_pair(0, 0);
+        }
+
+        class Writer
+        {
+        public:
+            template <typename T>
+            void write(T value)
+            {
+                static_assert(std::is_arithmetic_v<T>);
+                m_buffer.resize(m_buffer.size() + sizeof(T));
+                writeLittleEndian(m_buffer.data() + m_buffer.size() - sizeof(T), value);
+            }
+
+            void write(gsl::span<const std::byte> bytes)
+            {
+                m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+            }
+
+            std::vector<std::byte> release() { return std::move(m_buffer); }
+
+        private:
+            std::vector<std::byte> m_buffer;
+        };
+
+        class Reader
+        {
+        public:
+            Reader(gsl::span<const std::byte> buffer) noexcept
+                : m_buffer(buffer)
+            {}
+
+            template <typename T>
+            bool read(T& outValue) noexcept
+            {
+                if (m_buffer.size() < static_cast<std::ptrdiff_t>(sizeof(T)))
+                    return false;
+
+                readLittleEndian(m_buffer.data(), outValue);
+                m_buffer = m_buffer.subspan(sizeof(T));
+                return true;
+            }
+
+            bool read(size_t size, gsl::span<const std::byte>& outBytes) noexcept
+            {
+                if (m_buffer.size() < static_cast<std::ptrdiff_t>(size))
+                    return false;
+
+                outBytes = m_buffer.first(size);
+                m_buffer = m_buffer.subspan(size);
+                return true;
+            }
+
+            bool empty() const noexcept { return m_buffer.empty(); }
+
+        private:
+            gsl::span<const std::byte> m_buffer;
+        };
+
+        template <typename T>
+        bool readValue(Reader& reader, SensorPropertySetting& outSetting) noexcept
+        {
+            T value;
+            if (!reader.read(value))
+                return false;
+
+            outSetting = value;
+            return true;
+        }
+
+        /** Settings are tagged with the index of their type in SensorPropertySetting */
+        bool readSetting(Reader& reader, SensorPropertySetting& outSetting) noexcept
+        {
+            uint8_t kind;
+            if (!reader.read(kind))
+                return false;
+
+            switch (kind)
+            {
+            case 0:
+                return readValue<bool>(reader, outSetting);
+
+            case 1:
+                return readValue<float>(reader, outSetting);
+
+            case 2:
+                return readValue<int32_t>(reader, outSetting);
+
+            case 3:
+                return readValue<uint64_t>(reader, outSetting);
+
+            case 4:
+            {
+                uint16_t size;
+                gsl::span<const std::byte> bytes;
+                if (!reader.read(size) || !reader.read(size, bytes))
+                    return false;
+
+                outSetting = std::vector<std::byte>(bytes.begin(), bytes.end());
+                return true;
+            }
+
+            default:
+                return false;
+            }
+        }
+    }
+
+    nonstd::expected<ConfigurationSection, ZenError> readConfigurationSection(ISensorProperties& properties,
+        std::string_view type, uint32_t version) noexcept
+    {
+        ConfigurationSection section{ std::string(type), version, {} };
+
+        const auto [begin, end] = propertyRange(type);
+        for (ZenProperty_t property = begin; property < end; ++property)
+        {
+            if (properties.type(property) == ZenPropertyType_Invalid || properties.isConstant(property) ||
+                properties.isExecutable(property) || !isSnapshotProperty(property, type))
+                continue;
+
+            auto setting = properties.read(property);
+            if (!setting)
+            {
+                if (setting.error() == ZenError_UnknownProperty || setting.error() == ZenError_NotSupported)
+                    continue;
+
+                return nonstd::make_unexpected(setting.error());
+            }
+
+            section.settings.emplace_back(property, std::move(*setting));
+        }
+
+        return section;
+    }
+
+    ZenError applyConfigurationSection(ISensorProperties& properties, const ConfigurationSection& section) noexcept
+    {
+        ZenError result = ZenError_None;
+        for (const auto& [property, setting] : section.settings)
+        {
+            const ZenError error = properties.write(property, setting);
+            if (error != ZenError_None && result == ZenError_None)
+                result = error;
+        }
+
+        return result;
+    }
+
+    nonstd::expected<std::vector<std::byte>, ZenError> serializeConfiguration(const ConfigurationSnapshot& snapshot)
+    {
+        // the counts and lengths of the format are narrower than those of the snapshot
+        if (snapshot.sections.size() > std::numeric_limits<uint8_t>::max())
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+        for (const auto& section : snapshot.sections)
+        {
+            if (section.type.size() > std::numeric_limits<uint8_t>::max() || section.settings.size() > std::numeric_limits<uint16_t>::max())
+                return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+            for (const auto& setting : section.settings)
+                if (auto array = std::get_if<std::vector<std::byte>>(&setting.second))
+                    if (array->size() > std::numeric_limits<uint16_t>::max())
+                        return nonstd::make_unexpected(ZenError_InvalidArgument);
+        }
+
+        Writer writer;
+        writer.write(gsl::make_span(SNAPSHOT_MAGIC));
+        writer.write(SNAPSHOT_FORMAT);
+        writer.write(snapshot.version);
+        writer.write(static_cast<uint8_t>(snapshot.sections.size()));
+
+        for (const auto& section : snapshot.sections)
+        {
+            writer.write(static_cast<uint8_t>(section.type.size()));
+            writer.write(gsl::make_span(reinterpret_cast<const std::byte*>(section.type.data()), section.type.size()));
+            writer.write(section.version);
+            writer.write(static_cast<uint16_t>(section.settings.size()));
+
+            for (const auto& [property, setting] : section.settings)
+            {
+                writer.write(static_cast<uint32_t>(property));
+                writer.write(static_cast<uint8_t>(setting.index()));
+                std::visit([&writer](const auto& value) {
+                    using T = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<T, std::vector<std::byte>>)
+                    {
+                        writer.write(static_cast<uint16_t>(value.size()));
+                        writer.write(gsl::make_span(value));
+                    }
+                    else
+                    {
+                        writer.write(value);
+                    }
+                }, setting);
+            }
+        }
+
+        return writer.release();
+    }
+
+    nonstd::expected<ConfigurationSnapshot, ZenError> deserializeConfiguration(gsl::span<const std::byte> buffer) noexcept
+    {
+        Reader reader(buffer);
+        gsl::span<const std::byte> magic;
+        uint8_t format;
+        uint8_t nSections;
+        ConfigurationSnapshot snapshot{};
+        if (!reader.read(sizeof(SNAPSHOT_MAGIC), magic) || std::memcmp(magic.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+            !reader.read(format) || format != SNAPSHOT_FORMAT || !reader.read(snapshot.version) || !reader.read(nSections))
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+        for (uint8_t sectionIdx = 0; sectionIdx < nSections; ++sectionIdx)
+        {
+            uint8_t typeLength;
+            gsl::span<const std::byte> type;
+            uint16_t nSettings;
+            ConfigurationSection section{};
+            if (!reader.read(typeLength) || !reader.read(typeLength, type) || !reader.read(section.version) || !reader.read(nSettings))
+                return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+            section.type.assign(reinterpret_cast<const char*>(type.data()), type.size());
+            for (uint16_t settingIdx = 0; settingIdx < nSettings; ++settingIdx)
+            {
+                uint32_t property;
+                SensorPropertySetting setting;
+                if (!reader.read(property) || !readSetting(reader, setting))
+                    return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+                section.settings.emplace_back(static_cast<ZenProperty_t>(property), std::move(setting));
+            }
+
+            snapshot.sections.emplace_back(std::move(section));
+        }
+
+        if (!reader.empty())
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+        return snapshot;
+    }
+}
@@ -0,0 +1,67 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_CONFIGURATIONSNAPSHOT_H_
+#define ZEN_CONFIGURATIONSNAPSHOT_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gsl/span>
+#include <nonstd/expected.hpp>
+
+#include "ISensorProperties.h"
+
+namespace zen
+{
+    /** Settings of the sensor itself, or one of its components */
+    struct ConfigurationSection
+    {
+        /** Component type, e.g. g_zenSensorType_Imu, or empty for the sensor itself */
+        std::string type;
+        uint32_t version;
+        std::vector<std::pair<ZenProperty_t, SensorPropertySetting>> settings;
+    };
+
+    /** The settable properties of a sensor and its components
+     *
+     *  Snapshots are serialized into a compact little-endian blob:
+     *
+     *      "ZSNP" | format version (u8) | sensor version (u32) | section count (u8)
+     *      section: type length (u8) | type | component version (u32) | setting count (u16)
+     *      setting: property (u32) | kind (u8) | value (bool: u8, float/int32: 4 bytes, uint64: 8 bytes,
+     *               array: byte count (u16) and raw elements)
+     */
+    struct ConfigurationSnapshot
+    {
+        /** SensorConfig::version of the sensor the snapshot was taken of */
+        uint32_t version;
+        std::vector<ConfigurationSection> sections;
+    };
+
+    /** Reads all properties in the range of the component type which can be set and describe the
+     * configuration, i.e. no identifiers or commands. Properties the sensor does not know are left out.
+     */
+    nonstd::expected<ConfigurationSection, ZenError> readConfigurationSection(ISensorProperties& properties,
+        std::string_view type, uint32_t version) noexcept;
+
+    /** Sets all properties of the section. Returns the first error. */
+    ZenError applyConfigurationSection(ISensorProperties& properties, const ConfigurationSection& section) noexcept;
+
+    /** Returns ZenError_InvalidArgument if the snapshot exceeds the counts or lengths of the format */
+    nonstd::expected<std::vector<std::byte>, ZenError> serializeConfiguration(const ConfigurationSnapshot& snapshot);
+
+    /** Returns ZenError_InvalidArgument if the blob is not a snapshot of a supported format */
+    nonstd::expected<ConfigurationSnapshot, ZenError> deserializeConfiguration(gsl::span<const std::byte> buffer) noexcept;
+}
+
+#endif
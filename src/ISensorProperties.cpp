@@ -10,6 +10,9 @@
 
 #include "ISensorProperties.h"
 
+#include <algorithm>
+#include <type_traits>
+
 namespace zen
 {
     void ISensorProperties::subscribeToPropertyChanges(ZenProperty_t property, SensorPropertyChangeCallback callback) noexcept
@@ -21,8 +24,219 @@ namespace zen
         it->second.emplace_back(std::move(callback));
     }
 
+    namespace
+    {
+        /** Number of array elements which are read at first, enough for all current array properties */
+        constexpr size_t MAX_ARRAY_ELEMENTS = 64;
+
+        template <typename T>
+        ZenError assign(nonstd::expected<T, ZenError> result, T& outValue) noexcept
+        {
+            if (!result)
+                return result.error();
+
+            outValue = *result;
+            return ZenError_None;
+        }
+    }
+
+    ZenError ISensorProperties::get(ZenPropertyValue& value) noexcept
+    {
+        if (isArray(value.property))
+        {
+            if (value.buffer == nullptr)
+                return ZenError_IsNull;
+
+            const auto [error, size] = getArray(value.property, value.type, gsl::make_span(reinterpret_cast<std::byte*>(value.buffer), value.bufferSize));
+            value.bufferSize = size;
+            return error;
+        }
+
+        switch (value.type)
+        {
+        case ZenPropertyType_Bool:
+            return assign(getBool(value.property), value.value.boolValue);
+
+        case ZenPropertyType_Float:
+            return assign(getFloat(value.property), value.value.floatValue);
+
+        case ZenPropertyType_Int32:
+            return assign(getInt32(value.property), value.value.int32Value);
+
+        case ZenPropertyType_UInt64:
+            return assign(getUInt64(value.property), value.value.uint64Value);
+
+        default:
+            return ZenError_WrongDataType;
+        }
+    }
+
+    ZenError ISensorProperties::set(const ZenPropertyValue& value) noexcept
+    {
+        if (isArray(value.property))
+        {
+            if (value.buffer == nullptr)
+                return ZenError_IsNull;
+
+            return setArray(value.property, value.type, gsl::make_span(reinterpret_cast<const std::byte*>(value.buffer), value.bufferSize));
+        }
+
+        switch (value.type)
+        {
+        case ZenPropertyType_Bool:
+            return setBool(value.property, value.value.boolValue);
+
+        case ZenPropertyType_Float:
+            return setFloat(value.property, value.value.floatValue);
+
+        case ZenPropertyType_Int32:
+            return setInt32(value.property, value.value.int32Value);
+
+        case ZenPropertyType_UInt64:
+            return setUInt64(value.property, value.value.uint64Value);
+
+        default:
+            return ZenError_WrongDataType;
+        }
+    }
+
+    ZenError ISensorProperties::batch(gsl::span<ZenPropertyValue> values, bool set) noexcept
+    {
+        ZenError result = ZenError_None;
+        for (auto& value : values)
+        {
+            value.error = set ? this->set(value) : get(value);
+            if (value.error != ZenError_None && result == ZenError_None)
+                result = static_cast<ZenError>(value.error);
+        }
+
+        return result;
+    }
+
+    ZenError ISensorProperties::restoreSettings(std::optional<ZenProperty_t> excluded) noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_settingsMutex);
+        const auto settings = m_settings;
+        lock.unlock();
+
+        ZenError result = ZenError_None;
+        for (const auto& [property, setting] : settings)
+        {
+            if (property == excluded)
+                continue;
+
+            const ZenError error = write(property, setting);
+            if (error != ZenError_None && result == ZenError_None)
+                result = error;
+        }
+
+        return result;
+    }
+
+    ZenError ISensorProperties::restoreSetting(ZenProperty_t property) noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_settingsMutex);
+        auto it = m_settings.find(property);
+        if (it == m_settings.end())
+            return ZenError_None;
+
+        const auto setting = it->second;
+        lock.unlock();
+
+        return write(property, setting);
+    }
+
+    nonstd::expected<SensorPropertySetting, ZenError> ISensorProperties::read(ZenProperty_t property) noexcept
+    {
+        const auto propertyType = type(property);
+        if (isArray(property))
+        {
+            const size_t elementSize = sizeOfPropertyType(propertyType);
+            if (elementSize == 0)
+                return nonstd::make_unexpected(ZenError_WrongDataType);
+
+            // Arrays are passed with their number of elements, and report the required number if the buffer is too small
+            std::vector<std::byte> buffer(MAX_ARRAY_ELEMENTS * elementSize);
+            auto [error, nElements] = getArray(property, propertyType, gsl::make_span(buffer.data(), MAX_ARRAY_ELEMENTS));
+            if (error == ZenError_BufferTooSmall && nElements > MAX_ARRAY_ELEMENTS)
+            {
+                buffer.resize(nElements * elementSize);
+                std::tie(error, nElements) = getArray(property, propertyType, gsl::make_span(buffer.data(), nElements));
+            }
+
+            if (error)
+                return nonstd::make_unexpected(error);
+
+            buffer.resize(std::min(buffer.size(), nElements * elementSize));
+            return buffer;
+        }
+
+        auto toSetting = [](auto result) -> nonstd::expected<SensorPropertySetting, ZenError> {
+            if (!result)
+                return nonstd::make_unexpected(result.error());
+            return *result;
+        };
+
+        switch (propertyType)
+        {
+        case ZenPropertyType_Bool:
+            return toSetting(getBool(property));
+
+        case ZenPropertyType_Float:
+            return toSetting(getFloat(property));
+
+        case ZenPropertyType_Int32:
+            return toSetting(getInt32(property));
+
+        case ZenPropertyType_UInt64:
+            return toSetting(getUInt64(property));
+
+        default:
+            return nonstd::make_unexpected(ZenError_WrongDataType);
+        }
+    }
+
+    ZenError ISensorProperties::write(ZenProperty_t property, const SensorPropertySetting& setting) noexcept
+    {
+        return std::visit([this, property](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, bool>)
+                return setBool(property, value);
+            else if constexpr (std::is_same_v<T, float>)
+                return setFloat(property, value);
+            else if constexpr (std::is_same_v<T, int32_t>)
+                return setInt32(property, value);
+            else if constexpr (std::is_same_v<T, uint64_t>)
+                return setUInt64(property, value);
+            else
+            {
+                // Arrays are passed with their number of elements
+                const auto propertyType = type(property);
+                const size_t nElements = value.size() / std::max<size_t>(1, sizeOfPropertyType(propertyType));
+                return setArray(property, propertyType, gsl::make_span(value.data(), nElements));
+            }
+        }, setting);
+    }
+
     void ISensorProperties::notifyPropertyChange(ZenProperty_t property, SensorPropertyValue value) const noexcept
     {
+        {
+            std::lock_guard<std::mutex> lock(m_settingsMutex);
+            m_settings[property] = std::visit([this, property](const auto& v) -> SensorPropertySetting {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, gsl::span<const std::byte>>)
+                {
+                    // Array spans hold the number of elements, not bytes
+                    const auto size = static_cast<size_t>(v.size()) * sizeOfPropertyType(type(property));
+                    return std::vector<std::byte>(v.data(), v.data() + size);
+                }
+                else
+                {
+                    return v;
+                }
+            }, value);
+        }
+
         auto it = m_subscriberCallbacks.find(property);
         if (it != m_subscriberCallbacks.end())
             for (const auto& callback : it->second)
@@ -14,6 +14,9 @@
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -36,6 +39,39 @@ namespace zen
 
     using SensorPropertyChangeCallback = std::function<void(SensorPropertyValue)>;
 
+    /** Owning copy of a property value. Arrays hold the raw bytes of their elements. */
+    using SensorPropertySetting = std::variant<
+        bool,
+        float,
+        int32_t,
+        uint64_t,
+        std::vector<std::byte>
+    >;
+
+    constexpr size_t sizeOfPropertyType(ZenPropertyType type) noexcept
+    {
+        switch (type)
+        {
+        case ZenPropertyType_Byte:
+            return sizeof(std::byte);
+
+        case ZenPropertyType_Bool:
+            return sizeof(bool);
+
+        case ZenPropertyType_Float:
+            return sizeof(float);
+
+        case ZenPropertyType_Int32:
+            return sizeof(int32_t);
+
+        case ZenPropertyType_UInt64:
+            return sizeof(uint64_t);
+
+        default:
+            return 0;
+        }
+    }
+
     class ISensorProperties
     {
     public:
@@ -113,12 +149,43 @@ namespace zen
         /** Subscribes to change notifications of the property */
         void subscribeToPropertyChanges(ZenProperty_t property, SensorPropertyChangeCallback callback) noexcept;
 
+        /** Reads the property of the batch entry, depending on its type and whether it is an array */
+        ZenError get(ZenPropertyValue& value) noexcept;
+
+        /** Writes the property of the batch entry, depending on its type and whether it is an array */
+        ZenError set(const ZenPropertyValue& value) noexcept;
+
+        /** Reads or writes all entries of the batch, and sets the error of every entry. Returns the first error.
+         * Exchanges one property after the other, unless the properties can send the whole batch before
+         * waiting for the replies.
+         */
+        virtual ZenError batch(gsl::span<ZenPropertyValue> values, bool set) noexcept;
+
+        /** Reads the property into an owning copy, depending on its type and whether it is an array */
+        nonstd::expected<SensorPropertySetting, ZenError> read(ZenProperty_t property) noexcept;
+
+        /** Writes an owning copy of a property value, see read */
+        ZenError write(ZenProperty_t property, const SensorPropertySetting& setting) noexcept;
+
+        /** Sets all properties which have been changed since creation to their last value again,
+         * e.g. after the sensor lost its configuration during a reconnect. The excluded property can be
+         * restored separately with restoreSetting. Returns the first error.
+         */
+        ZenError restoreSettings(std::optional<ZenProperty_t> excluded = std::nullopt) noexcept;
+
+        /** Sets the property to its last value again, if it has been changed since creation */
+        ZenError restoreSetting(ZenProperty_t property) noexcept;
+
     protected:
         /** Trigger  */
         void notifyPropertyChange(ZenProperty_t property, SensorPropertyValue value) const noexcept;
 
     private:
         std::unordered_map<ZenProperty_t, std::vector<SensorPropertyChangeCallback>> m_subscriberCallbacks;
+
+        /** Last value of every changed property, in order of the property IDs */
+        mutable std::mutex m_settingsMutex;
+        mutable std::map<ZenProperty_t, SensorPropertySetting> m_settings;
     };
 }
 
@@ -10,6 +10,7 @@
 
 #include "OpenZenCAPI.h"
 
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <numeric>
@@ -119,6 +120,19 @@ ZEN_API ZenError ZenListSensorsAsync(ZenClientHandle_t handle)
     }
 }
 
+ZEN_API ZenError ZenSubscribeToDeviceChanges(ZenClientHandle_t handle)
+{
+    if (auto client = getClient(handle))
+    {
+        client->subscribeToDeviceChanges();
+        return ZenError_None;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
 ZEN_API ZenSensorInitError ZenObtainSensor(ZenClientHandle_t clientHandle, const ZenSensorDesc* const desc, ZenSensorHandle_t* outSensorHandle)
 {
     if (desc == nullptr)
@@ -145,6 +159,22 @@ ZEN_API ZenSensorInitError ZenObtainSensor(ZenClientHandle_t clientHandle, const
     }
 }
 
+ZEN_API ZenError ZenObtainSensorsAsync(ZenClientHandle_t clientHandle, const ZenSensorDesc* const descs, size_t nDescs)
+{
+    if (descs == nullptr && nDescs != 0)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        client->obtainAsync(std::vector<ZenSensorDesc>(descs, descs + nDescs));
+        return ZenError_None;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
 ZEN_API ZenSensorInitError ZenObtainSensorByName(ZenClientHandle_t clientHandle,
     const char * ioType,
     const char * sensorIdentifier,
@@ -359,11 +389,227 @@ ZEN_API ZenAsyncStatus ZenSensorUpdateIAPAsync(ZenClientHandle_t clientHandle, Z
     }
 }
 
+ZEN_API ZenError ZenSensorsUpdateFirmwareAsync(ZenClientHandle_t clientHandle, const ZenSensorHandle_t* sensorHandles, size_t nSensors,
+    const unsigned char* const buffer, size_t bufferSize, ZenAsyncStatus* outStatuses)
+{
+    if ((sensorHandles == nullptr || outStatuses == nullptr) && nSensors > 0)
+        return ZenError_IsNull;
+
+    if (buffer == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        const auto firmware = std::make_shared<const std::vector<std::byte>>(reinterpret_cast<const std::byte*>(buffer),
+            reinterpret_cast<const std::byte*>(buffer) + bufferSize);
+
+        for (size_t idx = 0; idx < nSensors; ++idx)
+        {
+            if (auto sensor = client->findSensor(sensorHandles[idx]))
+                outStatuses[idx] = sensor->updateFirmwareAsync(firmware);
+            else
+                outStatuses[idx] = ZenAsync_InvalidArgument;
+        }
+
+        return ZenError_None;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorsUpdateIAPAsync(ZenClientHandle_t clientHandle, const ZenSensorHandle_t* sensorHandles, size_t nSensors,
+    const unsigned char* const buffer, size_t bufferSize, ZenAsyncStatus* outStatuses)
+{
+    if ((sensorHandles == nullptr || outStatuses == nullptr) && nSensors > 0)
+        return ZenError_IsNull;
+
+    if (buffer == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        const auto firmware = std::make_shared<const std::vector<std::byte>>(reinterpret_cast<const std::byte*>(buffer),
+            reinterpret_cast<const std::byte*>(buffer) + bufferSize);
+
+        for (size_t idx = 0; idx < nSensors; ++idx)
+        {
+            if (auto sensor = client->findSensor(sensorHandles[idx]))
+                outStatuses[idx] = sensor->updateIAPAsync(firmware);
+            else
+                outStatuses[idx] = ZenAsync_InvalidArgument;
+        }
+
+        return ZenError_None;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
 ZEN_API ZenError ZenPublishEvents(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const char* endpoint) {
     if (auto client = getClient(clientHandle))
     {
         if (auto sensor = client->findSensor(sensorHandle))
-            return client->publishEvents(sensor, endpoint);
+            return client->publishEvents(sensor, endpoint, ZenPublishOptions{});
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenPublishEventsWithOptions(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const char* endpoint, const ZenPublishOptions* options)
+{
+    if (options == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return client->publishEvents(sensor, endpoint, *options);
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorSetAutoReconnect(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, bool enabled)
+{
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return client->setAutoReconnect(sensor, enabled);
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorRoundTripStatistics(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenRoundTripStatistics* const outStatistics)
+{
+    if (outStatistics == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            auto statistics = sensor->roundTripStatistics();
+            if (!statistics)
+                return statistics.error();
+
+            *outStatistics = *statistics;
+            return ZenError_None;
+        }
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorStreamingStatistics(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenStreamingStatistics* const outStatistics)
+{
+    if (outStatistics == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            auto statistics = sensor->streamingStatistics();
+            if (!statistics)
+                return statistics.error();
+
+            *outStatistics = *statistics;
+            return ZenError_None;
+        }
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorPublishStatistics(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPublishStatistics* const outStatistics)
+{
+    if (outStatistics == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            auto statistics = sensor->publishStatistics();
+            if (!statistics)
+                return statistics.error();
+
+            *outStatistics = *statistics;
+            return ZenError_None;
+        }
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorExportConfiguration(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, unsigned char* const buffer, size_t* const bufferSize)
+{
+    if (bufferSize == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            auto configuration = sensor->exportConfiguration();
+            if (!configuration)
+                return configuration.error();
+
+            const size_t capacity = *bufferSize;
+            *bufferSize = configuration->size();
+            if (buffer == nullptr || capacity < configuration->size())
+                return ZenError_BufferTooSmall;
+
+            std::memcpy(buffer, configuration->data(), configuration->size());
+            return ZenError_None;
+        }
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorImportConfiguration(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, const unsigned char* const buffer, size_t bufferSize)
+{
+    if (buffer == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return sensor->importConfiguration(gsl::make_span(reinterpret_cast<const std::byte*>(buffer), bufferSize));
         else
             return ZenError_InvalidSensorHandle;
     }
@@ -610,6 +856,84 @@ ZEN_API ZenError ZenSensorSetUInt64Property(ZenClientHandle_t clientHandle, ZenS
     }
 }
 
+ZEN_API ZenError ZenSensorGetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues)
+{
+    if (values == nullptr && nValues > 0)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return sensor->getProperties(*sensor->properties(), gsl::make_span(values, nValues));
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorSetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues)
+{
+    if (values == nullptr && nValues > 0)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return sensor->setProperties(*sensor->properties(), gsl::make_span(values, nValues));
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorGetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues,
+    ZenPropertiesCallback callback, void* userData)
+{
+    if ((values == nullptr && nValues > 0) || callback == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return sensor->getPropertiesAsync(*sensor->properties(), gsl::make_span(values, nValues), [=](ZenError error) {
+                callback(error, values, nValues, userData);
+            });
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorSetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenPropertyValue* values, size_t nValues,
+    ZenPropertiesCallback callback, void* userData)
+{
+    if ((values == nullptr && nValues > 0) || callback == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+            return sensor->setPropertiesAsync(*sensor->properties(), gsl::make_span(values, nValues), [=](ZenError error) {
+                callback(error, values, nValues, userData);
+            });
+        else
+            return ZenError_InvalidSensorHandle;
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
 ZEN_API bool ZenSensorIsArrayProperty(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenProperty_t property)
 {
     if (auto client = getClient(clientHandle))
@@ -1007,6 +1331,112 @@ ZEN_API ZenError ZenSensorComponentSetUInt64Property(ZenClientHandle_t clientHan
     }
 }
 
+ZEN_API ZenError ZenSensorComponentGetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenPropertyValue* values, size_t nValues)
+{
+    if (values == nullptr && nValues > 0)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            if (auto component = getComponent(sensor, componentHandle))
+                return sensor->getProperties(*component->properties(), gsl::make_span(values, nValues));
+            else
+                return ZenError_InvalidComponentHandle;
+        }
+        else
+        {
+            return ZenError_InvalidSensorHandle;
+        }
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorComponentSetProperties(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenPropertyValue* values, size_t nValues)
+{
+    if (values == nullptr && nValues > 0)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            if (auto component = getComponent(sensor, componentHandle))
+                return sensor->setProperties(*component->properties(), gsl::make_span(values, nValues));
+            else
+                return ZenError_InvalidComponentHandle;
+        }
+        else
+        {
+            return ZenError_InvalidSensorHandle;
+        }
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorComponentGetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle,
+    ZenPropertyValue* values, size_t nValues, ZenPropertiesCallback callback, void* userData)
+{
+    if ((values == nullptr && nValues > 0) || callback == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            if (auto component = getComponent(sensor, componentHandle))
+                return sensor->getPropertiesAsync(*component->properties(), gsl::make_span(values, nValues), [=](ZenError error) {
+                    callback(error, values, nValues, userData);
+                });
+            else
+                return ZenError_InvalidComponentHandle;
+        }
+        else
+        {
+            return ZenError_InvalidSensorHandle;
+        }
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
+ZEN_API ZenError ZenSensorComponentSetPropertiesAsync(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle,
+    ZenPropertyValue* values, size_t nValues, ZenPropertiesCallback callback, void* userData)
+{
+    if ((values == nullptr && nValues > 0) || callback == nullptr)
+        return ZenError_IsNull;
+
+    if (auto client = getClient(clientHandle))
+    {
+        if (auto sensor = client->findSensor(sensorHandle))
+        {
+            if (auto component = getComponent(sensor, componentHandle))
+                return sensor->setPropertiesAsync(*component->properties(), gsl::make_span(values, nValues), [=](ZenError error) {
+                    callback(error, values, nValues, userData);
+                });
+            else
+                return ZenError_InvalidComponentHandle;
+        }
+        else
+        {
+            return ZenError_InvalidSensorHandle;
+        }
+    }
+    else
+    {
+        return ZenError_InvalidClientHandle;
+    }
+}
+
 ZEN_API bool ZenSensorComponentIsArrayProperty(ZenClientHandle_t clientHandle, ZenSensorHandle_t sensorHandle, ZenComponentHandle_t componentHandle, ZenProperty_t property)
 {
     if (auto client = getClient(clientHandle))
@@ -17,10 +17,12 @@
 #include <spdlog/spdlog.h>
 
 #include "ZenProtocol.h"
+#include "ConfigurationSnapshot.h"
 #include "SensorClient.h"
 #include "SensorManager.h"
 #include "SensorProperties.h"
 #include "communication/ConnectionNegotiator.h"
+#include "communication/NegotiationCache.h"
 #include "components/ComponentFactoryManager.h"
 #include "components/factories/ImuComponentFactory.h"
 #include "components/factories/GnssComponentFactory.h"
@@ -37,6 +39,14 @@ namespace zen
 {
     namespace
     {
+        constexpr std::ptrdiff_t UPLOAD_PAGE_SIZE = 255;
+
+        /** Number of firmware pages which are sent before the first one has been acknowledged */
+        constexpr size_t UPLOAD_WINDOW = 4;
+
+        /** Number of times an update starts over, after a page was lost or rejected */
+        constexpr unsigned int MAX_UPLOAD_ATTEMPTS = 3;
+
         std::unique_ptr<ISensorProperties> make_properties(uint8_t id, unsigned int version, SyncedModbusCommunicator& communicator) noexcept
         {
             switch (version)
@@ -71,6 +81,12 @@ namespace zen
             return std::make_unique<modbus::RTUFrameParser>();
         }
 
+        /** Components are created in the order of their configuration */
+        uint32_t componentVersion(const SensorConfig& config, size_t idx) noexcept
+        {
+            return idx < config.components.size() ? config.components[idx].version : 0;
+        }
+
         std::unique_ptr<ModbusCommunicator> moveCommunicator(std::unique_ptr<ModbusCommunicator> communicator, IModbusFrameSubscriber& newSubscriber, uint32_t version)
         {
             // [LEGACY] Potentially we need to support ModbusFormat::Lp
@@ -108,12 +124,17 @@ namespace zen
     Sensor::Sensor(SensorConfig config, std::unique_ptr<ModbusCommunicator> communicator, uintptr_t token)
         : m_config(std::move(config))
         , m_token(token)
+        , m_negotiationTime(0)
         , m_initialized(false)
         , m_communicator(moveCommunicator(std::move(communicator), *this, m_config.version))
         , m_updatingFirmware(false)
         , m_updatedFirmware(false)
         , m_updatingIAP(false)
         , m_updatedIAP(false)
+        , m_asyncTerminate(false)
+        , m_supervised(false)
+        , m_lastDataTime(0)
+        , m_dataInterval(0)
     {
         m_components.reserve(m_config.components.size());
     }
@@ -121,12 +142,17 @@ namespace zen
     Sensor::Sensor(SensorConfig config, std::unique_ptr<EventCommunicator> eventCommunicator,
         uintptr_t token) : m_config(std::move(config))
         , m_token(token)
+        , m_negotiationTime(0)
         , m_initialized(false)
         , m_eventCommunicator(std::move(eventCommunicator))
         , m_updatingFirmware(false)
         , m_updatedFirmware(false)
         , m_updatingIAP(false)
-        , m_updatedIAP(false) {
+        , m_updatedIAP(false)
+        , m_asyncTerminate(false)
+        , m_supervised(false)
+        , m_lastDataTime(0)
+        , m_dataInterval(0) {
 
         m_eventCommunicator->setSubscriber(*this);
     }
@@ -137,6 +163,15 @@ namespace zen
         if (m_uploadThread.joinable())
             m_uploadThread.join();
 
+        // Queued property batches are still processed, as their callers wait for the result
+        {
+            std::lock_guard<std::mutex> lock(m_asyncMutex);
+            m_asyncTerminate = true;
+        }
+        m_asyncCv.notify_all();
+        if (m_asyncThread.joinable())
+            m_asyncThread.join();
+
         // closing all sensor components, maybe some components want to
         // download or store configuration before the sensor is closed.
         for (auto & component : m_components) {
@@ -234,70 +269,87 @@ namespace zen
 
     ZenAsyncStatus Sensor::updateFirmwareAsync(gsl::span<const std::byte> buffer) noexcept
     {
-        if (m_updatingFirmware.exchange(true))
+        return updateAsync(nullptr, buffer, false);
+    }
+
+    ZenAsyncStatus Sensor::updateFirmwareAsync(std::shared_ptr<const std::vector<std::byte>> firmware) noexcept
+    {
+        return updateAsync(std::move(firmware), {}, false);
+    }
+
+    ZenAsyncStatus Sensor::updateIAPAsync(gsl::span<const std::byte> buffer) noexcept
+    {
+        return updateAsync(nullptr, buffer, true);
+    }
+
+    ZenAsyncStatus Sensor::updateIAPAsync(std::shared_ptr<const std::vector<std::byte>> iap) noexcept
+    {
+        return updateAsync(std::move(iap), {}, true);
+    }
+
+    ZenAsyncStatus Sensor::updateAsync(std::shared_ptr<const std::vector<std::byte>> shared, gsl::span<const std::byte> buffer, bool iap) noexcept
+    {
+        auto& updating = iap ? m_updatingIAP : m_updatingFirmware;
+        auto& updated = iap ? m_updatedIAP : m_updatedFirmware;
+        if (updating.exchange(true))
         {
-            if (m_updatedFirmware.exchange(false))
+            if (updated.exchange(false))
             {
                 m_uploadThread.join();
 
-                const bool error = m_updateFirmwareError != ZenError_None;
-                m_updatingFirmware = false;
+                const bool error = (iap ? m_updateIAPError : m_updateFirmwareError) != ZenError_None;
+                updating = false;
                 return error ? ZenAsync_Failed : ZenAsync_Finished;
             }
 
             return ZenAsync_Updating;
         }
 
-        if (m_updatingIAP)
+        if (iap ? m_updatingFirmware : m_updatingIAP)
         {
-            m_updatingFirmware = false;
+            updating = false;
             return ZenAsync_ThreadBusy;
         }
 
-        if (buffer.data() == nullptr)
+        if (!shared && buffer.data() == nullptr)
         {
-            m_updatingFirmware = false;
+            updating = false;
             return ZenAsync_InvalidArgument;
         }
 
-        std::vector<std::byte> firmware(buffer.begin(), buffer.end());
-        m_uploadThread = std::thread(&Sensor::upload, this, std::move(firmware));
+        // Only copy the buffer once the update starts, as it is passed on every status request
+        if (!shared)
+            shared = std::make_shared<const std::vector<std::byte>>(buffer.begin(), buffer.end());
 
+        m_uploadThread = std::thread(&Sensor::upload, this, std::move(shared), iap);
         return ZenAsync_Updating;
     }
 
-    ZenAsyncStatus Sensor::updateIAPAsync(gsl::span<const std::byte> buffer) noexcept
+    nonstd::expected<ZenRoundTripStatistics, ZenError> Sensor::roundTripStatistics() const noexcept
     {
-        if (m_updatingIAP.exchange(true))
-        {
-            if (m_updatedIAP.exchange(false))
-            {
-                m_uploadThread.join();
-
-                const bool error = m_updateIAPError != ZenError_None;
-                m_updatingIAP = false;
-                return error ? ZenAsync_Failed : ZenAsync_Finished;
-            }
+        if (!m_communicator)
+            return nonstd::make_unexpected(ZenError_NotSupported);
 
-            return ZenAsync_Updating;
-        }
+        auto statistics = m_communicator->roundTripStatistics();
+        statistics.negotiationTime = std::chrono::duration<float, std::milli>(m_negotiationTime).count();
+        return statistics;
+    }
 
-        if (m_updatingFirmware)
-        {
-            m_updatingIAP = false;
-            return ZenAsync_ThreadBusy;
-        }
+    nonstd::expected<ZenStreamingStatistics, ZenError> Sensor::streamingStatistics() const noexcept
+    {
+        if (!m_eventCommunicator)
+            return nonstd::make_unexpected(ZenError_NotSupported);
 
-        if (buffer.data() == nullptr)
-        {
-            m_updatingFirmware = false;
-            return ZenAsync_InvalidArgument;
-        }
+        return m_eventCommunicator->streamingStatistics();
+    }
 
-        std::vector<std::byte> iap(buffer.begin(), buffer.end());
-        m_uploadThread = std::thread(&Sensor::upload, this, std::move(iap));
+    nonstd::expected<ZenPublishStatistics, ZenError> Sensor::publishStatistics() const noexcept
+    {
+        for (const auto& processor : m_processors)
+            if (auto statistics = processor->publishStatistics())
+                return statistics;
 
-        return ZenAsync_Updating;
+        return nonstd::make_unexpected(ZenError_NotSupported);
     }
 
     bool Sensor::equals(const ZenSensorDesc& desc) const
@@ -476,47 +528,416 @@ namespace zen
         return ZenError_Sensor_VersionNotSupported;
     }
 
+    ZenError Sensor::getProperties(ISensorProperties& properties, gsl::span<ZenPropertyValue> values) noexcept
+    {
+        return batchProperties(properties, values, false);
+    }
+
+    ZenError Sensor::setProperties(ISensorProperties& properties, gsl::span<ZenPropertyValue> values) noexcept
+    {
+        return batchProperties(properties, values, true);
+    }
+
+    ZenError Sensor::getPropertiesAsync(ISensorProperties& properties, gsl::span<ZenPropertyValue> values,
+        std::function<void(ZenError)> callback) noexcept
+    {
+        return batchPropertiesAsync(properties, values, false, std::move(callback));
+    }
+
+    ZenError Sensor::setPropertiesAsync(ISensorProperties& properties, gsl::span<ZenPropertyValue> values,
+        std::function<void(ZenError)> callback) noexcept
+    {
+        return batchPropertiesAsync(properties, values, true, std::move(callback));
+    }
+
+    ZenError Sensor::batchPropertiesAsync(ISensorProperties& properties, gsl::span<ZenPropertyValue> values, bool set,
+        std::function<void(ZenError)> callback) noexcept
+    {
+        if (!callback)
+            return ZenError_IsNull;
+
+        {
+            std::lock_guard<std::mutex> lock(m_asyncMutex);
+            if (m_asyncTerminate)
+                return ZenError_InvalidSensorHandle;
+
+            m_asyncBatches.emplace_back([this, &properties, values, set, callback = std::move(callback)]() {
+                callback(batchProperties(properties, values, set));
+            });
+
+            if (!m_asyncThread.joinable())
+                m_asyncThread = std::thread(&Sensor::asyncLoop, this);
+        }
+
+        m_asyncCv.notify_one();
+        return ZenError_None;
+    }
+
+    void Sensor::asyncLoop() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_asyncMutex);
+        for (;;)
+        {
+            m_asyncCv.wait(lock, [this]() { return m_asyncTerminate || !m_asyncBatches.empty(); });
+            if (m_asyncBatches.empty())
+                return;
+
+            auto batch = std::move(m_asyncBatches.front());
+            m_asyncBatches.pop_front();
+
+            lock.unlock();
+            batch();
+            lock.lock();
+        }
+    }
+
+    ISensorProperties* Sensor::streamingProperties() noexcept
+    {
+        auto imu = std::find_if(m_components.begin(), m_components.end(), [](const auto& component) {
+            return component->type() == g_zenSensorType_Imu;
+        });
+        return imu != m_components.end() ? (*imu)->properties() : nullptr;
+    }
+
+    nonstd::expected<bool, ZenError> Sensor::suspendStreaming() noexcept
+    {
+        // The properties only suspend streaming themselves, if it is not suspended already
+        auto properties = streamingProperties();
+        if (properties == nullptr)
+            return false;
+
+        auto streaming = properties->getBool(ZenImuProperty_StreamData);
+        if (!streaming || !*streaming)
+            return false;
+
+        if (auto error = properties->setBool(ZenImuProperty_StreamData, false))
+            return nonstd::make_unexpected(error);
+
+        return true;
+    }
+
+    ZenError Sensor::resumeStreaming() noexcept
+    {
+        auto properties = streamingProperties();
+        return properties ? properties->setBool(ZenImuProperty_StreamData, true) : ZenError_None;
+    }
+
+    nonstd::expected<std::vector<std::byte>, ZenError> Sensor::exportConfiguration() noexcept
+    {
+        if (!m_properties)
+            return nonstd::make_unexpected(ZenError_NotSupported);
+
+        std::lock_guard<std::mutex> suspendLock(m_suspendMutex);
+        const auto suspended = suspendStreaming();
+        if (!suspended)
+            return nonstd::make_unexpected(suspended.error());
+
+        ConfigurationSnapshot snapshot{ m_config.version, {} };
+        ZenError result = ZenError_None;
+        auto addSection = [&snapshot, &result](ISensorProperties& properties, std::string_view type, uint32_t version) {
+            if (result != ZenError_None)
+                return;
+
+            if (auto section = readConfigurationSection(properties, type, version))
+                snapshot.sections.emplace_back(std::move(*section));
+            else
+                result = section.error();
+        };
+
+        addSection(*m_properties, {}, m_config.version);
+        for (size_t idx = 0; idx < m_components.size(); ++idx)
+            addSection(*m_components[idx]->properties(), m_components[idx]->type(), componentVersion(m_config, idx));
+
+        if (*suspended)
+            if (auto error = resumeStreaming())
+                if (result == ZenError_None)
+                    result = error;
+
+        if (result != ZenError_None)
+            return nonstd::make_unexpected(result);
+
+        return serializeConfiguration(snapshot);
+    }
+
+    ZenError Sensor::importConfiguration(gsl::span<const std::byte> buffer) noexcept
+    {
+        if (!m_properties)
+            return ZenError_NotSupported;
+
+        auto snapshot = deserializeConfiguration(buffer);
+        if (!snapshot)
+            return snapshot.error();
+
+        if (snapshot->version != m_config.version)
+        {
+            spdlog::error("Configuration of sensor version {} cannot be applied to sensor version {}", snapshot->version, m_config.version);
+            return ZenError_Sensor_VersionNotSupported;
+        }
+
+        // Sections are matched to the sensor and its components in order, which all need to be compatible
+        if (snapshot->sections.size() != m_components.size() + 1 || !snapshot->sections.front().type.empty())
+            return ZenError_WrongSensorType;
+
+        for (size_t idx = 0; idx < m_components.size(); ++idx)
+        {
+            const auto& section = snapshot->sections[idx + 1];
+            if (section.type != m_components[idx]->type() || section.version != componentVersion(m_config, idx))
+                return ZenError_WrongSensorType;
+        }
+
+        std::lock_guard<std::mutex> suspendLock(m_suspendMutex);
+        const auto suspended = suspendStreaming();
+        if (!suspended)
+            return suspended.error();
+
+        ZenError result = applyConfigurationSection(*m_properties, snapshot->sections.front());
+        for (size_t idx = 0; idx < m_components.size(); ++idx)
+            if (auto error = applyConfigurationSection(*m_components[idx]->properties(), snapshot->sections[idx + 1]))
+                if (result == ZenError_None)
+                    result = error;
+
+        if (*suspended)
+            if (auto error = resumeStreaming())
+                if (result == ZenError_None)
+                    result = error;
+
+        return result;
+    }
+
+    ZenError Sensor::batchProperties(ISensorProperties& properties, gsl::span<ZenPropertyValue> values, bool set) noexcept
+    {
+        std::lock_guard<std::mutex> suspendLock(m_suspendMutex);
+        const auto suspended = suspendStreaming();
+        if (!suspended)
+            return suspended.error();
+
+        const ISensorProperties* imuProperties = streamingProperties();
+        bool resume = *suspended;
+
+        ZenError result = properties.batch(values, set);
+
+        // Streaming which is part of the batch is left as requested
+        if (set && &properties == imuProperties)
+            for (const auto& value : values)
+                if (value.property == ZenImuProperty_StreamData)
+                    resume = false;
+
+        if (resume)
+            if (auto error = resumeStreaming())
+                if (result == ZenError_None)
+                    result = error;
+
+        return result;
+    }
+
+    ZenError Sensor::reconnect(IIoSystem& ioSystem, const ZenSensorDesc& desc, uint32_t attempts) noexcept
+    {
+        if (!m_communicator)
+            return ZenError_NotSupported;
+
+        if (auto error = m_communicator->reconnect(ioSystem, desc))
+            return error;
+
+        // Frames streamed while the settings are restored would hide the gap
+        const auto missed = missedFrames();
+        m_lastDataTime = 0;
+
+        // A power-cycled sensor starts with the configuration stored in its flash. Streaming is restored
+        // last, so the sensor does not stream while it is being configured.
+        ZenError restoreError = ZenError_None;
+        if (auto error = m_properties->restoreSettings())
+        {
+            spdlog::warn("Cannot restore settings of sensor {}: {}", desc.identifier, error);
+            restoreError = error;
+        }
+
+        auto imuProperties = streamingProperties();
+        for (auto& component : m_components)
+        {
+            auto properties = component->properties();
+            std::optional<ZenProperty_t> excluded;
+            if (properties == imuProperties)
+                excluded = ZenImuProperty_StreamData;
+
+            if (auto error = properties->restoreSettings(excluded))
+            {
+                spdlog::warn("Cannot restore settings of {} component of sensor {}: {}", component->type(), desc.identifier, error);
+                if (restoreError == ZenError_None)
+                    restoreError = error;
+            }
+        }
+
+        if (imuProperties)
+        {
+            if (auto error = imuProperties->restoreSetting(ZenImuProperty_StreamData))
+            {
+                spdlog::warn("Cannot restore streaming of sensor {}: {}", desc.identifier, error);
+                if (restoreError == ZenError_None)
+                    restoreError = error;
+            }
+        }
+
+        // The connection is back even if some settings were rejected. Retrying would not help with
+        // that, so the sensor is reported as reconnected with the error instead.
+        spdlog::info("Sensor {} reconnected after {} attempts, missed about {} frames", desc.identifier, attempts, missed);
+        publishConnectionEvent(ZenEventType_SensorReconnected, restoreError, attempts, missed);
+        return ZenError_None;
+    }
+
+    void Sensor::processError(ZenError error) noexcept
+    {
+        if (!m_supervised)
+            return;
+
+        if (SensorManager::get().sensorFailed(m_token))
+            publishConnectionEvent(ZenEventType_SensorConnectionLost, error, 0, missedFrames());
+    }
+
+    void Sensor::publishConnectionEvent(ZenEventType type, ZenError error, uint32_t attempts, uint64_t missedFrames) noexcept
+    {
+        ZenEventData eventData{};
+        eventData.sensorConnection.error = error;
+        eventData.sensorConnection.reconnectAttempts = attempts;
+        eventData.sensorConnection.missedFrames = missedFrames;
+        publishEvent({ type, {m_token}, {0}, eventData });
+    }
+
+    uint64_t Sensor::missedFrames() const noexcept
+    {
+        const int64_t lastDataTime = m_lastDataTime;
+        const int64_t dataInterval = m_dataInterval;
+        if (lastDataTime == 0 || dataInterval <= 0)
+            return 0;
+
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        const int64_t gap = now - lastDataTime;
+        return gap > dataInterval ? static_cast<uint64_t>(gap / dataInterval - 1) : 0;
+    }
+
     void Sensor::publishEvent(const ZenEvent& event) noexcept
     {
+        // Only the first component is tracked, as the components stream at different rates
+        if (event.component.handle == 1)
+        {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            const int64_t last = m_lastDataTime.exchange(now);
+            if (last != 0)
+            {
+                const int64_t interval = now - last;
+                const int64_t smoothed = m_dataInterval;
+                m_dataInterval = smoothed == 0 ? interval : smoothed + (interval - smoothed) / 8;
+            }
+        }
+
         std::lock_guard<std::mutex> lock(m_subscribersMutex);
         for (auto subscriber : m_subscribers)
             subscriber.get().push(event);
     }
 
-    void Sensor::upload(std::vector<std::byte> firmware)
+    void Sensor::upload(std::shared_ptr<const std::vector<std::byte>> firmware, bool iap)
     {
-        constexpr uint32_t PAGE_SIZE = 255;
-
-        auto& outError = m_updatingFirmware ? m_updateFirmwareError : m_updateIAPError;
-        auto& updated = m_updatingFirmware ? m_updatedFirmware : m_updatedIAP;
-        const DeviceProperty_t property = static_cast<DeviceProperty_t>(m_updatingFirmware ? EDevicePropertyInternal::UpdateFirmware : EDevicePropertyInternal::UpdateIAP);
+        auto& outError = iap ? m_updateIAPError : m_updateFirmwareError;
+        auto& updated = iap ? m_updatedIAP : m_updatedFirmware;
+        const DeviceProperty_t property = static_cast<DeviceProperty_t>(iap ? EDevicePropertyInternal::UpdateIAP : EDevicePropertyInternal::UpdateFirmware);
         const uint8_t function = m_config.version == 0 ? static_cast<uint8_t>(property) : static_cast<uint8_t>(ZenProtocolFunction_Set);
 
         auto guard = finally([&updated]() {
             updated = true;
         });
 
-        const uint32_t nFullPages = static_cast<uint32_t>(firmware.size() / PAGE_SIZE);
-        const uint32_t remainder = firmware.size() % PAGE_SIZE;
-        const uint32_t nPages = remainder > 0 ? nFullPages + 1 : nFullPages;
-        if (auto error = m_communicator->sendAndWaitForAck(0, function, property, gsl::make_span(reinterpret_cast<const std::byte*>(&nPages), sizeof(nPages))))
+        ZenEventData_UpdateProgress progress{};
+        progress.pagesTotal = static_cast<uint32_t>((firmware->size() + UPLOAD_PAGE_SIZE - 1) / UPLOAD_PAGE_SIZE);
+        progress.iap = iap ? 1 : 0;
+
+        ZenError error = ZenError_None;
+        for (unsigned int attempt = 0; attempt < MAX_UPLOAD_ATTEMPTS; ++attempt)
         {
-            outError = error;
-            return;
+            // Pages do not carry an index, so a single page can never be sent again. Instead the
+            // update starts over with the page count, which makes the sensor erase its flash and
+            // expect the first page again.
+            if (attempt > 0)
+            {
+                spdlog::warn("Restarting {} update of sensor after error {}", iap ? "IAP" : "firmware", error);
+                ++progress.retries;
+            }
+
+            error = uploadPages(function, property, *firmware, progress);
+            if (error != ZenError_Io_Timeout && error != ZenError_FW_FunctionFailed)
+                break;
         }
 
-        for (unsigned idx = 0; idx < nPages; ++idx)
+        // Even a failed update may have changed the flash, so the sensor needs to be negotiated again
+        NegotiationCache::get().invalidate(m_serialNumber);
+
+        outError = error;
+        progress.error = error;
+        progress.complete = 1;
+        publishUpdateProgress(progress);
+    }
+
+    ZenError Sensor::uploadPages(uint8_t function, DeviceProperty_t property, gsl::span<const std::byte> firmware,
+        ZenEventData_UpdateProgress& progress) noexcept
+    {
+        // The sensor erases its flash before it acknowledges the page count
+        const uint32_t nPages = progress.pagesTotal;
+        if (auto error = m_communicator->sendAndWaitForAck(0, function, property, gsl::make_span(reinterpret_cast<const std::byte*>(&nPages), sizeof(nPages)),
+            SyncedModbusCommunicator::LONG_COMMAND_TIMEOUT))
+            return error;
+
+        progress.pagesWritten = 0;
+        publishUpdateProgress(progress);
+
+        std::deque<std::pair<uint32_t, std::shared_ptr<SyncedModbusCommunicator::PendingRequest>>> inFlight;
+
+        // The remaining requests need to be answered before the update can start over. The link keeps
+        // the order of frames, so every page sent so far reaches the sensor before the next page count.
+        auto drain = [this, &inFlight]() {
+            for (auto& request : inFlight)
+                m_communicator->wait(*request.second);
+            inFlight.clear();
+        };
+
+        uint32_t nextPage = 0;
+        while (nextPage < nPages || !inFlight.empty())
         {
-            if (auto error = m_communicator->sendAndWaitForAck(0, function, property, gsl::make_span(firmware.data() + idx * PAGE_SIZE, PAGE_SIZE)))
+            while (nextPage < nPages && inFlight.size() < UPLOAD_WINDOW)
             {
-                outError = error;
-                return;
+                const auto offset = static_cast<std::ptrdiff_t>(nextPage) * UPLOAD_PAGE_SIZE;
+                const auto page = firmware.subspan(offset, std::min<std::ptrdiff_t>(UPLOAD_PAGE_SIZE, firmware.size() - offset));
+                auto request = m_communicator->sendRequest(0, function, property, page, true);
+                if (!request)
+                {
+                    drain();
+                    return request.error();
+                }
+
+                inFlight.emplace_back(nextPage++, std::move(*request));
             }
+
+            const auto [page, request] = std::move(inFlight.front());
+            inFlight.pop_front();
+
+            if (auto error = m_communicator->wait(*request))
+            {
+                drain();
+                return error;
+            }
+
+            progress.pagesWritten = page + 1;
+
+            // Report every percent, instead of every page
+            if ((progress.pagesWritten * 100ull) / nPages != (page * 100ull) / nPages)
+                publishUpdateProgress(progress);
         }
 
-        if (remainder > 0)
-            if (auto error = m_communicator->sendAndWaitForAck(0, function, property, gsl::make_span(firmware.data() + nFullPages * PAGE_SIZE, remainder)))
-                outError = error;
+        return ZenError_None;
+    }
+
+    void Sensor::publishUpdateProgress(const ZenEventData_UpdateProgress& progress) noexcept
+    {
+        ZenEventData eventData{};
+        eventData.updateProgress = progress;
+        publishEvent({ ZenEventType_UpdateProgress, {m_token}, {0}, eventData });
     }
 
     ZenError Sensor::processReceivedEvent(ZenEvent evt) noexcept {
@@ -13,9 +13,13 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -61,6 +65,9 @@ namespace zen
          */
         ZenAsyncStatus updateFirmwareAsync(gsl::span<const std::byte> buffer) noexcept;
 
+        /** Starts a firmware update with a buffer which can be shared by several sensors, see updateFirmwareAsync */
+        ZenAsyncStatus updateFirmwareAsync(std::shared_ptr<const std::vector<std::byte>> firmware) noexcept;
+
         /** On first call, tries to initialize an IAP update, and returns an error on failure.
          * Subsequent calls do not require a valid buffer and buffer size, and only report the current status:
          * Returns ZenAsync_Updating while busy updating IAP.
@@ -69,6 +76,9 @@ namespace zen
          */
         ZenAsyncStatus updateIAPAsync(gsl::span<const std::byte> buffer) noexcept;
 
+        /** Starts an IAP update with a buffer which can be shared by several sensors, see updateIAPAsync */
+        ZenAsyncStatus updateIAPAsync(std::shared_ptr<const std::vector<std::byte>> iap) noexcept;
+
         /** Returns an interface for the sensor's properties */
         ISensorProperties* properties() { return m_properties.get(); }
 
@@ -80,12 +90,28 @@ namespace zen
         /** Returns the sensor's IO type */
         std::string_view ioType() const noexcept { return m_communicator->ioType(); }
 
+        /** Returns the round-trip times of the requests sent to the sensor, and how long its negotiation took */
+        nonstd::expected<ZenRoundTripStatistics, ZenError> roundTripStatistics() const noexcept;
+
+        /** Remembers how long the connection negotiation took, before the sensor is handed out */
+        void setNegotiationTime(std::chrono::milliseconds time) noexcept { m_negotiationTime = time; }
+
+        /** Returns the losses, reordering and latency of the events received from a publishing OpenZen instance */
+        nonstd::expected<ZenStreamingStatistics, ZenError> streamingStatistics() const noexcept;
+
+        /** Returns the sent and dropped messages of the endpoint on which the sensor publishes its events */
+        nonstd::expected<ZenPublishStatistics, ZenError> publishStatistics() const noexcept;
+
         /** Returns whether the sensor is equal to the sensor description */
         bool equals(const ZenSensorDesc& desc) const;
 
         /** Returns the sensor's unique token */
         uintptr_t token() const noexcept { return m_token; }
 
+        /** The serial number under which the negotiated configuration is cached. The cached entry
+            is removed once a firmware or IAP update was uploaded, as the sensor may have changed. */
+        void setSerialNumber(std::string serialNumber) noexcept { m_serialNumber = std::move(serialNumber); }
+
         /** Subscribe an event queue to the sensor */
         bool subscribe(LockingQueue<ZenEvent>& queue) noexcept;
 
@@ -101,17 +127,97 @@ namespace zen
             destroyed */
         void releaseProcessors() noexcept;
 
+        /** Reads several properties of the sensor or one of its components. Streaming is suspended once
+         * for the whole batch, instead of once per property, and batches of different threads run one after
+         * the other. Properties which support it send all requests before waiting for the replies, see
+         * ISensorProperties::batch. Returns the first error of the batch.
+         */
+        ZenError getProperties(ISensorProperties& properties, gsl::span<ZenPropertyValue> values) noexcept;
+
+        /** Writes several properties of the sensor or one of its components. Streaming is suspended once
+         * for the whole batch, instead of once per property. Returns the first error of the batch.
+         */
+        ZenError setProperties(ISensorProperties& properties, gsl::span<ZenPropertyValue> values) noexcept;
+
+        /** Reads several properties on the sensor's worker thread, see getProperties. Batches of one sensor are
+         * processed in the order in which they are queued. The values need to stay valid until the callback
+         * has been called with the result of the batch. The callback must not release the sensor.
+         */
+        ZenError getPropertiesAsync(ISensorProperties& properties, gsl::span<ZenPropertyValue> values,
+            std::function<void(ZenError)> callback) noexcept;
+
+        /** Writes several properties on the sensor's worker thread, see setProperties and getPropertiesAsync */
+        ZenError setPropertiesAsync(ISensorProperties& properties, gsl::span<ZenPropertyValue> values,
+            std::function<void(ZenError)> callback) noexcept;
+
+        /** Serializes the configuration of the sensor and its components, see ConfigurationSnapshot.
+         * Streaming is suspended once while the properties are read.
+         */
+        nonstd::expected<std::vector<std::byte>, ZenError> exportConfiguration() noexcept;
+
+        /** Applies a configuration which was exported from a sensor of the same version and with the same
+         * components. Streaming is suspended once while the properties are set. Returns the first error.
+         */
+        ZenError importConfiguration(gsl::span<const std::byte> buffer) noexcept;
+
+        /** A supervised sensor reports IO failures to the SensorManager, which then reconnects it */
+        void setSupervised(bool supervised) noexcept { m_supervised = supervised; }
+
+        /** Returns whether the sensor is reconnected after IO failures */
+        bool supervised() const noexcept { return m_supervised; }
+
+        /** Replaces the failed IO interface and restores all settings which were changed through the sensor's
+         * properties. On success, subscribers receive a ZenEventType_SensorReconnected event.
+         */
+        ZenError reconnect(IIoSystem& ioSystem, const ZenSensorDesc& desc, uint32_t attempts) noexcept;
+
     private:
         ZenError processReceivedData(uint8_t address, uint8_t function, gsl::span<const std::byte> data) noexcept override;
 
+        void processError(ZenError error) noexcept override;
+
         ZenError processReceivedEvent(ZenEvent) noexcept override;
 
         void publishEvent(const ZenEvent& event) noexcept;
 
-        void upload(std::vector<std::byte> firmware);
+        ZenError batchProperties(ISensorProperties& properties, gsl::span<ZenPropertyValue> values, bool set) noexcept;
+
+        /** Returns the properties which control streaming, i.e. those of the IMU component */
+        ISensorProperties* streamingProperties() noexcept;
+
+        /** Stops streaming, and returns whether it needs to be resumed afterwards. Requires m_suspendMutex. */
+        nonstd::expected<bool, ZenError> suspendStreaming() noexcept;
+
+        ZenError resumeStreaming() noexcept;
+
+        /** Queues a batch for the worker thread, which is started on first use */
+        ZenError batchPropertiesAsync(ISensorProperties& properties, gsl::span<ZenPropertyValue> values, bool set,
+            std::function<void(ZenError)> callback) noexcept;
+
+        void asyncLoop() noexcept;
+
+        void publishConnectionEvent(ZenEventType type, ZenError error, uint32_t attempts, uint64_t missedFrames) noexcept;
+
+        /** Estimates the number of data frames since the last received one, based on the recent data rate */
+        uint64_t missedFrames() const noexcept;
+
+        /** Starts the upload thread. The span is only copied if no shared buffer is passed. */
+        ZenAsyncStatus updateAsync(std::shared_ptr<const std::vector<std::byte>> shared, gsl::span<const std::byte> buffer, bool iap) noexcept;
+
+        void upload(std::shared_ptr<const std::vector<std::byte>> firmware, bool iap);
+
+        /** Sends the page count, followed by all pages with several pages in flight. Returns the first error,
+         * once the remaining pages in flight have been answered.
+         */
+        ZenError uploadPages(uint8_t function, DeviceProperty_t property, gsl::span<const std::byte> firmware,
+            ZenEventData_UpdateProgress& progress) noexcept;
+
+        void publishUpdateProgress(const ZenEventData_UpdateProgress& progress) noexcept;
 
         SensorConfig m_config;
         const uintptr_t m_token;
+        std::string m_serialNumber;
+        std::chrono::milliseconds m_negotiationTime;
         // [LEGACY]
         std::atomic_bool m_initialized;
 
@@ -133,7 +239,25 @@ namespace zen
 
         std::thread m_uploadThread;
 
+        /** Serializes the operations which suspend and resume streaming, such as property batches of the
+         *  worker thread and of other threads, so one of them cannot resume streaming during another one
+         */
+        std::mutex m_suspendMutex;
+
+        /** Property batches which are waiting for the worker thread */
+        std::mutex m_asyncMutex;
+        std::condition_variable m_asyncCv;
+        std::deque<std::function<void()>> m_asyncBatches;
+        std::thread m_asyncThread;
+        bool m_asyncTerminate;
+
         std::vector<std::unique_ptr<DataProcessor>> m_processors;
+
+        std::atomic_bool m_supervised;
+
+        /** Arrival time of the last data event of the first component, and the smoothed interval between them (ns) */
+        std::atomic_int64_t m_lastDataTime;
+        std::atomic_int64_t m_dataInterval;
     };
 
     struct SensorCmp
@@ -12,13 +12,25 @@
 
 #include "SensorManager.h"
 
+#include <algorithm>
+#include <string_view>
+
 #include <spdlog/spdlog.h>
 
 #ifdef ZEN_NETWORK
 #include "processors/ZmqDataProcessor.h"
 #endif
+#ifdef __linux__
+#include "processors/SharedMemoryDataProcessor.h"
+#endif
 
 namespace {
+    /** Prefix of the endpoints which publish to a shared memory ring instead of a ZeroMQ socket */
+    constexpr std::string_view SHARED_MEMORY_ENDPOINT_PREFIX = "shm://";
+
+    /** Negotiation mostly waits for the sensors, but every worker keeps an IO interface busy */
+    constexpr size_t MAX_OBTAIN_THREADS = 8;
+
     void safeStringToChar(std::string const& str, char * ch, size_t maxCharacter) {
         std::copy_n(str.begin(), std::min(size_t(maxCharacter), str.length()), ch);
         ch[std::min(size_t(maxCharacter - 1), str.length())] = 0;
@@ -28,10 +40,25 @@ namespace {
 namespace zen
 {
     SensorClient::SensorClient(uintptr_t) noexcept
+        : m_nIdleObtainThreads(0)
+        , m_terminate(false)
     {}
 
     SensorClient::~SensorClient() noexcept
     {
+        {
+            std::lock_guard<std::mutex> lock(m_obtainMutex);
+            m_terminate = true;
+            m_pendingObtains.clear();
+        }
+        m_obtainCv.notify_all();
+
+        // Obtains which are in progress finish within the IO timeouts
+        for (auto& thread : m_obtainThreads)
+            thread.join();
+
+        SensorManager::get().unsubscribeFromDeviceChanges(*this);
+
         for (auto& pair : m_sensors)
             if (auto sensor = pair.second.lock())
                 sensor->unsubscribe(m_eventQueue);
@@ -42,26 +69,66 @@ namespace zen
         SensorManager::get().subscribeToSensorDiscovery(*this);
     }
 
+    void SensorClient::subscribeToDeviceChanges() noexcept
+    {
+        SensorManager::get().subscribeToDeviceChanges(*this);
+    }
+
+    ZenError SensorClient::publishEvents(std::shared_ptr<Sensor> sensor, const std::string & endpoint, const ZenPublishOptions& options) {
+        if (std::string_view(endpoint).substr(0, SHARED_MEMORY_ENDPOINT_PREFIX.size()) == SHARED_MEMORY_ENDPOINT_PREFIX) {
+            return publishToSharedMemory(std::move(sensor), endpoint.substr(SHARED_MEMORY_ENDPOINT_PREFIX.size()));
+        }
+
+        return publishToZmq(std::move(sensor), endpoint, options);
+    }
+
+#ifdef __linux__
+    ZenError SensorClient::publishToSharedMemory(std::shared_ptr<Sensor> sensor, const std::string& ringName) {
+        auto processor = SharedMemoryDataProcessor::make(ringName);
+        if (!processor) {
+            return processor.error();
+        }
+
+        sensor->addProcessor(std::move(*processor));
+        return ZenError_None;
+    }
+#else
+    ZenError SensorClient::publishToSharedMemory(std::shared_ptr<Sensor>, const std::string&) {
+        spdlog::error("Shared memory streaming is only available on Linux, cannot publish events");
+        return ZenError_NotSupported;
+    }
+#endif
+
 #ifdef ZEN_NETWORK
-    ZenError SensorClient::publishEvents(std::shared_ptr<Sensor> sensor, const std::string & endpoint) {
-        auto processor = std::make_unique<ZmqDataProcessor>();
+    ZenError SensorClient::publishToZmq(std::shared_ptr<Sensor> sensor, const std::string & endpoint, const ZenPublishOptions& options) {
+        // sensors which publish on the same endpoint share its socket and sender thread
+        auto hub = ZmqPublisherHub::obtain(endpoint, options);
+        if (!hub) {
+            return hub.error();
+        }
 
-        if (!processor->connect(endpoint)) {
-            return ZenError_InvalidArgument;
+        if (auto error = (*hub)->add(sensor->token(), options)) {
+            return error;
         }
-        sensor->addProcessor(std::move(processor));
-        spdlog::info("Publishing events to endpoint {0}", endpoint);
+
+        sensor->addProcessor(std::make_unique<ZmqDataProcessor>(std::move(*hub), sensor->token()));
         return ZenError_None;
     }
 #else
-    ZenError SensorClient::publishEvents(std::shared_ptr<Sensor>, const std::string&) {
+    ZenError SensorClient::publishToZmq(std::shared_ptr<Sensor>, const std::string&, const ZenPublishOptions&) {
         spdlog::error("ZeroMQ support not available in OpenZen build, cannot publish events");
         return ZenError_NotSupported;
     }
 #endif
 
+    ZenError SensorClient::setAutoReconnect(std::shared_ptr<Sensor> sensor, bool enabled) noexcept
+    {
+        return SensorManager::get().setSupervised(*sensor, enabled);
+    }
+
     std::shared_ptr<Sensor> SensorClient::findSensor(ZenSensorHandle_t handle) noexcept
     {
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
         auto it = m_sensors.find(handle.handle);
         if (it != m_sensors.end())
         {
@@ -80,7 +147,10 @@ namespace zen
         if (auto sensor = manager.obtain(desc))
         {
             if (sensor.value()->subscribe(m_eventQueue))
+            {
+                std::lock_guard<std::mutex> lock(m_sensorsMutex);
                 m_sensors.emplace(sensor.value()->token(), *sensor);
+            }
 
             return std::move(*sensor);
         }
@@ -106,10 +176,94 @@ namespace zen
     {
         sensor->releaseProcessors();
         sensor->unsubscribe(m_eventQueue);
+
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
         m_sensors.erase(sensor->token());
         return ZenError_None;
     }
 
+    void SensorClient::obtainAsync(std::vector<ZenSensorDesc> descs) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_obtainMutex);
+        for (const auto& desc : descs)
+        {
+            // The same sensor cannot be negotiated twice at the same time, so a duplicate waits for the result of the first one
+            const auto isSame = [&desc](const ObtainRequest& other) { return SensorManager::isSameSensor(other.desc, desc); };
+            auto pending = std::find_if(m_pendingObtains.begin(), m_pendingObtains.end(), isSame);
+            if (pending != m_pendingObtains.end())
+            {
+                pending->duplicates.emplace_back(desc);
+                continue;
+            }
+
+            auto active = std::find_if(m_activeObtains.begin(), m_activeObtains.end(), isSame);
+            if (active != m_activeObtains.end())
+            {
+                active->duplicates.emplace_back(desc);
+                continue;
+            }
+
+            m_pendingObtains.push_back({ desc, {} });
+        }
+
+        // Workers are started on demand and stay around until the client is destroyed
+        while (m_nIdleObtainThreads < m_pendingObtains.size() && m_obtainThreads.size() < MAX_OBTAIN_THREADS)
+        {
+            m_obtainThreads.emplace_back(&SensorClient::obtainLoop, this);
+            ++m_nIdleObtainThreads;
+        }
+
+        m_obtainCv.notify_all();
+    }
+
+    void SensorClient::obtainLoop() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_obtainMutex);
+        while (true)
+        {
+            m_obtainCv.wait(lock, [this]() { return m_terminate || !m_pendingObtains.empty(); });
+            if (m_terminate)
+                return;
+
+            auto request = m_activeObtains.insert(m_activeObtains.end(), std::move(m_pendingObtains.front()));
+            m_pendingObtains.pop_front();
+            --m_nIdleObtainThreads;
+            const auto desc = request->desc;
+            lock.unlock();
+
+            ZenEvent event{};
+            event.eventType = ZenEventType_SensorObtained;
+            event.data.sensorObtained.desc = desc;
+
+            if (auto sensor = obtain(desc))
+            {
+                event.sensor.handle = sensor.value()->token();
+                event.data.sensorObtained.error = ZenSensorInitError_None;
+            }
+            else
+            {
+                spdlog::error("Cannot obtain sensor {} on {}: {}", desc.identifier, desc.ioType, sensor.error());
+                event.data.sensorObtained.error = sensor.error();
+            }
+
+            // Once the request is removed, no further duplicates can be attached to it
+            lock.lock();
+            const auto duplicates = std::move(request->duplicates);
+            m_activeObtains.erase(request);
+            lock.unlock();
+
+            notifyEvent(event);
+            for (const auto& duplicate : duplicates)
+            {
+                event.data.sensorObtained.desc = duplicate;
+                notifyEvent(event);
+            }
+
+            lock.lock();
+            ++m_nIdleObtainThreads;
+        }
+    }
+
     std::optional<ZenEvent> SensorClient::pollNextEvent() noexcept
     {
         return m_eventQueue.tryToPop();
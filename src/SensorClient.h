@@ -11,9 +11,15 @@
 #ifndef ZEN_SENSORCLIENT_H_
 #define ZEN_SENSORCLIENT_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <nonstd/expected.hpp>
 
@@ -34,6 +40,12 @@ namespace zen
          */
         void listSensorsAsync() noexcept;
 
+        /** Opts in to events about sensors which are attached to or detached from the system.
+         * ZenEventData_SensorFound events will be queued for attached sensors.
+         * ZenEventData_SensorLost events will be queued for detached sensors.
+         */
+        void subscribeToDeviceChanges() noexcept;
+
         std::shared_ptr<Sensor> findSensor(ZenSensorHandle_t handle) noexcept;
 
         nonstd::expected<std::shared_ptr<Sensor>, ZenSensorInitError> obtain(const ZenSensorDesc& desc) noexcept;
@@ -41,6 +53,12 @@ namespace zen
         nonstd::expected<std::shared_ptr<Sensor>, ZenSensorInitError> obtain(const std::string& ioType,
             const std::string& identifier, uint32_t baudRate) noexcept;
 
+        /** Obtains the sensors on a bounded number of worker threads.
+         * A ZenEventData_SensorObtained event will be queued for every sensor description. A description
+         * of a sensor which is obtained already receives the result of that obtain.
+         */
+        void obtainAsync(std::vector<ZenSensorDesc> descs) noexcept;
+
         ZenError release(std::shared_ptr<Sensor> sensor) noexcept;
 
         /** Returns true and fills the next event on the queue if there is one, otherwise returns false. */
@@ -51,16 +69,46 @@ namespace zen
 
         /** Open an OpenZen publisher socket and send all events there. This could be improved by
         having a dedicated subscriber only for the ZeroMQ submission.
+        Endpoints of the form "shm://<name>" write the events to a shared memory ring instead (Linux only).
         */
-        ZenError publishEvents(std::shared_ptr<Sensor> sensor, const std::string & endpoint);
+        ZenError publishEvents(std::shared_ptr<Sensor> sensor, const std::string & endpoint, const ZenPublishOptions& options);
+
+        /** Reconnect the sensor in the background when its IO interface fails */
+        ZenError setAutoReconnect(std::shared_ptr<Sensor> sensor, bool enabled) noexcept;
 
         /** Pushes an event to the event queue */
         void notifyEvent(const ZenEvent& event) noexcept;
 
     private:
+        ZenError publishToSharedMemory(std::shared_ptr<Sensor> sensor, const std::string& ringName);
+
+        ZenError publishToZmq(std::shared_ptr<Sensor> sensor, const std::string& endpoint, const ZenPublishOptions& options);
+
+        void obtainLoop() noexcept;
+
+        struct ObtainRequest
+        {
+            ZenSensorDesc desc;
+
+            /** Further descriptions of the same sensor, which receive the same result */
+            std::vector<ZenSensorDesc> duplicates;
+        };
+
         LockingQueue<ZenEvent> m_eventQueue;
 
+        std::mutex m_sensorsMutex;
         std::unordered_map<uintptr_t, std::weak_ptr<Sensor>> m_sensors;
+
+        /** Sensor descriptions which are waiting for a worker */
+        std::mutex m_obtainMutex;
+        std::condition_variable m_obtainCv;
+        std::deque<ObtainRequest> m_pendingObtains;
+        /** Sensor descriptions which a worker is obtaining right now */
+        std::list<ObtainRequest> m_activeObtains;
+        std::vector<std::thread> m_obtainThreads;
+        size_t m_nIdleObtainThreads;
+
+        std::atomic_bool m_terminate;
     };
 }
 
@@ -13,17 +13,26 @@
 #include "Sensor.h"
 #include "communication/ConnectionNegotiator.h"
 #include "communication/EventCommunicator.h"
+#include "communication/NegotiationCache.h"
 #include "components/ComponentFactoryManager.h"
+#include "io/IoCapture.h"
 #include "io/IoManager.h"
-#include "io/can/CanManager.h"
+#include "utility/Finally.h"
 #include "utility/StringView.h"
 
+#include <algorithm>
+#include <string_view>
+
 #include <spdlog/spdlog.h>
 
 namespace zen
 {
     namespace
     {
+        /** Delay before the first reconnect attempt, which doubles after every failed attempt */
+        constexpr auto RECONNECT_INITIAL_BACKOFF = std::chrono::milliseconds(100);
+        constexpr auto RECONNECT_MAX_BACKOFF = std::chrono::milliseconds(5000);
+
         void notifyProgress(std::set<std::reference_wrapper<SensorClient>, ReferenceWrapperCmp<SensorClient>>& subscribers, float progress)
         {
             ZenEvent event{};
@@ -34,6 +43,15 @@ namespace zen
             for (auto& subscriber : subscribers)
                 subscriber.get().notifyEvent(event);
         }
+
+        void notifySensorFound(SensorClient& subscriber, const ZenSensorDesc& device)
+        {
+            ZenEvent event{};
+            event.eventType = ZenEventType_SensorFound;
+            event.data.sensorFound = device;
+
+            subscriber.notifyEvent(event);
+        }
     }
 
     SensorManager& SensorManager::get()
@@ -46,7 +64,6 @@ namespace zen
         : m_nextToken(1)
         , m_discovering(false)
         , m_terminate(false)
-        , m_sensorThread(&SensorManager::sensorLoop, this)
         , m_sensorDiscoveryThread(&SensorManager::sensorDiscoveryLoop, this)   
     {
 #ifdef ZEN_BLUETOOTH_BLE
@@ -61,18 +78,29 @@ namespace zen
 
         ComponentFactoryManager::get().initialize();
         IoManager::get().initialize();
+
+        for (auto& ioSystem : IoManager::get().getIoSystems())
+            ioSystem.get().setDeviceSubscriber(this);
     }
 
     SensorManager::~SensorManager() noexcept
     {
+        for (auto& ioSystem : IoManager::get().getIoSystems())
+            ioSystem.get().setDeviceSubscriber(nullptr);
+
         m_terminate = true;
         m_discoveryCv.notify_all();
 
+        {
+            std::lock_guard<std::mutex> lock(m_supervisorMutex);
+            m_supervisorCv.notify_all();
+        }
+
         if (m_sensorDiscoveryThread.joinable())
             m_sensorDiscoveryThread.join();
 
-        if (m_sensorThread.joinable())
-            m_sensorThread.join();
+        if (m_supervisorThread.joinable())
+            m_supervisorThread.join();
     }
 
     nonstd::expected<std::shared_ptr<Sensor>, ZenSensorInitError> SensorManager::obtain(const ZenSensorDesc& const_desc) noexcept
@@ -80,12 +108,26 @@ namespace zen
         std::unique_lock<std::mutex> lock(m_sensorsMutex);
         ZenSensorDesc desc = const_desc;
 
+        // Wait until a concurrent obtain of the same sensor either added it or failed
+        const auto isSame = [&desc](const ZenSensorDesc& other) { return isSameSensor(other, desc); };
+        m_obtainCv.wait(lock, [this, &isSame]() { return std::none_of(m_obtaining.cbegin(), m_obtaining.cend(), isSame); });
+
         for (const auto& sensor : m_sensors)
             if (sensor->equals(desc))
                 return sensor;
 
+        m_obtaining.emplace_back(desc);
         lock.unlock();
 
+        // Every path below returns with lock released, so the reservation can take the mutex again
+        auto reservation = finally([this, &isSame]() {
+            {
+                std::lock_guard<std::mutex> guard(m_sensorsMutex);
+                m_obtaining.erase(std::find_if(m_obtaining.begin(), m_obtaining.end(), isSame));
+            }
+            m_obtainCv.notify_all();
+        });
+
         auto ioSystem = IoManager::get().getIoSystem(desc.ioType);
         if (!ioSystem) {
             spdlog::error("IoType {0} not supported", desc.ioType);
@@ -110,9 +152,27 @@ namespace zen
                 return nonstd::make_unexpected(ioInterface.error());
             }
 
-            auto agreement = negotiator.negotiate(*communicator.get(), desc.baudRate);
+            if (auto capture = IoCapture::openFromEnvironment(desc))
+                communicator->setCapture(std::move(capture));
+
+            // A sensor which was connected before only needs to answer, its configuration is known
+            const std::string serialNumber(desc.serialNumber);
+            auto cachedConfig = NegotiationCache::get().find(serialNumber);
+            auto agreement = cachedConfig
+                ? negotiator.validate(*communicator.get(), desc.baudRate, cachedConfig->config, cachedConfig->sensorModel)
+                : negotiator.negotiate(*communicator.get(), desc.baudRate);
+            auto negotiationTime = negotiator.negotiationDuration();
+            if (!agreement && agreement.error() == ZenSensorInitError_InvalidConfig) {
+                // Another model reuses the serial number, so it needs to be negotiated from scratch
+                NegotiationCache::get().invalidate(serialNumber);
+                cachedConfig.reset();
+                agreement = negotiator.negotiate(*communicator.get(), desc.baudRate);
+                negotiationTime += negotiator.negotiationDuration();
+            }
             if (!agreement) {
                 spdlog::error("Sensor connection cannot be negotiated");
+                if (cachedConfig)
+                    NegotiationCache::get().invalidate(serialNumber);
                 return nonstd::make_unexpected(agreement.error());
             }
 
@@ -120,14 +180,24 @@ namespace zen
             const auto token = m_nextToken++;
             lock.unlock();
 
+            const SensorConfig config = *agreement;
             auto sensor = make_sensor(std::move(*agreement), std::move(communicator), token);
             if (!sensor) {
                 spdlog::error("Sensor object cannot be created");
+
+                // The sensor might have been replaced by another model with the same serial number
+                if (cachedConfig)
+                    NegotiationCache::get().invalidate(serialNumber);
                 return nonstd::make_unexpected(sensor.error());
             }
 
+            NegotiationCache::get().store(serialNumber, { config, negotiator.sensorModel() });
+            (*sensor)->setSerialNumber(serialNumber);
+            (*sensor)->setNegotiationTime(negotiationTime);
+
             lock.lock();
             m_sensors.insert(*sensor);
+            m_sensorDescs.emplace(token, desc);
             lock.unlock();
 
             return std::move(*sensor);
@@ -158,6 +228,11 @@ namespace zen
         }
     }
 
+    bool SensorManager::isSameSensor(const ZenSensorDesc& lhs, const ZenSensorDesc& rhs) noexcept
+    {
+        return std::string_view(lhs.ioType) == rhs.ioType && std::string_view(lhs.identifier) == rhs.identifier;
+    }
+
     std::shared_ptr<Sensor> SensorManager::release(ZenSensorHandle_t sensorHandle) noexcept
     {
         std::lock_guard<std::mutex> lock(m_sensorsMutex);
@@ -165,17 +240,168 @@ namespace zen
 
         const auto sensor = *it;
         m_sensors.erase(it);
+        m_sensorDescs.erase(sensorHandle.handle);
         return sensor;
     }
 
+    ZenError SensorManager::setSupervised(Sensor& sensor, bool supervised) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
+        if (m_sensorDescs.find(sensor.token()) == m_sensorDescs.end())
+            return ZenError_NotSupported;
+
+        sensor.setSupervised(supervised);
+        return ZenError_None;
+    }
+
+    bool SensorManager::sensorFailed(uintptr_t token) noexcept
+    {
+        PendingReconnect pending;
+        {
+            std::lock_guard<std::mutex> lock(m_sensorsMutex);
+            auto it = m_sensorDescs.find(token);
+            if (it == m_sensorDescs.end())
+                return false;
+
+            pending.token = token;
+            pending.desc = it->second;
+        }
+
+        pending.attempts = 0;
+        pending.backoff = RECONNECT_INITIAL_BACKOFF;
+        pending.due = std::chrono::steady_clock::now() + pending.backoff;
+
+        std::lock_guard<std::mutex> lock(m_supervisorMutex);
+        if (m_terminate || !m_reconnecting.insert(token).second)
+            return false;
+
+        spdlog::warn("Lost connection to sensor {}, reconnecting", pending.desc.identifier);
+        m_reconnects.emplace_back(pending);
+        if (!m_supervisorThread.joinable())
+            m_supervisorThread = std::thread(&SensorManager::supervisorLoop, this);
+        m_supervisorCv.notify_one();
+        return true;
+    }
+
+    void SensorManager::supervisorLoop() noexcept
+    {
+        // Reconnects need to happen on a separate thread, because replacing an IO
+        // interface joins the IO thread which reports the failure
+        std::unique_lock<std::mutex> lock(m_supervisorMutex);
+        while (!m_terminate)
+        {
+            if (m_reconnects.empty())
+            {
+                m_supervisorCv.wait(lock);
+                continue;
+            }
+
+            auto next = std::min_element(m_reconnects.begin(), m_reconnects.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.due < rhs.due;
+            });
+
+            if (next->due > std::chrono::steady_clock::now())
+            {
+                m_supervisorCv.wait_until(lock, next->due);
+                continue;
+            }
+
+            auto pending = *next;
+            m_reconnects.erase(next);
+            lock.unlock();
+
+            const bool done = tryReconnect(pending);
+
+            lock.lock();
+            if (done)
+            {
+                m_reconnecting.erase(pending.token);
+            }
+            else
+            {
+                pending.backoff = std::min(pending.backoff * 2, std::chrono::duration_cast<std::chrono::milliseconds>(RECONNECT_MAX_BACKOFF));
+                pending.due = std::chrono::steady_clock::now() + pending.backoff;
+                m_reconnects.emplace_back(pending);
+            }
+        }
+    }
+
+    bool SensorManager::tryReconnect(PendingReconnect& pending) noexcept
+    {
+        std::shared_ptr<Sensor> sensor;
+        {
+            std::lock_guard<std::mutex> lock(m_sensorsMutex);
+            auto it = m_sensors.find(ZenSensorHandle_t{ pending.token });
+            if (it != m_sensors.end())
+                sensor = *it;
+        }
+
+        // The sensor was released or is no longer supervised
+        if (!sensor || !sensor->supervised())
+            return true;
+
+        auto ioSystem = IoManager::get().getIoSystem(pending.desc.ioType);
+        if (!ioSystem)
+            return true;
+
+        ++pending.attempts;
+        if (auto error = sensor->reconnect(ioSystem->get(), pending.desc, pending.attempts))
+        {
+            spdlog::debug("Reconnect attempt {} of sensor {} failed: {}", pending.attempts, pending.desc.identifier, error);
+            return false;
+        }
+
+        return true;
+    }
+
     void SensorManager::subscribeToSensorDiscovery(SensorClient& client) noexcept
     {
         std::lock_guard<std::mutex> lock(m_discoveryMutex);
+
+        // A client joining a running discovery still needs to learn about the sensors found so far
+        if (m_discovering && m_discoverySubscribers.find(client) == m_discoverySubscribers.end())
+            for (const auto& device : m_devices)
+                notifySensorFound(client, device);
+
         m_discoverySubscribers.insert(client);
         m_discovering = true;
         m_discoveryCv.notify_one();
     }
 
+    void SensorManager::subscribeToDeviceChanges(SensorClient& client) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_deviceSubscribersMutex);
+        m_deviceSubscribers.insert(client);
+    }
+
+    void SensorManager::unsubscribeFromDeviceChanges(SensorClient& client) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_deviceSubscribersMutex);
+        m_deviceSubscribers.erase(client);
+    }
+
+    void SensorManager::deviceAttached(const ZenSensorDesc& desc) noexcept
+    {
+        spdlog::info("Sensor {} attached to {}", desc.identifier, desc.ioType);
+
+        std::lock_guard<std::mutex> lock(m_deviceSubscribersMutex);
+        for (auto& subscriber : m_deviceSubscribers)
+            notifySensorFound(subscriber.get(), desc);
+    }
+
+    void SensorManager::deviceDetached(const ZenSensorDesc& desc) noexcept
+    {
+        spdlog::info("Sensor {} detached from {}", desc.identifier, desc.ioType);
+
+        ZenEvent event{};
+        event.eventType = ZenEventType_SensorLost;
+        event.data.sensorLost = desc;
+
+        std::lock_guard<std::mutex> lock(m_deviceSubscribersMutex);
+        for (auto& subscriber : m_deviceSubscribers)
+            subscriber.get().notifyEvent(event);
+    }
+
     void SensorManager::sensorDiscoveryLoop() noexcept
     {
         while (!m_terminate)
@@ -183,56 +409,61 @@ namespace zen
             std::unique_lock<std::mutex> lock(m_discoveryMutex);
             m_discoveryCv.wait(lock, [this]() { return m_discovering || m_terminate; });
 
+            if (m_terminate)
+                return;
+
+            notifyProgress(m_discoverySubscribers, 0.0f);
             lock.unlock();
 
+            // Every IoSystem is enumerated on its own thread, so a slow inquiry (e.g. Bluetooth)
+            // does not hold back the sensors of the other systems
             const auto ioSystems = IoManager::get().getIoSystems();
             const auto nIoSystems = ioSystems.size();
-            for (size_t idx = 0; idx < nIoSystems; ++idx)
+            size_t nCompleted = 0;
+
+            std::vector<std::thread> listingThreads;
+            listingThreads.reserve(nIoSystems);
+            for (auto& ioSystem : ioSystems)
             {
-                if (m_terminate)
-                    return;
-
-                lock.lock();
-                notifyProgress(m_discoverySubscribers, (idx + 0.5f) / nIoSystems);
-                lock.unlock();
-
-                try
-                {
-                    ioSystems[idx].get().listDevices(m_devices);
-                }
-                catch (...)
-                {
-                    // [TODO] Make listDevices noexcept and move try-catch block into crashing ioSystem
-                    continue;
-                }
+                listingThreads.emplace_back([this, &ioSystem, &nCompleted, nIoSystems]() {
+                    std::vector<ZenSensorDesc> devices;
+                    if (!m_terminate)
+                    {
+                        try
+                        {
+                            ioSystem.get().listDevices(devices);
+                        }
+                        catch (...)
+                        {
+                            // [TODO] Make listDevices noexcept and move try-catch block into crashing ioSystem
+                            devices.clear();
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(m_discoveryMutex);
+                    for (const auto& device : devices)
+                    {
+                        for (auto& subscriber : m_discoverySubscribers)
+                            notifySensorFound(subscriber.get(), device);
+
+                        m_devices.emplace_back(device);
+                    }
+
+                    // Completion of the last system is reported below, once the discovery is reset
+                    if (++nCompleted < nIoSystems)
+                        notifyProgress(m_discoverySubscribers, static_cast<float>(nCompleted) / nIoSystems);
+                });
             }
 
+            for (auto& thread : listingThreads)
+                thread.join();
 
             lock.lock();
-            for (auto& device : m_devices)
-            {
-                ZenEvent event{};
-                event.eventType = ZenEventType_SensorFound;
-                event.data.sensorFound = device;
-
-                for (auto& subscriber : m_discoverySubscribers)
-                    subscriber.get().notifyEvent(event);
-            }
-
             notifyProgress(m_discoverySubscribers, 1.0f);
-            
+
             m_devices.clear();
             m_discovering = false;
             m_discoverySubscribers.clear();
         }
     }
-
-    void SensorManager::sensorLoop()
-    {
-        while (!m_terminate)
-        {
-            CanManager::get().poll();
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-    }
 }
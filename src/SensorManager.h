@@ -12,6 +12,7 @@
 #define ZEN_SENSORMANAGER_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <map>
 #include <mutex>
@@ -27,6 +28,7 @@
 
 #include "Sensor.h"
 #include "SensorClient.h"
+#include "io/IIoSystem.h"
 #include "utility/ReferenceCmp.h"
 
 #include <memory>
@@ -40,7 +42,7 @@ namespace zen
     connected sensors. This class lives as a static singleton, which is contained
     in the get() method;
     */
-    class SensorManager
+    class SensorManager : private IIoDeviceSubscriber
     {
     public:
         /**
@@ -51,15 +53,39 @@ namespace zen
 
         static SensorManager& get();
 
-        /** Try to obtain a sensor based on a sensor description. */
+        /** Try to obtain a sensor based on a sensor description. Concurrent calls for the same
+         *  sensor wait for the first one and return its sensor.
+         */
         nonstd::expected<std::shared_ptr<Sensor>, ZenSensorInitError> obtain(const ZenSensorDesc& desc) noexcept;
 
+        /** Returns whether both descriptions refer to the same sensor of the same IO system */
+        static bool isSameSensor(const ZenSensorDesc& lhs, const ZenSensorDesc& rhs) noexcept;
+
         /** Subscribe a client to sensor discovery */
         void subscribeToSensorDiscovery(SensorClient& client) noexcept;
 
+        /** Subscribe a client to attached and detached sensors */
+        void subscribeToDeviceChanges(SensorClient& client) noexcept;
+
+        /** Unsubscribe a client from attached and detached sensors */
+        void unsubscribeFromDeviceChanges(SensorClient& client) noexcept;
+
         void registerDataProcessor(std::unique_ptr<DataProcessor> processor) noexcept;
 
+        /** Enables or disables automatic reconnects of a sensor after IO failures. Only sensors
+         * which communicate over a low-level IO system can be supervised.
+         */
+        ZenError setSupervised(Sensor& sensor, bool supervised) noexcept;
+
     private:
+        struct PendingReconnect
+        {
+            uintptr_t token;
+            ZenSensorDesc desc;
+            uint32_t attempts;
+            std::chrono::milliseconds backoff;
+            std::chrono::steady_clock::time_point due;
+        };
 
         SensorManager() noexcept;
         ~SensorManager() noexcept;
@@ -68,28 +94,58 @@ namespace zen
         std::shared_ptr<Sensor> release(ZenSensorHandle_t sensorHandle) noexcept;
 
         void sensorDiscoveryLoop() noexcept;
-        void sensorLoop();
+
+        /** Called by a supervised sensor from its IO thread, when it lost its connection.
+         * Returns false if the sensor is already being reconnected.
+         */
+        bool sensorFailed(uintptr_t token) noexcept;
+
+        void supervisorLoop() noexcept;
+
+        /** Returns true if no further attempts are necessary */
+        bool tryReconnect(PendingReconnect& pending) noexcept;
+
+        void deviceAttached(const ZenSensorDesc& desc) noexcept override;
+        void deviceDetached(const ZenSensorDesc& desc) noexcept override;
 
         std::set<std::shared_ptr<Sensor>, SensorCmp> m_sensors;
         std::set<std::reference_wrapper<SensorClient>, ReferenceWrapperCmp<SensorClient>> m_discoverySubscribers;
+        std::set<std::reference_wrapper<SensorClient>, ReferenceWrapperCmp<SensorClient>> m_deviceSubscribers;
 
         /**
         This mutex needs to be held to access or modify the m_processors vector
          */
         std::mutex m_processorsMutex;
+
+        /** Sensors found by the running discovery. Requires m_discoveryMutex. */
         std::vector<ZenSensorDesc> m_devices;
 
+        /** Sensors which are being obtained, so that they are not negotiated twice. Requires m_sensorsMutex. */
+        std::vector<ZenSensorDesc> m_obtaining;
+        std::condition_variable m_obtainCv;
+
+        /** Descriptions low-level sensors were obtained with, to reconnect them. Requires m_sensorsMutex. */
+        std::map<uintptr_t, ZenSensorDesc> m_sensorDescs;
+
+        /** Requires m_supervisorMutex */
+        std::vector<PendingReconnect> m_reconnects;
+        /** Sensors which are waiting for or in a reconnect attempt. Requires m_supervisorMutex */
+        std::set<uintptr_t> m_reconnecting;
+        std::mutex m_supervisorMutex;
+        std::condition_variable m_supervisorCv;
+        std::thread m_supervisorThread;
+
         std::condition_variable m_discoveryCv;
 
         std::mutex m_sensorsMutex;
         std::mutex m_discoveryMutex;
+        std::mutex m_deviceSubscribersMutex;
 
         uintptr_t m_nextToken;
         bool m_discovering;
 
         std::atomic_bool m_terminate;
 
-        std::thread m_sensorThread;
         std::thread m_sensorDiscoveryThread;
 
         #ifdef ZEN_BLUETOOTH_BLE
@@ -11,6 +11,7 @@
 #include "SensorProperties.h"
 
 #include <cstring>
+#include <vector>
 
 #include "ZenProtocol.h"
 
@@ -91,8 +92,10 @@ namespace zen
     {
         if (m_rules.isExecutable(property))
         {
+            // Commands like storing the settings in flash or calibrating the gyroscope keep the sensor busy
             const auto span = gsl::make_span(reinterpret_cast<const std::byte*>(&property), sizeof(property));
-            return m_communicator.sendAndWaitForAck(m_id, ZenProtocolFunction_Execute, property, span);
+            return m_communicator.sendAndWaitForAck(m_id, ZenProtocolFunction_Execute, property, span,
+                SyncedModbusCommunicator::LONG_COMMAND_TIMEOUT);
         }
 
         return ZenError_UnknownProperty;
@@ -237,6 +240,164 @@ namespace zen
         return nonstd::make_unexpected(ZenError_UnknownProperty);
     }
 
+    template <typename PropertyRules>
+    ZenError SensorProperties<PropertyRules>::batch(gsl::span<ZenPropertyValue> values, bool set) noexcept
+    {
+        // The sensor answers in order, so the batch takes about one round trip instead of one per property
+        std::vector<std::shared_ptr<SyncedModbusCommunicator::PendingRequest>> requests(values.size());
+        for (size_t idx = 0; idx < requests.size(); ++idx)
+        {
+            auto request = set ? sendSetRequest(values[idx]) : sendGetRequest(values[idx]);
+            if (request)
+                requests[idx] = std::move(*request);
+            else
+                values[idx].error = request.error();
+        }
+
+        ZenError result = ZenError_None;
+        for (size_t idx = 0; idx < requests.size(); ++idx)
+        {
+            auto& value = values[idx];
+            if (requests[idx])
+            {
+                value.error = m_communicator.wait(*requests[idx]);
+                if (value.error == ZenError_None)
+                {
+                    if (set)
+                        notifyBatchChange(value);
+                    else if (m_rules.isArray(value.property))
+                        value.bufferSize = requests[idx]->resultSize(); // Same as getArray
+                }
+            }
+
+            if (value.error != ZenError_None && result == ZenError_None)
+                result = static_cast<ZenError>(value.error);
+        }
+
+        return result;
+    }
+
+    template <typename PropertyRules>
+    typename SensorProperties<PropertyRules>::Request SensorProperties<PropertyRules>::sendGetRequest(ZenPropertyValue& value) noexcept
+    {
+        const ZenProperty_t property = value.property;
+        const auto span = gsl::make_span(reinterpret_cast<const std::byte*>(&property), sizeof(property));
+        if (m_rules.isArray(property))
+        {
+            if (value.buffer == nullptr)
+                return nonstd::make_unexpected(ZenError_IsNull);
+
+            if (m_rules.type(property) != value.type)
+                return nonstd::make_unexpected(ZenError_UnknownProperty);
+
+            const size_t elementSize = sizeOfPropertyType(value.type);
+            if (elementSize == 0)
+                return nonstd::make_unexpected(ZenError_WrongDataType);
+
+            const auto buffer = gsl::make_span(reinterpret_cast<std::byte*>(value.buffer), value.bufferSize * elementSize);
+            return m_communicator.sendRequest(m_id, ZenProtocolFunction_Get, property, span, false, buffer);
+        }
+
+        switch (value.type)
+        {
+        case ZenPropertyType_Bool:
+        case ZenPropertyType_Float:
+        case ZenPropertyType_Int32:
+        case ZenPropertyType_UInt64:
+            break;
+
+        default:
+            return nonstd::make_unexpected(ZenError_WrongDataType);
+        }
+
+        if (m_rules.type(property) != value.type)
+            return nonstd::make_unexpected(ZenError_UnknownProperty);
+
+        // All members of the union start at its address
+        const auto result = gsl::make_span(reinterpret_cast<std::byte*>(&value.value), sizeOfPropertyType(value.type));
+        return m_communicator.sendRequest(m_id, ZenProtocolFunction_Get, property, span, false, result);
+    }
+
+    template <typename PropertyRules>
+    typename SensorProperties<PropertyRules>::Request SensorProperties<PropertyRules>::sendSetRequest(const ZenPropertyValue& value) noexcept
+    {
+        if (m_rules.isArray(value.property))
+        {
+            if (value.buffer == nullptr)
+                return nonstd::make_unexpected(ZenError_IsNull);
+
+            if (m_rules.isConstant(value.property) || m_rules.type(value.property) != value.type)
+                return nonstd::make_unexpected(ZenError_UnknownProperty);
+
+            const details::PropertyData wrapper(value.property, value.buffer, sizeOfPropertyType(value.type) * value.bufferSize);
+            return m_communicator.sendRequest(m_id, ZenProtocolFunction_Set, value.property, wrapper.data(), true);
+        }
+
+        switch (value.type)
+        {
+        case ZenPropertyType_Bool:
+            return sendSetRequest(value.property, value.value.boolValue);
+
+        case ZenPropertyType_Float:
+            return sendSetRequest(value.property, value.value.floatValue);
+
+        case ZenPropertyType_Int32:
+            return sendSetRequest(value.property, value.value.int32Value);
+
+        case ZenPropertyType_UInt64:
+            return sendSetRequest(value.property, value.value.uint64Value);
+
+        default:
+            return nonstd::make_unexpected(ZenError_WrongDataType);
+        }
+    }
+
+    template <typename PropertyRules>
+    template <typename T>
+    typename SensorProperties<PropertyRules>::Request SensorProperties<PropertyRules>::sendSetRequest(ZenProperty_t property, T value) noexcept
+    {
+        if (!m_rules.isConstant(property) && m_rules.type(property) == details::PropertyType<T>::type::value)
+        {
+            const details::PropertyData wrapper(property, value);
+            return m_communicator.sendRequest(m_id, ZenProtocolFunction_Set, property, wrapper.data(), true);
+        }
+
+        return nonstd::make_unexpected(ZenError_UnknownProperty);
+    }
+
+    template <typename PropertyRules>
+    void SensorProperties<PropertyRules>::notifyBatchChange(const ZenPropertyValue& value) noexcept
+    {
+        if (m_rules.isArray(value.property))
+        {
+            // Arrays are passed with their number of elements
+            notifyPropertyChange(value.property, gsl::make_span(reinterpret_cast<const std::byte*>(value.buffer), value.bufferSize));
+            return;
+        }
+
+        switch (value.type)
+        {
+        case ZenPropertyType_Bool:
+            notifyPropertyChange(value.property, value.value.boolValue);
+            break;
+
+        case ZenPropertyType_Float:
+            notifyPropertyChange(value.property, value.value.floatValue);
+            break;
+
+        case ZenPropertyType_Int32:
+            notifyPropertyChange(value.property, value.value.int32Value);
+            break;
+
+        case ZenPropertyType_UInt64:
+            notifyPropertyChange(value.property, value.value.uint64Value);
+            break;
+
+        default:
+            break;
+        }
+    }
+
     template class SensorProperties<CorePropertyRulesV1>;
     template class SensorProperties<ImuPropertyRulesV1>;
 
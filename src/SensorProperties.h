@@ -58,6 +58,9 @@ namespace zen
         /** If successful sets the unsigned integer property, otherwise returns an error. */
         ZenError setUInt64(ZenProperty_t property, uint64_t value) noexcept override;
 
+        /** Sends the requests of all entries before waiting for the first reply */
+        ZenError batch(gsl::span<ZenPropertyValue> values, bool set) noexcept override;
+
         /** Returns whether the property is an array type */
         bool isArray(ZenProperty_t property) const noexcept override { return m_rules.isArray(property); }
 
@@ -77,6 +80,20 @@ namespace zen
         template <typename T>
         ZenError setAndAck(ZenProperty_t property, T value) noexcept;
 
+        using Request = nonstd::expected<std::shared_ptr<SyncedModbusCommunicator::PendingRequest>, ZenError>;
+
+        /** Sends the request of a batch entry which reads the property, the reply is written to the entry */
+        Request sendGetRequest(ZenPropertyValue& value) noexcept;
+
+        /** Sends the request of a batch entry which writes the property */
+        Request sendSetRequest(const ZenPropertyValue& value) noexcept;
+
+        template <typename T>
+        Request sendSetRequest(ZenProperty_t property, T value) noexcept;
+
+        /** Notifies the subscribers of a batch entry which has been written */
+        void notifyBatchChange(const ZenPropertyValue& value) noexcept;
+
         SyncedModbusCommunicator& m_communicator;
         PropertyRules m_rules;
         const uint8_t m_id;
@@ -88,30 +105,6 @@ namespace zen
 
         ZenError publishResult(ISensorProperties& self, SyncedModbusCommunicator& communicator, ZenProperty_t property, ZenError error, gsl::span<const std::byte> data) noexcept;
     }
-
-    constexpr size_t sizeOfPropertyType(ZenPropertyType type) noexcept
-    {
-        switch (type)
-        {
-        case ZenPropertyType_Byte:
-            return sizeof(std::byte);
-
-        case ZenPropertyType_Bool:
-            return sizeof(bool);
-
-        case ZenPropertyType_Float:
-            return sizeof(float);
-
-        case ZenPropertyType_Int32:
-            return sizeof(int32_t);
-
-        case ZenPropertyType_UInt64:
-            return sizeof(uint64_t);
-
-        default:
-            return 0;
-        }
-    }
 }
 
 #endif
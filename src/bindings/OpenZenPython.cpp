@@ -13,6 +13,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
 #include <array>
 
 namespace py = pybind11;
@@ -244,27 +245,108 @@ PYBIND11_MODULE(openzen, m) {
         .def_readonly("identifier", &ZenSensorDesc::identifier)
         .def_readonly("baud_rate", &ZenSensorDesc::baudRate);
 
+    py::class_<ZenRoundTripStatistics>(m,"ZenRoundTripStatistics")
+        .def_readonly("samples", &ZenRoundTripStatistics::samples)
+        .def_readonly("timeouts", &ZenRoundTripStatistics::timeouts)
+        .def_readonly("min", &ZenRoundTripStatistics::min)
+        .def_readonly("mean", &ZenRoundTripStatistics::mean)
+        .def_readonly("std_dev", &ZenRoundTripStatistics::stdDev)
+        .def_readonly("max", &ZenRoundTripStatistics::max)
+        .def_readonly("median", &ZenRoundTripStatistics::median)
+        .def_readonly("p90", &ZenRoundTripStatistics::p90)
+        .def_readonly("p99", &ZenRoundTripStatistics::p99)
+        .def_readonly("timeout", &ZenRoundTripStatistics::timeout)
+        .def_readonly("negotiation_time", &ZenRoundTripStatistics::negotiationTime);
+
+    py::class_<ZenStreamingStatistics>(m,"ZenStreamingStatistics")
+        .def_readonly("messages", &ZenStreamingStatistics::messages)
+        .def_readonly("events", &ZenStreamingStatistics::events)
+        .def_readonly("lost_messages", &ZenStreamingStatistics::lostMessages)
+        .def_readonly("gaps", &ZenStreamingStatistics::gaps)
+        .def_readonly("reordered_messages", &ZenStreamingStatistics::reorderedMessages)
+        .def_readonly("unsequenced_messages", &ZenStreamingStatistics::unsequencedMessages)
+        .def_readonly("latency_samples", &ZenStreamingStatistics::latencySamples)
+        .def_readonly("latency_min", &ZenStreamingStatistics::latencyMin)
+        .def_readonly("latency_mean", &ZenStreamingStatistics::latencyMean)
+        .def_readonly("latency_max", &ZenStreamingStatistics::latencyMax)
+        .def_readonly("latency_median", &ZenStreamingStatistics::latencyMedian)
+        .def_readonly("latency_p99", &ZenStreamingStatistics::latencyP99);
+
+    py::class_<ZenPublishOptions>(m,"ZenPublishOptions")
+        .def(py::init([]() { return ZenPublishOptions{}; }))
+        .def_readwrite("batch_size", &ZenPublishOptions::batchSize)
+        .def_readwrite("batch_interval_us", &ZenPublishOptions::batchIntervalUs)
+        .def_readwrite("batch_bytes", &ZenPublishOptions::batchBytes)
+        .def_property("sensor_topic", [](const ZenPublishOptions & options) {
+            return std::string(options.sensorTopic);
+        }, [](ZenPublishOptions & options, std::string const& topic) {
+            if (topic.size() >= sizeof(options.sensorTopic))
+                throw py::value_error("sensor_topic is too long");
+            std::copy(topic.begin(), topic.end(), options.sensorTopic);
+            options.sensorTopic[topic.size()] = '\0';
+        })
+        .def_readwrite("send_high_water_mark", &ZenPublishOptions::sendHighWaterMark)
+        .def_readwrite("send_buffer_bytes", &ZenPublishOptions::sendBufferBytes)
+        .def_readwrite("linger_ms", &ZenPublishOptions::lingerMs)
+        .def_readwrite("conflate", &ZenPublishOptions::conflate)
+        .def_readwrite("count_drops", &ZenPublishOptions::countDrops)
+        .def_readwrite("sequence_numbers", &ZenPublishOptions::sequenceNumbers);
+
+    py::class_<ZenPublishStatistics>(m,"ZenPublishStatistics")
+        .def_readonly("sent_messages", &ZenPublishStatistics::sentMessages)
+        .def_readonly("dropped_messages", &ZenPublishStatistics::droppedMessages);
+
     py::class_<ZenEventData_SensorDisconnected>(m,"SensorDisconnected")
         .def_readonly("error", &ZenEventData_SensorDisconnected::error);
 
+    py::class_<ZenEventData_SensorObtained>(m,"SensorObtained")
+        .def_readonly("desc", &ZenEventData_SensorObtained::desc)
+        .def_readonly("error", &ZenEventData_SensorObtained::error);
+
+    py::class_<ZenEventData_SensorConnection>(m,"SensorConnection")
+        .def_readonly("error", &ZenEventData_SensorConnection::error)
+        .def_readonly("reconnect_attempts", &ZenEventData_SensorConnection::reconnectAttempts)
+        .def_readonly("missed_frames", &ZenEventData_SensorConnection::missedFrames);
+
     py::class_<ZenEventData_SensorListingProgress>(m,"SensorListingProgress")
         .def_readonly("progress", &ZenEventData_SensorListingProgress::progress)
         .def_property_readonly("complete", [](const ZenEventData_SensorListingProgress & data) -> bool {
             return data.complete > 0;
         });
 
+    py::class_<ZenEventData_UpdateProgress>(m,"UpdateProgress")
+        .def_readonly("error", &ZenEventData_UpdateProgress::error)
+        .def_readonly("pages_written", &ZenEventData_UpdateProgress::pagesWritten)
+        .def_readonly("pages_total", &ZenEventData_UpdateProgress::pagesTotal)
+        .def_readonly("retries", &ZenEventData_UpdateProgress::retries)
+        .def_property_readonly("iap", [](const ZenEventData_UpdateProgress & data) -> bool {
+            return data.iap > 0;
+        })
+        .def_property_readonly("complete", [](const ZenEventData_UpdateProgress & data) -> bool {
+            return data.complete > 0;
+        });
+
     py::class_<ZenEventData>(m, "ZenEventData")
         .def_readonly("imu_data", &ZenEventData::imuData)
         .def_readonly("gnss_data", &ZenEventData::gnssData)
         .def_readonly("sensor_disconnected", &ZenEventData::sensorDisconnected)
         .def_readonly("sensor_found", &ZenEventData::sensorFound)
-        .def_readonly("sensor_listing_progress", &ZenEventData::sensorListingProgress);
+        .def_readonly("sensor_lost", &ZenEventData::sensorLost)
+        .def_readonly("sensor_obtained", &ZenEventData::sensorObtained)
+        .def_readonly("sensor_connection", &ZenEventData::sensorConnection)
+        .def_readonly("sensor_listing_progress", &ZenEventData::sensorListingProgress)
+        .def_readonly("update_progress", &ZenEventData::updateProgress);
 
     py::enum_<ZenEventType>(m, "ZenEventType")
         .value("NoType", ZenEventType_None)
         .value("SensorFound", ZenEventType_SensorFound)
         .value("SensorListingProgress", ZenEventType_SensorListingProgress)
         .value("SensorDisconnected", ZenEventType_SensorDisconnected)
+        .value("SensorLost", ZenEventType_SensorLost)
+        .value("SensorObtained", ZenEventType_SensorObtained)
+        .value("SensorConnectionLost", ZenEventType_SensorConnectionLost)
+        .value("SensorReconnected", ZenEventType_SensorReconnected)
+        .value("UpdateProgress", ZenEventType_UpdateProgress)
         .value("ImuData", ZenEventType_ImuData)
         .value("GnssData", ZenEventType_GnssData);
 
@@ -481,7 +563,18 @@ PYBIND11_MODULE(openzen, m) {
         .def_property_readonly("io_type", &ZenSensor::ioType)
         .def("equals", &ZenSensor::equals)
         .def_property_readonly("sensor", &ZenSensor::sensor)
-        .def("publish_events", &ZenSensor::publishEvents)
+        .def("publish_events", [](ZenSensor & self, std::string const& endpoint) {
+            return self.publishEvents(endpoint);
+        })
+        .def("publish_events", [](ZenSensor & self, std::string const& endpoint, ZenPublishOptions const& options) {
+            return self.publishEvents(endpoint, options);
+        })
+        .def("set_auto_reconnect", &ZenSensor::setAutoReconnect)
+        .def("round_trip_statistics", &ZenSensor::roundTripStatistics)
+        .def("streaming_statistics", &ZenSensor::streamingStatistics)
+        .def("publish_statistics", &ZenSensor::publishStatistics)
+        .def("export_configuration", &ZenSensor::exportConfiguration)
+        .def("import_configuration", &ZenSensor::importConfiguration)
         .def("execute_property", &ZenSensor::executeProperty)
 
         .def("get_array_property_float", &ZenSensor::getArrayProperty<float>)
@@ -514,7 +607,10 @@ PYBIND11_MODULE(openzen, m) {
     py::class_<ZenClient>(m,"ZenClient")
         .def("close", &ZenClient::close)
         .def("list_sensors_async", &ZenClient::listSensorsAsync)
+        .def("subscribe_to_device_changes", &ZenClient::subscribeToDeviceChanges)
         .def("obtain_sensor", &ZenClient::obtainSensor)
+        .def("obtain_sensors_async", &ZenClient::obtainSensorsAsync)
+        .def("sensor_from_handle", &ZenClient::sensorFromHandle)
         .def("obtain_sensor_by_name", &ZenClient::obtainSensorByName,
              py::arg("ioType"), py::arg("identifier"), py::arg("baudrate") = 0)
         .def("poll_next_event", &ZenClient::pollNextEvent)
@@ -21,13 +21,13 @@
 
 #include <gsl/string_span>
 
+#include <algorithm>
 #include <chrono>
-#include <thread>
 
 namespace zen
 {
     ConnectionNegotiator::ConnectionNegotiator() noexcept :
-        m_terminated(false)
+        m_negotiationDuration(0)
     {
         // add all supported sensor types and their configurations
         // only support IG1's Imu yet, second gyroscope and GNSS
@@ -66,83 +66,206 @@ namespace zen
 
     }
 
+    namespace
+    {
+        /** Timeout as long as the round-trip time of the sensor is unknown, e.g. for the first command */
+        constexpr const auto IO_TIMEOUT = std::chrono::milliseconds(2000);
+
+        /** Once the round-trip time is known, replies are expected within a multiple of it */
+        constexpr const unsigned int ROUND_TRIP_TIMEOUT_FACTOR = 10;
+        constexpr const auto MIN_REPLY_TIMEOUT = std::chrono::milliseconds(200);
+
+        enum class NegotiationState
+        {
+            CommandMode,
+            FirmwareInfo,
+            SensorModel,
+            Done
+        };
+
+        /** Returns whether the reply answers a query. Queries for data are answered with their own
+            function, commands with an acknowledgement. The sensor can refuse either of them. */
+        bool answersQuery(uint8_t queried, uint8_t reply) noexcept
+        {
+            if (reply == queried || reply == uint8_t(EDevicePropertyV1::Nack))
+                return true;
+
+            const bool returnsData = queried == uint8_t(EDevicePropertyV1::GetFirmwareInfo) ||
+                queried == uint8_t(EDevicePropertyV1::GetSensorModel);
+            return !returnsData && (reply == uint8_t(EDevicePropertyV1::Ack) || reply == ZenProtocolFunction_Handshake);
+        }
+    }
+
     nonstd::expected<SensorConfig, ZenSensorInitError> ConnectionNegotiator::negotiate(
       ModbusCommunicator& communicator, unsigned int desiredBaudRate) noexcept
     {
-        constexpr const auto IO_TIMEOUT = std::chrono::milliseconds(2000);
+        const auto start = std::chrono::steady_clock::now();
+        auto durationGuard = finally([this, start]() { recordDuration(start); });
+
         communicator.setBaudRate(desiredBaudRate);
 
-        bool commandModeReply = false;
+        // Every state moves on as soon as the sensor replies, timeouts only apply to sensors which stay silent
+        auto state = NegotiationState::CommandMode;
+        while (state != NegotiationState::Done) {
+            switch (state) {
+            case NegotiationState::CommandMode:
+                if (auto error = enterCommandMode(communicator))
+                    return nonstd::make_unexpected(error);
 
-        // try two times because in some cases, the reply of the first command send to the sensor
-        // will not be in the input buffer.
-        for (size_t retries = 0; retries < m_connectRetryAttempts; retries++) {
-            m_terminated = false;
-            spdlog::debug("Attempting to set sensor in command mode for connection negotiaton");
-            // wait for some io messages to come in
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
-            // disable streaming during connection negotiation, command same for legacy and Ig1
-            if (ZenError_None != communicator.send(0, uint8_t(EDevicePropertyV0::SetCommandMode), gsl::span<std::byte>()))
-            {
-                spdlog::error("Cannot set sensor in command mode");
-                return nonstd::make_unexpected(ZenSensorInitError_SendFailed);
+                state = NegotiationState::FirmwareInfo;
+                break;
+
+            case NegotiationState::FirmwareInfo: {
+                // will send command 21, which is GET_IMU_ID for legacy sensors. So legacy sensors will return one 32-bit
+                // result while its the GET_FIRMWARE_INFO for version 1 sensors, which is a 24-byte long string.
+                spdlog::debug("Attempting to query firmware version");
+                const auto reply = query(communicator, uint8_t(EDevicePropertyV1::GetFirmwareInfo), replyTimeout());
+                if (!reply && reply.error() == ZenSensorInitError_SendFailed) {
+                    // command not supported by sensors except ig1, in this case assume its not an ig1
+                    spdlog::info("IG1 GetSensorModel not supported, assuming its not an IG1, but a legacy device");
+                }
+                else if (reply && *reply == uint8_t(EDevicePropertyV1::Nack)) {
+                    spdlog::debug("Firmware info was refused, assuming a legacy device");
+                }
+
+                state = m_isLegacy ? NegotiationState::Done : NegotiationState::SensorModel;
+                break;
             }
-            {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                if (m_cv.wait_for(lock, IO_TIMEOUT, [this]() { return m_terminated; }) == false) {
-                    // hit timeout, will retry
-                    spdlog::debug("Time out while attempting to set sensor in command mode for connection negotiaton");
-
-                    // reset parser because if the data transmission of the sensor stopped without
-                    // sending the full package payload, we might still think we are parsing the payload
-                    // while we already get an acknowledgement for our command mode request
-                    communicator.resetParser();
-                } else {
-                    commandModeReply = true;
-                    break;
+
+            case NegotiationState::SensorModel: {
+                const auto reply = query(communicator, uint8_t(EDevicePropertyV1::GetSensorModel), replyTimeout());
+                if (!reply && reply.error() == ZenSensorInitError_SendFailed) {
+                    spdlog::error("Cannot load sensor model from IG1");
+                    return nonstd::make_unexpected(ZenSensorInitError_SendFailed);
                 }
+
+                state = NegotiationState::Done;
+                break;
             }
-        }
 
-        if (commandModeReply == false) {
-            spdlog::error("Time out when setting sensor to command mode before configuration.");
-            return nonstd::make_unexpected(ZenSensorInitError_Timeout);
+            case NegotiationState::Done:
+                break;
+            }
         }
 
-        // will send command 21, which is GET_IMU_ID for legacy sensors. So legacy sensors will return one 32-bit
-        // result while its the GET_FIRMWARE_INFO for version 1 sensors, which is a 24-byte long string.
-        spdlog::debug("Attempting to query firmware version");
-        m_terminated = false;
-        if (ZenError_None != communicator.send(0, uint8_t(EDevicePropertyV1::GetFirmwareInfo), gsl::span<std::byte>()))
-        {
-            // command not supported by sensors except ig1, in this case assume its not an ig1
-            //return nonstd::make_unexpected(ZenSensorInitError_SendFailed);
-            spdlog::info("IG1 GetSensorModel not supported, assuming its not an IG1, but a legacy device");
-        }
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_cv.wait_for(lock, IO_TIMEOUT, [this]() { return m_terminated; });
+        if (m_deviceName) {
+            spdlog::debug("Device name from Ig1 protocol: {0}", *m_deviceName);
         }
 
-        m_terminated = false;
-        if (!m_isLegacy) {
-            if (ZenError_None != communicator.send(0, uint8_t(EDevicePropertyV1::GetSensorModel), gsl::span<std::byte>()))
-            {
-                // command not supported by sensors except ig1, in this case assume its not an ig1
+        return loadDeviceConfig();
+    }
+
+    nonstd::expected<SensorConfig, ZenSensorInitError> ConnectionNegotiator::validate(
+      ModbusCommunicator& communicator, unsigned int desiredBaudRate, SensorConfig config, const std::string& cachedModel) noexcept
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto durationGuard = finally([this, start]() { recordDuration(start); });
+
+        communicator.setBaudRate(desiredBaudRate);
+
+        if (auto error = enterCommandMode(communicator))
+            return nonstd::make_unexpected(error);
+
+        // Legacy sensors do not report their model, which is why it was not cached either
+        if (config.version != 0) {
+            const auto reply = query(communicator, uint8_t(EDevicePropertyV1::GetSensorModel), replyTimeout());
+            if (!reply && reply.error() == ZenSensorInitError_SendFailed) {
                 spdlog::error("Cannot load sensor model from IG1");
                 return nonstd::make_unexpected(ZenSensorInitError_SendFailed);
             }
-            {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                m_cv.wait_for(lock, IO_TIMEOUT, [this]() { return m_terminated; });
+
+            if (sensorModel() != cachedModel) {
+                spdlog::info("Sensor model changed from {0} to {1}, cached configuration is outdated", cachedModel, sensorModel());
+                return nonstd::make_unexpected(ZenSensorInitError_InvalidConfig);
             }
         }
 
-        if (m_deviceName) {
-            spdlog::debug("Device name from Ig1 protocol: {0}", *m_deviceName);
+        spdlog::debug("Reusing cached configuration of sensor with version {0}", config.version);
+        return config;
+    }
+
+    ZenSensorInitError ConnectionNegotiator::enterCommandMode(ModbusCommunicator& communicator) noexcept
+    {
+        // try two times because in some cases, the reply of the first command send to the sensor
+        // will not be in the input buffer.
+        bool refused = false;
+        for (size_t retries = 0; retries < m_connectRetryAttempts; retries++) {
+            spdlog::debug("Attempting to set sensor in command mode for connection negotiaton");
+
+            // disable streaming during connection negotiation, command same for legacy and Ig1.
+            // The round-trip time is not known yet, so the full timeout applies
+            const auto reply = query(communicator, uint8_t(EDevicePropertyV0::SetCommandMode), IO_TIMEOUT);
+            if (reply && *reply != uint8_t(EDevicePropertyV1::Nack))
+                return ZenSensorInitError_None;
+
+            if (reply) {
+                // refused, will retry
+                refused = true;
+                spdlog::debug("Sensor refused to enter command mode for connection negotiation");
+            }
+            else if (reply.error() == ZenSensorInitError_SendFailed) {
+                spdlog::error("Cannot set sensor in command mode");
+                return ZenSensorInitError_SendFailed;
+            }
+            else {
+                // hit timeout, will retry
+                refused = false;
+                spdlog::debug("Time out while attempting to set sensor in command mode for connection negotiaton");
+            }
+
+            // reset parser because if the data transmission of the sensor stopped without
+            // sending the full package payload, we might still think we are parsing the payload
+            // while we already get an acknowledgement for our command mode request
+            communicator.resetParser();
         }
 
-        return loadDeviceConfig();
+        if (refused) {
+            spdlog::error("Sensor refused to enter command mode before configuration.");
+            return ZenSensorInitError_ConnectFailed;
+        }
+
+        spdlog::error("Time out when setting sensor to command mode before configuration.");
+        return ZenSensorInitError_Timeout;
+    }
+
+    nonstd::expected<uint8_t, ZenSensorInitError> ConnectionNegotiator::query(ModbusCommunicator& communicator,
+        uint8_t function, std::chrono::milliseconds timeout) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queriedFunction = function;
+            m_replyFunction.reset();
+        }
+
+        const auto sentAt = std::chrono::steady_clock::now();
+        if (ZenError_None != communicator.send(0, function, gsl::span<std::byte>()))
+            return nonstd::make_unexpected(ZenSensorInitError_SendFailed);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto queryGuard = finally([this]() { m_queriedFunction.reset(); });
+        if (!m_cv.wait_for(lock, timeout, [this]() { return m_replyFunction.has_value(); }))
+            return nonstd::make_unexpected(ZenSensorInitError_Timeout);
+
+        // Keep the slowest reply, so the adaptive timeout is not tightened by a single quick answer
+        const auto roundTripTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sentAt);
+        m_roundTripTime = m_roundTripTime ? std::max(*m_roundTripTime, roundTripTime) : roundTripTime;
+
+        return *m_replyFunction;
+    }
+
+    std::chrono::milliseconds ConnectionNegotiator::replyTimeout() const noexcept
+    {
+        if (!m_roundTripTime)
+            return IO_TIMEOUT;
+
+        const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(*m_roundTripTime * ROUND_TRIP_TIMEOUT_FACTOR);
+        return std::clamp<std::chrono::milliseconds>(timeout, MIN_REPLY_TIMEOUT, IO_TIMEOUT);
+    }
+
+    void ConnectionNegotiator::recordDuration(std::chrono::steady_clock::time_point start) noexcept
+    {
+        m_negotiationDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        spdlog::info("Sensor connection negotiated in {} ms", m_negotiationDuration.count());
     }
 
     nonstd::expected<SensorConfig, ZenSensorInitError> ConnectionNegotiator::loadDeviceConfig() const {
@@ -196,6 +319,7 @@ namespace zen
     {
         if ((function == ZenProtocolFunction_Handshake) ||
             (function == uint8_t(EDevicePropertyV1::Ack)) ||
+            (function == uint8_t(EDevicePropertyV1::Nack)) ||
             (function == uint8_t(EDevicePropertyV1::GetFirmwareInfo)) ||
             (function == uint8_t(EDevicePropertyV1::GetSensorModel))) {
             // fine, thats a package we can use during the connection negotiation
@@ -206,9 +330,14 @@ namespace zen
             return ZenError_None;
         }
 
-        auto guard = finally([this]() {
+        auto guard = finally([this, function]() {
             std::unique_lock<std::mutex> lock(m_mutex);
-            m_terminated = true;
+
+            // A late reply to an earlier query must not be taken for the answer to the current one
+            if (!m_queriedFunction || !answersQuery(*m_queriedFunction, function))
+                return;
+
+            m_replyFunction = function;
             lock.unlock();
 
             m_cv.notify_one();
@@ -11,8 +11,11 @@
 #ifndef ZEN_COMMUNICATION_CONNECTIONNEGOTIATOR_H_
 #define ZEN_COMMUNICATION_CONNECTIONNEGOTIATOR_H_
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <vector>
 #include <utility>
 
@@ -39,15 +42,46 @@ namespace zen
         nonstd::expected<SensorConfig, ZenSensorInitError> negotiate(ModbusCommunicator& communicator,
           unsigned int desiredBaudRate) noexcept;
 
+        /** Reuse a configuration which was negotiated before with the same sensor. Only verifies
+            that the sensor answers by setting it to command mode and, unless it is a legacy sensor,
+            that it still reports the same model. Returns ZenSensorInitError_InvalidConfig if the
+            model changed, in which case the configuration needs to be negotiated again. */
+        nonstd::expected<SensorConfig, ZenSensorInitError> validate(ModbusCommunicator& communicator,
+          unsigned int desiredBaudRate, SensorConfig config, const std::string& cachedModel) noexcept;
+
+        /** Returns the model reported by the sensor, which is empty for legacy sensors */
+        std::string sensorModel() const noexcept { return m_deviceName.value_or(""); }
+
+        /** Returns how long the last negotiation or validation took, which is also logged */
+        std::chrono::milliseconds negotiationDuration() const noexcept { return m_negotiationDuration; }
+
     private:
         ZenError processReceivedData(uint8_t address, uint8_t function,
           gsl::span<const std::byte> data) noexcept override;
 
     private:
+        /** Disables streaming, so the sensor replies to commands */
+        ZenSensorInitError enterCommandMode(ModbusCommunicator& communicator) noexcept;
+
+        /** Sends a command and returns the function of the reply as soon as it arrives. Only replies
+            which answer the command are accepted: its own function, an acknowledgement if it returns
+            no data, or a refusal. */
+        nonstd::expected<uint8_t, ZenSensorInitError> query(ModbusCommunicator& communicator, uint8_t function,
+          std::chrono::milliseconds timeout) noexcept;
+
+        /** Timeout for replies, adapted to the measured round-trip time */
+        std::chrono::milliseconds replyTimeout() const noexcept;
+
+        void recordDuration(std::chrono::steady_clock::time_point start) noexcept;
+
         nonstd::expected<SensorConfig, ZenSensorInitError> loadDeviceConfig() const;
 
         SensorConfig m_config;
-        bool m_terminated;
+        /** The function of the running query and its reply. Requires m_mutex */
+        std::optional<uint8_t> m_queriedFunction;
+        std::optional<uint8_t> m_replyFunction;
+        std::optional<std::chrono::microseconds> m_roundTripTime;
+        std::chrono::milliseconds m_negotiationDuration;
         std::optional<std::string> m_deviceName;
 
         std::vector<std::pair<std::vector<std::string>, SensorConfig >> m_sensorConfigs;
@@ -49,6 +49,9 @@ namespace zen
         /** Returns whether the IO interface equals the sensor description */
         bool equals(const ZenSensorDesc& desc) const noexcept { return m_interface->equals(desc); }
 
+        /** Returns the statistics of the messages received by the IO interface */
+        nonstd::expected<ZenStreamingStatistics, ZenError> streamingStatistics() const noexcept { return m_interface->streamingStatistics(); }
+
         void setSubscriber(IEventSubscriber& subscriber) noexcept { m_subscriber = &subscriber; }
 
         void close() {}
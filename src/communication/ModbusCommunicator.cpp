@@ -27,9 +27,41 @@ namespace zen
 
     void ModbusCommunicator::init(std::unique_ptr<IIoInterface> ioInterface) noexcept
     {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
         m_ioInterface = std::move(ioInterface);
     }
 
+    ZenError ModbusCommunicator::reconnect(IIoSystem& ioSystem, const ZenSensorDesc& desc) noexcept
+    {
+        auto ioInterface = ioSystem.obtain(desc, *this);
+        if (!ioInterface)
+            return ZenError_Io_InitFailed;
+
+        if (desc.baudRate != 0)
+            if (auto error = (*ioInterface)->setBaudRate(desc.baudRate))
+                return error;
+
+        std::unique_ptr<IIoInterface> oldInterface;
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            if (m_capture)
+                (*ioInterface)->setCapture(m_capture);
+
+            oldInterface = std::move(m_ioInterface);
+            m_ioInterface = std::move(*ioInterface);
+        }
+
+        // The old interface joins its IO thread, so it may not be destroyed while holding the lock
+        oldInterface.reset();
+
+        // The stream of the new interface starts at an arbitrary position
+        while (m_parserBusy.test_and_set(std::memory_order_acquire)) { /*spin lock*/ }
+        m_parser->reset();
+        m_parserBusy.clear(std::memory_order_release);
+
+        return ZenError_None;
+    }
+
     ZenError ModbusCommunicator::send(uint8_t address, uint8_t function, gsl::span<const std::byte> data) noexcept
     {
         SPDLOG_DEBUG("sending address: {0} function: {1} data size: {2} data: {3}",
@@ -42,9 +74,17 @@ namespace zen
             return ZenError_Io_MsgTooBig;
 
         const auto frame = m_factory->makeFrame(address, function, data.data(), static_cast<uint8_t>(data.size()));
+
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        m_ioInterface->captureSent(frame);
         return m_ioInterface->send(frame);
     }
 
+    void ModbusCommunicator::processError(ZenError error) noexcept
+    {
+        m_subscriber->processError(error);
+    }
+
     ZenError ModbusCommunicator::processData(gsl::span<const std::byte> data) noexcept
     {
         // enable this for low-level communication debugging
@@ -12,9 +12,11 @@
 #define ZEN_COMMUNICATION_MODBUSCOMMUNICATOR_H_
 
 #include <atomic>
+#include <mutex>
 
 #include "Modbus.h"
 #include "io/IIoInterface.h"
+#include "io/IIoSystem.h"
 
 namespace zen
 {
@@ -32,23 +34,56 @@ namespace zen
 
         void init(std::unique_ptr<IIoInterface> ioInterface) noexcept;
 
+        /** Replaces the IO interface with a newly obtained one for the same device, e.g. after it was unplugged */
+        ZenError reconnect(IIoSystem& ioSystem, const ZenSensorDesc& desc) noexcept;
+
         virtual ZenError send(uint8_t address, uint8_t function, gsl::span<const std::byte> data) noexcept;
 
         /** Returns whether the IO interface equals the sensor description */
-        bool equals(const ZenSensorDesc& desc) const noexcept { return m_ioInterface->equals(desc); }
+        bool equals(const ZenSensorDesc& desc) const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            return m_ioInterface->equals(desc);
+        }
 
         /** Returns the IO interface's baudrate (bit/s) */
-        nonstd::expected<int32_t, ZenError> baudRate() const noexcept { return m_ioInterface->baudRate(); }
+        nonstd::expected<int32_t, ZenError> baudRate() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            return m_ioInterface->baudRate();
+        }
 
         /** Set Baudrate of IO interface (bit/s) */
-        virtual ZenError setBaudRate(unsigned int rate) noexcept { return m_ioInterface->setBaudRate(rate); }
+        virtual ZenError setBaudRate(unsigned int rate) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            return m_ioInterface->setBaudRate(rate);
+        }
 
         /** Returns the supported baudrates of the IO interface (bit/s) */
-        nonstd::expected<std::vector<int32_t>, ZenError> supportedBaudRates() const noexcept {
-           return m_ioInterface->supportedBaudRates(); }
+        nonstd::expected<std::vector<int32_t>, ZenError> supportedBaudRates() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            return m_ioInterface->supportedBaudRates();
+        }
 
         /** Returns the type of IO interface */
-        std::string_view ioType() const noexcept { return m_ioInterface->type(); }
+        std::string_view ioType() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            return m_ioInterface->type();
+        }
+
+        /** Attach a capture which records the raw traffic of the IO interface, also after a reconnect */
+        ZenError setCapture(std::shared_ptr<IoCapture> capture) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            if (auto error = m_ioInterface->setCapture(capture))
+                return error;
+
+            m_capture = std::move(capture);
+            return ZenError_None;
+        }
 
         void setSubscriber(IModbusFrameSubscriber& subscriber) noexcept { m_subscriber = &subscriber; }
         void setFrameFactory(std::unique_ptr<modbus::IFrameFactory> factory) noexcept { m_factory = std::move(factory); }
@@ -73,6 +108,8 @@ namespace zen
     private:
         ZenError processData(gsl::span<const std::byte> data) noexcept override;
 
+        void processError(ZenError error) noexcept override;
+
         std::unique_ptr<modbus::IFrameFactory> m_factory;
 
         /** Access to the parser is only allowed if the m_parserBusy flag is true, because the
@@ -80,7 +117,12 @@ namespace zen
          */
         std::unique_ptr<modbus::IFrameParser> m_parser;
         std::atomic_flag m_parserBusy = ATOMIC_FLAG_INIT;
+
+        /** Only guards the exchange of the IO interface during a reconnect, so it is uncontended otherwise */
+        mutable std::mutex m_ioMutex;
         std::unique_ptr<IIoInterface> m_ioInterface;
+        /** Attached to every IO interface after a reconnect */
+        std::shared_ptr<IoCapture> m_capture;
     };
 
     class IModbusFrameSubscriber
@@ -88,6 +130,9 @@ namespace zen
     public:
         virtual ZenError processReceivedData(uint8_t address, uint8_t function,
           gsl::span<const std::byte> data) noexcept = 0;
+
+        /** Called from the IO thread when the IO interface stopped working */
+        virtual void processError(ZenError) noexcept {}
     };
 }
 
@@ -0,0 +1,161 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "communication/NegotiationCache.h"
+
+#include "utility/StringView.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+#include <spdlog/spdlog.h>
+
+namespace zen
+{
+    namespace
+    {
+        constexpr const char FILE_MAGIC[] = "ZCFG";
+        constexpr unsigned int FILE_VERSION = 2;
+        constexpr const char FILE_EXTENSION[] = ".zcfg";
+
+        std::optional<NegotiationCache::Entry> readEntry(const std::string& path)
+        {
+            std::ifstream file(path);
+            if (!file)
+                return std::nullopt;
+
+            std::string magic;
+            unsigned int fileVersion = 0;
+            size_t nComponents = 0;
+            NegotiationCache::Entry entry{};
+            auto& config = entry.config;
+            if (!(file >> magic >> fileVersion) || magic != FILE_MAGIC || fileVersion != FILE_VERSION)
+                return std::nullopt;
+
+            // The model name takes the rest of its line, as it may contain spaces or be empty
+            if (!file.ignore(std::numeric_limits<std::streamsize>::max(), '\n') || !std::getline(file, entry.sensorModel))
+                return std::nullopt;
+
+            if (!(file >> config.version >> nComponents))
+                return std::nullopt;
+
+            for (size_t idx = 0; idx < nComponents; ++idx)
+            {
+                ComponentConfig component{};
+                unsigned long specialOptions = 0;
+                if (!(file >> component.version >> specialOptions >> component.id))
+                    return std::nullopt;
+
+                component.specialOptions = static_cast<SpecialOptions>(specialOptions);
+                config.components.emplace_back(std::move(component));
+            }
+
+            return entry;
+        }
+
+        bool writeEntry(const std::string& path, const NegotiationCache::Entry& entry)
+        {
+            std::ofstream file(path, std::ios::trunc);
+            if (!file)
+                return false;
+
+            const auto& config = entry.config;
+            file << FILE_MAGIC << ' ' << FILE_VERSION << '\n'
+                << entry.sensorModel << '\n'
+                << config.version << ' ' << config.components.size() << '\n';
+            for (const auto& component : config.components)
+                file << component.version << ' ' << static_cast<unsigned long>(component.specialOptions) << ' ' << component.id << '\n';
+
+            return static_cast<bool>(file);
+        }
+    }
+
+    NegotiationCache& NegotiationCache::get() noexcept
+    {
+        static NegotiationCache singleton([]() {
+            const char* directory = std::getenv("OPENZEN_SENSOR_CACHE_DIR");
+            return std::string(directory ? directory : "");
+        }());
+        return singleton;
+    }
+
+    NegotiationCache::NegotiationCache(std::string directory) noexcept
+        : m_directory(std::move(directory))
+    {}
+
+    std::optional<NegotiationCache::Entry> NegotiationCache::find(const std::string& serialNumber) noexcept
+    {
+        if (serialNumber.empty())
+            return std::nullopt;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(serialNumber);
+        if (it != m_entries.cend())
+            return it->second;
+
+        if (m_directory.empty())
+            return std::nullopt;
+
+        try
+        {
+            auto entry = readEntry(filePath(serialNumber));
+            if (entry)
+                m_entries.emplace(serialNumber, *entry);
+
+            return entry;
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::warn("Cannot read cached configuration of sensor {}: {}", serialNumber, e.what());
+            return std::nullopt;
+        }
+    }
+
+    void NegotiationCache::store(const std::string& serialNumber, const Entry& entry) noexcept
+    {
+        if (serialNumber.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries[serialNumber] = entry;
+
+        if (m_directory.empty())
+            return;
+
+        try
+        {
+            if (!writeEntry(filePath(serialNumber), entry))
+                spdlog::warn("Cannot store configuration of sensor {} in {}", serialNumber, m_directory);
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::warn("Cannot store configuration of sensor {}: {}", serialNumber, e.what());
+        }
+    }
+
+    void NegotiationCache::invalidate(const std::string& serialNumber) noexcept
+    {
+        if (serialNumber.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(serialNumber);
+
+        if (!m_directory.empty())
+            std::remove(filePath(serialNumber).c_str());
+    }
+
+    std::string NegotiationCache::filePath(const std::string& serialNumber) const
+    {
+        return m_directory + "/" + util::sanitizeFileName(serialNumber) + FILE_EXTENSION;
+    }
+}
@@ -0,0 +1,67 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_COMMUNICATION_NEGOTIATIONCACHE_H_
+#define ZEN_COMMUNICATION_NEGOTIATIONCACHE_H_
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "SensorConfig.h"
+
+namespace zen
+{
+    /**
+    Remembers the sensor configuration which was negotiated for a serial number, so
+    a reconnect only needs to verify that the sensor answers and is still the same
+    model instead of querying its firmware again.
+
+    The cache lives in memory. If the environment variable OPENZEN_SENSOR_CACHE_DIR
+    is set, entries are also stored in that directory and survive restarts.
+    */
+    class NegotiationCache
+    {
+    public:
+        struct Entry
+        {
+            SensorConfig config;
+
+            /** Empty for legacy sensors, which do not report their model */
+            std::string sensorModel;
+        };
+
+        static NegotiationCache& get() noexcept;
+
+        /** The directory is empty if the cache only lives in memory */
+        explicit NegotiationCache(std::string directory) noexcept;
+
+        /** Returns the configuration negotiated for the serial number, if known */
+        std::optional<Entry> find(const std::string& serialNumber) noexcept;
+
+        /** Stores the configuration negotiated for the serial number */
+        void store(const std::string& serialNumber, const Entry& entry) noexcept;
+
+        /** Removes the configuration of the serial number, e.g. after its firmware or model changed */
+        void invalidate(const std::string& serialNumber) noexcept;
+
+    private:
+        std::string filePath(const std::string& serialNumber) const;
+
+        const std::string m_directory;
+
+        std::mutex m_mutex;
+        std::map<std::string, Entry> m_entries;
+    };
+}
+
+#endif
@@ -0,0 +1,107 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "communication/RoundTripStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "utility/Percentile.h"
+
+namespace zen
+{
+    namespace
+    {
+        /** Weight of a new sample in the smoothed mean and variance */
+        constexpr double SMOOTHING = 0.125;
+
+        /** Number of standard deviations above the mean after which a reply is considered lost */
+        constexpr double DEVIATIONS = 4.0;
+
+        /** Number of replies before the timeout is derived from the statistics */
+        constexpr uint64_t MIN_SAMPLES = 8;
+
+        constexpr unsigned int MAX_BACKOFF = 16;
+    }
+
+    RoundTripStatistics::RoundTripStatistics() noexcept
+        : m_history{}
+        , m_nSamples(0)
+        , m_nTimeouts(0)
+        , m_mean(0.0)
+        , m_variance(0.0)
+        , m_min(0.f)
+        , m_max(0.f)
+        , m_backoff(1)
+    {}
+
+    void RoundTripStatistics::addSample(std::chrono::steady_clock::duration roundTripTime) noexcept
+    {
+        const double sample = std::chrono::duration<double, std::milli>(roundTripTime).count();
+        m_history[m_nSamples % HISTORY_SIZE] = static_cast<float>(sample);
+
+        if (m_nSamples == 0)
+        {
+            m_mean = sample;
+            m_variance = 0.0;
+            m_min = m_max = static_cast<float>(sample);
+        }
+        else
+        {
+            const double delta = sample - m_mean;
+            m_mean += SMOOTHING * delta;
+            m_variance = (1.0 - SMOOTHING) * (m_variance + SMOOTHING * delta * delta);
+            m_min = std::min(m_min, static_cast<float>(sample));
+            m_max = std::max(m_max, static_cast<float>(sample));
+        }
+
+        ++m_nSamples;
+        m_backoff = 1;
+    }
+
+    void RoundTripStatistics::addTimeout() noexcept
+    {
+        ++m_nTimeouts;
+        m_backoff = std::min(m_backoff * 2, MAX_BACKOFF);
+    }
+
+    std::chrono::milliseconds RoundTripStatistics::timeout() const noexcept
+    {
+        if (m_nSamples < MIN_SAMPLES)
+            return std::min(DEFAULT_TIMEOUT * m_backoff, MAX_TIMEOUT);
+
+        const auto estimate = std::chrono::milliseconds(static_cast<int64_t>(std::ceil(m_mean + DEVIATIONS * std::sqrt(m_variance))));
+        return std::clamp(estimate * m_backoff, std::chrono::milliseconds(MIN_TIMEOUT), std::chrono::milliseconds(MAX_TIMEOUT));
+    }
+
+    ZenRoundTripStatistics RoundTripStatistics::summary() const noexcept
+    {
+        ZenRoundTripStatistics summary{};
+        summary.samples = m_nSamples;
+        summary.timeouts = m_nTimeouts;
+        summary.timeout = static_cast<float>(timeout().count());
+
+        if (m_nSamples == 0)
+            return summary;
+
+        summary.min = m_min;
+        summary.mean = static_cast<float>(m_mean);
+        summary.stdDev = static_cast<float>(std::sqrt(m_variance));
+        summary.max = m_max;
+
+        std::vector<float> sorted(m_history.begin(), m_history.begin() + std::min<uint64_t>(m_nSamples, HISTORY_SIZE));
+        std::sort(sorted.begin(), sorted.end());
+        summary.median = percentile(sorted, 0.5);
+        summary.p90 = percentile(sorted, 0.9);
+        summary.p99 = percentile(sorted, 0.99);
+        return summary;
+    }
+}
@@ -0,0 +1,70 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_COMMUNICATION_ROUNDTRIPSTATISTICS_H_
+#define ZEN_COMMUNICATION_ROUNDTRIPSTATISTICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "ZenTypes.h"
+
+namespace zen
+{
+    /** Round-trip times of the requests on one IO interface, from which the reply timeout is derived.
+     *
+     *  The timeout is the smoothed mean plus a multiple of the smoothed standard deviation, limited
+     *  to [MIN_TIMEOUT, MAX_TIMEOUT]. Until enough replies have been observed, DEFAULT_TIMEOUT is used.
+     *  Every timeout doubles the timeout of the following requests, so a link which became slower than
+     *  the current estimate is still able to answer. Not thread-safe.
+     */
+    class RoundTripStatistics
+    {
+    public:
+        constexpr static auto DEFAULT_TIMEOUT = std::chrono::milliseconds(2500);
+        constexpr static auto MIN_TIMEOUT = std::chrono::milliseconds(500);
+        constexpr static auto MAX_TIMEOUT = std::chrono::milliseconds(10000);
+
+        RoundTripStatistics() noexcept;
+
+        /** Records the round-trip time of an answered request */
+        void addSample(std::chrono::steady_clock::duration roundTripTime) noexcept;
+
+        /** Records a request which was not answered in time */
+        void addTimeout() noexcept;
+
+        /** Returns the time to wait for the reply of the next request */
+        std::chrono::milliseconds timeout() const noexcept;
+
+        /** Summarises the observed distribution of round-trip times */
+        ZenRoundTripStatistics summary() const noexcept;
+
+    private:
+        /** Number of recent samples which are kept for percentiles */
+        constexpr static size_t HISTORY_SIZE = 256;
+
+        std::array<float, HISTORY_SIZE> m_history;
+        uint64_t m_nSamples;
+        uint64_t m_nTimeouts;
+
+        /** Exponentially weighted mean and variance (ms) */
+        double m_mean;
+        double m_variance;
+        float m_min;
+        float m_max;
+
+        /** Doubles with every timeout and is reset by the next answered request */
+        unsigned int m_backoff;
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "communication/StreamingStatistics.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "utility/Percentile.h"
+
+namespace zen
+{
+    StreamingStatistics::StreamingStatistics() noexcept
+        : m_counters{}
+        , m_latencyHistory{}
+        , m_latencySum(0.0)
+    {}
+
+    void StreamingStatistics::addMessage(const std::string& stream, uint64_t sequence, uint64_t sendTimeNs, uint64_t receiveTimeNs, size_t nEvents)
+    {
+        ++m_counters.messages;
+        m_counters.events += nEvents;
+
+        auto inserted = m_expectedSequences.emplace(stream, sequence + 1);
+        uint64_t& expected = inserted.first->second;
+        if (!inserted.second)
+        {
+            if (sequence > expected)
+            {
+                m_counters.lostMessages += sequence - expected;
+                ++m_counters.gaps;
+            }
+            else if (sequence < expected && sequence != 0)
+            {
+                // the message was counted as lost when the gap opened
+                ++m_counters.reorderedMessages;
+                if (m_counters.lostMessages > 0)
+                    --m_counters.lostMessages;
+            }
+
+            if (sequence >= expected || sequence == 0)
+                expected = sequence + 1;
+        }
+
+        const auto maxLatencyNs = static_cast<uint64_t>(std::chrono::nanoseconds(MAX_LATENCY).count());
+        if (sendTimeNs <= receiveTimeNs && receiveTimeNs - sendTimeNs <= maxLatencyNs)
+            addLatency(static_cast<double>(receiveTimeNs - sendTimeNs) / 1e6);
+    }
+
+    void StreamingStatistics::addUnsequencedMessage(size_t nEvents) noexcept
+    {
+        ++m_counters.messages;
+        ++m_counters.unsequencedMessages;
+        m_counters.events += nEvents;
+    }
+
+    void StreamingStatistics::addLatency(double latencyMs) noexcept
+    {
+        const auto sample = static_cast<float>(latencyMs);
+        if (m_counters.latencySamples == 0)
+        {
+            m_counters.latencyMin = m_counters.latencyMax = sample;
+        }
+        else
+        {
+            m_counters.latencyMin = std::min(m_counters.latencyMin, sample);
+            m_counters.latencyMax = std::max(m_counters.latencyMax, sample);
+        }
+
+        m_latencyHistory[m_counters.latencySamples % HISTORY_SIZE] = sample;
+        m_latencySum += latencyMs;
+        ++m_counters.latencySamples;
+    }
+
+    ZenStreamingStatistics StreamingStatistics::summary() const noexcept
+    {
+        ZenStreamingStatistics summary = m_counters;
+        if (summary.latencySamples == 0)
+            return summary;
+
+        summary.latencyMean = static_cast<float>(m_latencySum / summary.latencySamples);
+
+        std::vector<float> sorted(m_latencyHistory.begin(), m_latencyHistory.begin() + std::min<uint64_t>(summary.latencySamples, HISTORY_SIZE));
+        std::sort(sorted.begin(), sorted.end());
+        summary.latencyMedian = percentile(sorted, 0.5);
+        summary.latencyP99 = percentile(sorted, 0.99);
+        return summary;
+    }
+}
@@ -0,0 +1,64 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_COMMUNICATION_STREAMINGSTATISTICS_H_
+#define ZEN_COMMUNICATION_STREAMINGSTATISTICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "ZenTypes.h"
+
+namespace zen
+{
+    /** Losses, reordering and latency of the messages received from a publisher.
+     *
+     *  Every stream of the publisher numbers its messages. A message whose sequence number skips ahead
+     *  of the expected one opens a gap, a message with a lower sequence number than expected arrived
+     *  out of order and is no longer counted as lost. The sequence number 0 starts a stream anew, e.g.
+     *  after the publisher was restarted. Send times which lie in the future or more than MAX_LATENCY
+     *  in the past come from a clock which is not shared and are ignored. Not thread-safe.
+     */
+    class StreamingStatistics
+    {
+    public:
+        constexpr static auto MAX_LATENCY = std::chrono::seconds(60);
+
+        StreamingStatistics() noexcept;
+
+        /** Records a message of a stream, with the send and receive time in nanoseconds of the monotonic clock */
+        void addMessage(const std::string& stream, uint64_t sequence, uint64_t sendTimeNs, uint64_t receiveTimeNs, size_t nEvents);
+
+        /** Records a message without sequence number */
+        void addUnsequencedMessage(size_t nEvents) noexcept;
+
+        ZenStreamingStatistics summary() const noexcept;
+
+    private:
+        void addLatency(double latencyMs) noexcept;
+
+        /** Number of recent latencies which are kept for percentiles */
+        constexpr static size_t HISTORY_SIZE = 256;
+
+        /** Sequence number which is expected next on each stream */
+        std::unordered_map<std::string, uint64_t> m_expectedSequences;
+
+        ZenStreamingStatistics m_counters;
+
+        std::array<float, HISTORY_SIZE> m_latencyHistory;
+        double m_latencySum;
+    };
+}
+
+#endif
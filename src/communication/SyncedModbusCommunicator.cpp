@@ -10,34 +10,89 @@
 
 #include "SyncedModbusCommunicator.h"
 
+#include <algorithm>
 #include <cstring>
 
-#include "utility/Finally.h"
+#include <spdlog/spdlog.h>
 
 namespace zen
 {
+    namespace
+    {
+        /** Number of requests which may be in flight, as sensors only buffer a few commands */
+        constexpr size_t MAX_PENDING_REQUESTS = 8;
+    }
+
     SyncedModbusCommunicator::SyncedModbusCommunicator(std::unique_ptr<ModbusCommunicator> communicator) noexcept
         : m_communicator(std::move(communicator))
-        , m_waiting ATOMIC_FLAG_INIT
-        , m_publishing ATOMIC_FLAG_INIT
-        , m_resultError(ZenError_None)
     {}
 
-    ZenError SyncedModbusCommunicator::sendAndWaitForAck(uint8_t address, uint8_t function, ZenProperty_t property,
-        gsl::span<const std::byte> data) noexcept
+    nonstd::expected<std::shared_ptr<SyncedModbusCommunicator::PendingRequest>, ZenError> SyncedModbusCommunicator::sendRequest(
+        uint8_t address, uint8_t function, ZenProperty_t property, gsl::span<const std::byte> data, bool forAck,
+        gsl::span<std::byte> result, std::chrono::milliseconds minTimeout) noexcept
     {
-        if (auto error = tryToWait(property, true)) {
-            return error;
-        }
+        std::shared_ptr<PendingRequest> request(new PendingRequest(property, forAck, result.data(), result.size(), minTimeout));
 
-        auto guard = finally([this]() {
-            m_waiting.clear();
-        });
+        std::lock_guard<std::mutex> sendLock(m_sendMutex);
+        {
+            std::unique_lock<std::mutex> lock(m_requestsMutex);
+            const auto deadline = std::chrono::steady_clock::now() + m_statistics.timeout();
+            while (m_requests.size() >= MAX_PENDING_REQUESTS)
+            {
+                // Requests whose caller stopped waiting would otherwise occupy the pipeline forever
+                expireRequests();
+                if (m_requests.size() < MAX_PENDING_REQUESTS)
+                    break;
+
+                if (m_requestsCv.wait_until(lock, std::min(deadline, m_requests.front()->m_deadline)) == std::cv_status::timeout &&
+                    std::chrono::steady_clock::now() >= deadline)
+                    return nonstd::make_unexpected(ZenError_Io_Timeout);
+            }
+
+            request->m_sentTime = std::chrono::steady_clock::now();
+            request->m_deadline = request->m_sentTime + std::max(m_statistics.timeout(), minTimeout);
+            m_requests.emplace_back(request);
+        }
 
         if (auto error = m_communicator->send(address, function, data))
-            return error;
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMutex);
+            auto it = std::find(m_requests.begin(), m_requests.end(), request);
+            if (it != m_requests.end())
+                remove(it, error);
 
-        return terminateWaitOnPublishOrTimeout();
+            return nonstd::make_unexpected(error);
+        }
+
+        return request;
+    }
+
+    ZenError SyncedModbusCommunicator::wait(PendingRequest& request) noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_requestsMutex);
+        while (!request.m_completed)
+        {
+            if (m_requestsCv.wait_until(lock, request.m_deadline) == std::cv_status::timeout)
+                expireRequests();
+        }
+
+        return request.m_error;
+    }
+
+    ZenRoundTripStatistics SyncedModbusCommunicator::roundTripStatistics() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_requestsMutex);
+        return m_statistics.summary();
+    }
+
+    ZenError SyncedModbusCommunicator::sendAndWaitForAck(uint8_t address, uint8_t function, ZenProperty_t property,
+        gsl::span<const std::byte> data, std::chrono::milliseconds minTimeout) noexcept
+    {
+        auto request = sendRequest(address, function, property, data, true, {}, minTimeout);
+        if (!request)
+            return request.error();
+
+        return wait(**request);
     }
 
     ZenError SyncedModbusCommunicator::sendAndDontWait(uint8_t address, uint8_t function, ZenProperty_t,
@@ -53,47 +108,30 @@ namespace zen
     std::pair<ZenError, size_t> SyncedModbusCommunicator::sendAndWaitForArray(uint8_t address, uint8_t function,
         ZenProperty_t property, gsl::span<const std::byte> data, gsl::span<T> outArray) noexcept
     {
-        if (auto error = tryToWait(property, false))
-            return std::make_pair(error, outArray.size());
-
-        m_resultPtr = outArray.data();
         // size() returns the number of elements in the span
         // and not the buffer size in bytes;
-        m_resultSize = outArray.size() * sizeof(T);
-
-        auto guard = finally([this]() {
-            m_resultPtr = nullptr;
-            m_waiting.clear();
-        });
-
-        if (auto error = m_communicator->send(address, function, data))
-            return std::make_pair(error, outArray.size());
+        const auto buffer = gsl::make_span(reinterpret_cast<std::byte*>(outArray.data()), outArray.size() * sizeof(T));
+        auto request = sendRequest(address, function, property, data, false, buffer);
+        if (!request)
+            return std::make_pair(request.error(), outArray.size());
 
-        if (auto error = terminateWaitOnPublishOrTimeout())
+        if (auto error = wait(**request))
             return std::make_pair(error, outArray.size());
 
-        return std::make_pair(ZenError_None, m_resultSize);
+        return std::make_pair(ZenError_None, (*request)->m_resultSize);
     }
 
     template <typename T>
     nonstd::expected<T, ZenError> SyncedModbusCommunicator::sendAndWaitForResult(uint8_t address, uint8_t function,
         ZenProperty_t property, gsl::span<const std::byte> data) noexcept
     {
-        if (auto error = tryToWait(property, false))
-            return nonstd::make_unexpected(error);
-
         T result;
-        m_resultPtr = &result;
-
-        auto guard = finally([this]() {
-            m_resultPtr = nullptr;
-            m_waiting.clear();
-        });
+        auto request = sendRequest(address, function, property, data, false,
+            gsl::make_span(reinterpret_cast<std::byte*>(&result), sizeof(T)));
+        if (!request)
+            return nonstd::make_unexpected(request.error());
 
-        if (auto error = m_communicator->send(address, function, data))
-            return nonstd::make_unexpected(error);
-
-        if (auto error = terminateWaitOnPublishOrTimeout())
+        if (auto error = wait(**request))
             return nonstd::make_unexpected(error);
 
         return result;
@@ -101,18 +139,19 @@ namespace zen
 
     ZenError SyncedModbusCommunicator::publishAck(ZenProperty_t property, ZenError error) noexcept
     {
-        if (!prepareForPublishing())
+        std::lock_guard<std::mutex> lock(m_requestsMutex);
+        auto it = findRequest(property, true, error);
+        if (discardLateReply(property, true, error, it))
             return ZenError_None;
 
-        auto guard = finally([this]() {
-            m_publishing.clear();
-        });
+        // If no one is waiting, there is no need to publish
+        if (m_requests.empty())
+            return ZenError_None;
 
-        if (corruptMessage(property, true))
-            return m_resultError = ZenError_Io_UnexpectedFunction;
+        if (it == m_requests.end())
+            return ZenError_Io_UnexpectedFunction;
 
-        m_resultError = error;
-        m_fence.terminate();
+        complete(it, error);
         return ZenError_None;
     }
 
@@ -120,121 +159,146 @@ namespace zen
     ZenError SyncedModbusCommunicator::publishArray(ZenProperty_t property, ZenError error,
         gsl::span<const T> array) noexcept
     {
-        if (!prepareForPublishing())
+        std::lock_guard<std::mutex> lock(m_requestsMutex);
+        auto it = findRequest(property, false, error);
+        if (discardLateReply(property, false, error, it))
             return ZenError_None;
 
-        auto guard = finally([this]() {
-            m_publishing.clear();
-        });
+        if (m_requests.empty())
+            return ZenError_None;
 
-        if (corruptMessage(property, false))
-            return m_resultError = ZenError_Io_MsgCorrupt;
+        if (it == m_requests.end())
+            return ZenError_Io_MsgCorrupt;
 
-        const auto bufferLength = m_resultSize;
+        auto& request = **it;
+        const auto bufferLength = request.m_resultSize;
         // size() returns the number of elements in the span
         // and not the buffer size in bytes;
-        m_resultSize = array.size() * sizeof(T);
+        request.m_resultSize = array.size() * sizeof(T);
 
-        auto guard2 = finally([this]() {
-            m_fence.terminate();
-        });
-
-        if (m_resultSize > bufferLength)
-            return m_resultError = ZenError_BufferTooSmall;
+        if (request.m_resultSize > bufferLength)
+        {
+            complete(it, ZenError_BufferTooSmall);
+            return ZenError_BufferTooSmall;
+        }
 
         if (array.data() == nullptr)
-            return m_resultError = ZenError_IsNull;
+        {
+            complete(it, ZenError_IsNull);
+            return ZenError_IsNull;
+        }
 
-        m_resultError = error;
-        std::memcpy(m_resultPtr, array.data(), array.size_bytes());
+        std::memcpy(request.m_resultPtr, array.data(), array.size_bytes());
+        complete(it, error);
         return ZenError_None;
     }
 
     template <typename T>
     ZenError SyncedModbusCommunicator::publishResult(ZenProperty_t property, ZenError error, T result) noexcept
     {
-        if (!prepareForPublishing())
+        std::lock_guard<std::mutex> lock(m_requestsMutex);
+        auto it = findRequest(property, false, error);
+        if (discardLateReply(property, false, error, it))
             return ZenError_None;
 
-        auto guard = finally([this]() {
-            m_publishing.clear();
-        });
+        if (m_requests.empty())
+            return ZenError_None;
 
-        if (corruptMessage(property, false))
-            return m_resultError = ZenError_Io_MsgCorrupt;
+        if (it == m_requests.end())
+            return ZenError_Io_MsgCorrupt;
 
-        m_resultError = error;
-        *reinterpret_cast<T*>(m_resultPtr) = result;
-        m_fence.terminate();
+        auto& request = **it;
+        if (request.m_resultSize < sizeof(T))
+        {
+            complete(it, ZenError_BufferTooSmall);
+            return ZenError_BufferTooSmall;
+        }
+
+        std::memcpy(request.m_resultPtr, &result, sizeof(T));
+        complete(it, error);
         return ZenError_None;
     }
 
-    ZenError SyncedModbusCommunicator::tryToWait(ZenProperty_t property, bool forAck) noexcept
+    std::deque<std::shared_ptr<SyncedModbusCommunicator::PendingRequest>>::iterator SyncedModbusCommunicator::findRequest(
+        ZenProperty_t property, bool isAck, ZenError error) noexcept
     {
-        if (m_waiting.test_and_set())
-            return ZenError_Io_Busy;
+        // A sensor rejects any kind of request with a negative acknowledgement. As it answers in order,
+        // that is the oldest pending request, even if it waits for a result.
+        if (isAck && error != ZenError_None)
+            return m_requests.begin();
+
+        // When we receive an acknowledgement, we can't match the property
+        return std::find_if(m_requests.begin(), m_requests.end(), [=](const auto& request) {
+            return isAck ? request->m_forAck : (!request->m_forAck && request->m_property == property);
+        });
+    }
 
-        m_waitingForAck = forAck;
-        m_property = property;
-        m_resultError = ZenError_None;
+    void SyncedModbusCommunicator::complete(std::deque<std::shared_ptr<PendingRequest>>::iterator it, ZenError error) noexcept
+    {
+        // Long commands measure the sensor's processing time, which would inflate the timeout of all other requests
+        if ((*it)->m_minTimeout == std::chrono::milliseconds::zero())
+            m_statistics.addSample(std::chrono::steady_clock::now() - (*it)->m_sentTime);
 
-        return ZenError_None;
+        remove(it, error);
     }
 
-    ZenError SyncedModbusCommunicator::terminateWaitOnPublishOrTimeout() noexcept
+    std::deque<std::shared_ptr<SyncedModbusCommunicator::PendingRequest>>::iterator SyncedModbusCommunicator::remove(
+        std::deque<std::shared_ptr<PendingRequest>>::iterator it, ZenError error) noexcept
     {
-        constexpr static auto IO_TIMEOUT = std::chrono::milliseconds(2500);
+        (*it)->m_error = error;
+        (*it)->m_completed = true;
+        m_requestsCv.notify_all();
+        return m_requests.erase(it);
+    }
 
-        if (!m_fence.waitFor(IO_TIMEOUT))
+    void SyncedModbusCommunicator::expireRequests() noexcept
+    {
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = m_requests.begin(); it != m_requests.end();)
         {
-            // Second chance, in case we timed out right after the interface started publishing
-            if (!m_publishing.test_and_set())
+            if ((*it)->m_deadline <= now)
             {
-                m_publishing.clear();
-                return ZenError_Io_Timeout;
-            }
+                // The reply may still be on its way, it is expected for as long again as the request waited for it
+                const auto& request = **it;
+                m_expiredRequests.push_back({ request.m_property, request.m_forAck, request.m_sentTime,
+                    now + (request.m_deadline - request.m_sentTime) });
 
-            m_fence.wait();
+                m_statistics.addTimeout();
+                it = remove(it, ZenError_Io_Timeout);
+            }
+            else
+            {
+                ++it;
+            }
         }
-
-        // If terminated, reset
-        const auto error = m_resultError;
-        m_fence.reset();
-        return error;
     }
 
-    bool SyncedModbusCommunicator::prepareForPublishing() noexcept
+    bool SyncedModbusCommunicator::discardLateReply(ZenProperty_t property, bool isAck, ZenError error,
+        std::deque<std::shared_ptr<PendingRequest>>::const_iterator match) noexcept
     {
-        // In case a waiter is checking whether we are publishing, we are already too late
-        if (m_publishing.test_and_set())
+        const auto now = std::chrono::steady_clock::now();
+        m_expiredRequests.erase(std::remove_if(m_expiredRequests.begin(), m_expiredRequests.end(), [now](const ExpiredRequest& expired) {
+            return expired.forgetTime <= now;
+        }), m_expiredRequests.end());
+
+        // Same matching as for pending requests, see findRequest
+        auto expired = isAck && error != ZenError_None
+            ? m_expiredRequests.begin()
+            : std::find_if(m_expiredRequests.begin(), m_expiredRequests.end(), [=](const ExpiredRequest& request) {
+                return isAck ? request.forAck : (!request.forAck && request.property == property);
+            });
+        if (expired == m_expiredRequests.end())
             return false;
 
-        // If no one is waiting, there is no need to publish
-        if (!m_waiting.test_and_set())
-        {
-            m_waiting.clear();
-            m_publishing.clear();
+        // The sensor answers in order, so the reply belongs to whichever request was sent first
+        if (match != m_requests.cend() && (*match)->m_sentTime < expired->sentTime)
             return false;
-        }
 
+        spdlog::warn("Discarding reply for property {} which arrived after its request timed out", expired->property);
+        m_expiredRequests.erase(expired);
         return true;
     }
 
-    bool SyncedModbusCommunicator::corruptMessage(ZenProperty_t property, bool isAck) noexcept
-    {
-        // When we receive an acknowledgement, we can't match the property
-        if (isAck)
-            return !m_waitingForAck;
-
-        if (m_waitingForAck)
-            return true;
-
-        if (m_property != property)
-            return true;
-
-        return false;
-    }
-
     template ZenError SyncedModbusCommunicator::publishArray(ZenProperty_t, ZenError, gsl::span<const std::byte>) noexcept;
     template ZenError SyncedModbusCommunicator::publishArray(ZenProperty_t, ZenError, gsl::span<const bool>) noexcept;
     template ZenError SyncedModbusCommunicator::publishArray(ZenProperty_t, ZenError, gsl::span<const float>) noexcept;
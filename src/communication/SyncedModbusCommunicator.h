@@ -11,27 +11,86 @@
 #ifndef ZEN_COMMUNICATION_SYNCEDMODBUSCOMMUNICATOR_H_
 #define ZEN_COMMUNICATION_SYNCEDMODBUSCOMMUNICATOR_H_
 
-#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <gsl/span>
 #include <nonstd/expected.hpp>
 
 #include "communication/ModbusCommunicator.h"
-#include "utility/ThreadFence.h"
+#include "communication/RoundTripStatistics.h"
 
 namespace zen
 {
-    /** The synchronised communication pipeline */
+    /** The synchronised communication pipeline
+     *
+     *  Several requests can be in flight at the same time. Results are matched to the oldest
+     *  pending request of the same property, acknowledgements to the oldest pending request which
+     *  waits for an acknowledgement, as the sensor answers commands in order. Negative acknowledgements
+     *  reject the oldest pending request of any kind. Callers queue up
+     *  once the pipeline is full. Requests time out based on the round-trip times observed so far,
+     *  unless the caller asks for a longer minimum because the sensor needs time to process them.
+     *  A reply which arrives after its request timed out is discarded, instead of being credited to
+     *  the next pending request.
+     */
     class SyncedModbusCommunicator
     {
     public:
+        /** Minimum timeout of commands which keep the sensor busy, e.g. writing its flash or calibrating.
+         *  Their replies are not representative for the round-trip time, which only depends on the link.
+         */
+        constexpr static auto LONG_COMMAND_TIMEOUT = RoundTripStatistics::DEFAULT_TIMEOUT;
+
+        /** Completion object of a request which has been sent to the IO interface */
+        class PendingRequest
+        {
+        public:
+            /** Returns the property the request is waiting for */
+            ZenProperty_t property() const noexcept { return m_property; }
+
+            /** Returns the size of the received result (bytes), once the request has been answered */
+            size_t resultSize() const noexcept { return m_resultSize; }
+
+        private:
+            friend class SyncedModbusCommunicator;
+
+            PendingRequest(ZenProperty_t property, bool forAck, void* resultPtr, size_t resultSize,
+                std::chrono::milliseconds minTimeout) noexcept
+                : m_property(property)
+                , m_forAck(forAck)
+                , m_minTimeout(minTimeout)
+                , m_resultPtr(resultPtr)
+                , m_resultSize(resultSize)
+                , m_error(ZenError_None)
+                , m_completed(false)
+            {}
+
+            const ZenProperty_t m_property;
+            const bool m_forAck;
+            const std::chrono::milliseconds m_minTimeout;
+
+            /** Buffer the result is written to, and the size of the result (bytes) */
+            void* const m_resultPtr;
+            size_t m_resultSize;
+
+            std::chrono::steady_clock::time_point m_sentTime;
+            std::chrono::steady_clock::time_point m_deadline;
+            ZenError m_error;
+            bool m_completed;
+        };
+
         SyncedModbusCommunicator(std::unique_ptr<ModbusCommunicator> communicator) noexcept;
 
         /** Close the IO interface. It is no longer usable after this point! */
         void close() { m_communicator.reset(); }
 
+        /** Replaces the IO interface with a newly obtained one for the same device */
+        ZenError reconnect(IIoSystem& ioSystem, const ZenSensorDesc& desc) noexcept { return m_communicator->reconnect(ioSystem, desc); }
+
         /** Returns the IO interface's baudrate (bit/s) */
         nonstd::expected<int32_t, ZenError> baudRate() const noexcept { return m_communicator->baudRate(); }
 
@@ -47,8 +106,23 @@ namespace zen
         /** Returns whether the IO interface equals the sensor description */
         bool equals(const ZenSensorDesc& desc) const noexcept { return m_communicator->equals(desc); }
 
-        /** Sends data to the IO interface, and waits for an acknowledgment */
-        ZenError sendAndWaitForAck(uint8_t address, uint8_t function, ZenProperty_t property, gsl::span<const std::byte> data) noexcept;
+        /** Returns the round-trip times of the requests sent so far */
+        ZenRoundTripStatistics roundTripStatistics() const noexcept;
+
+        /** Sends a request to the IO interface without waiting for its reply. A non-empty result buffer
+         * receives the reply and needs to stay valid until wait returned. Blocks while the pipeline is full.
+         * The request times out after the adaptive timeout, but not before minTimeout.
+         */
+        nonstd::expected<std::shared_ptr<PendingRequest>, ZenError> sendRequest(uint8_t address, uint8_t function, ZenProperty_t property,
+            gsl::span<const std::byte> data, bool forAck, gsl::span<std::byte> result = {},
+            std::chrono::milliseconds minTimeout = std::chrono::milliseconds::zero()) noexcept;
+
+        /** Waits until the reply of the request has been published, or timeout. Returns the error of the reply. */
+        ZenError wait(PendingRequest& request) noexcept;
+
+        /** Sends data to the IO interface, and waits for an acknowledgment, see sendRequest */
+        ZenError sendAndWaitForAck(uint8_t address, uint8_t function, ZenProperty_t property, gsl::span<const std::byte> data,
+            std::chrono::milliseconds minTimeout = std::chrono::milliseconds::zero()) noexcept;
 
         ZenError sendAndDontWait(uint8_t address, uint8_t function, ZenProperty_t property,
             gsl::span<const std::byte> data) noexcept;
@@ -73,30 +147,45 @@ namespace zen
         ZenError publishResult(ZenProperty_t property, ZenError error, T result) noexcept;
 
     private:
-        /** Wait until a response has been published from the IO interface, or timeout. */
-        ZenError terminateWaitOnPublishOrTimeout() noexcept;
+        /** Returns the oldest pending request which matches the response, or end. Requires m_requestsMutex. */
+        std::deque<std::shared_ptr<PendingRequest>>::iterator findRequest(ZenProperty_t property, bool isAck, ZenError error) noexcept;
 
-        /** Try to obtain access to the IO interface. If successful, the caller gains unique access, otherwise returns an error. */
-        ZenError tryToWait(ZenProperty_t property, bool forAck) noexcept;
+        /** Completes an answered request and records its round-trip time. Requires m_requestsMutex. */
+        void complete(std::deque<std::shared_ptr<PendingRequest>>::iterator it, ZenError error) noexcept;
 
-        /** Signal that you are going to publish a response. */
-        bool prepareForPublishing() noexcept;
+        /** Completes the request and removes it from the pipeline. Requires m_requestsMutex. */
+        std::deque<std::shared_ptr<PendingRequest>>::iterator remove(std::deque<std::shared_ptr<PendingRequest>>::iterator it, ZenError error) noexcept;
 
-        /** Check whether the response is corrupt. */
-        bool corruptMessage(ZenProperty_t property, bool isAck) noexcept;
+        /** Times out all requests whose deadline has passed. Requires m_requestsMutex. */
+        void expireRequests() noexcept;
 
-        std::unique_ptr<ModbusCommunicator> m_communicator;
+        /** Returns whether the response answers a request which timed out, rather than the matching pending
+         *  request, and forgets that request. Requires m_requestsMutex.
+         */
+        bool discardLateReply(ZenProperty_t property, bool isAck, ZenError error,
+            std::deque<std::shared_ptr<PendingRequest>>::const_iterator match) noexcept;
+
+        /** A request which timed out, whose reply might still arrive */
+        struct ExpiredRequest
+        {
+            ZenProperty_t property;
+            bool forAck;
+            std::chrono::steady_clock::time_point sentTime;
 
-        ThreadFence m_fence;
-        std::atomic_flag m_waiting;
-        std::atomic_flag m_publishing;
+            /** A reply is no longer expected after this point */
+            std::chrono::steady_clock::time_point forgetTime;
+        };
+
+        std::unique_ptr<ModbusCommunicator> m_communicator;
 
-        ZenError m_resultError;
-        ZenProperty_t m_property;
-        bool m_waitingForAck;  // If not, waiting for data
+        /** Keeps requests in the order in which they are sent */
+        std::mutex m_sendMutex;
 
-        void* m_resultPtr;
-        size_t m_resultSize;
+        mutable std::mutex m_requestsMutex;
+        std::condition_variable m_requestsCv;
+        std::deque<std::shared_ptr<PendingRequest>> m_requests;
+        std::deque<ExpiredRequest> m_expiredRequests;
+        RoundTripStatistics m_statistics;
     };
 }
 
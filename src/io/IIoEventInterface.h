@@ -44,6 +44,12 @@ namespace zen
         /** Returns whether the IO interface equals the sensor description */
         virtual bool equals(const ZenSensorDesc& desc) const noexcept = 0;
 
+        /** Returns the losses, reordering and latency of the received messages, if the IO interface keeps track of them */
+        virtual nonstd::expected<ZenStreamingStatistics, ZenError> streamingStatistics() const noexcept
+        {
+            return nonstd::make_unexpected(ZenError_NotSupported);
+        }
+
     protected:
         /** Publish received data to the subscriber */
         virtual ZenError publishReceivedData(ZenEvent evt) { return m_subscriber.processEvent(evt); }
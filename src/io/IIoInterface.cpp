@@ -0,0 +1,30 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/IIoInterface.h"
+
+#include "io/IoCapture.h"
+
+namespace zen
+{
+    void IIoInterface::captureSent(gsl::span<const std::byte> data) noexcept
+    {
+        if (auto capture = m_capture.load(std::memory_order_acquire))
+            capture->record(IoCaptureDirection::Sent, data);
+    }
+
+    ZenError IIoInterface::publishReceivedData(gsl::span<const std::byte> data)
+    {
+        if (auto capture = m_capture.load(std::memory_order_acquire))
+            capture->record(IoCaptureDirection::Received, data);
+
+        return m_subscriber.processData(data);
+    }
+}
@@ -11,7 +11,9 @@
 #ifndef ZEN_IO_IIOINTERFACE_H_
 #define ZEN_IO_IIOINTERFACE_H_
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string_view>
 #include <vector>
 
@@ -22,10 +24,15 @@
 
 namespace zen
 {
+    class IoCapture;
+
     class IIoDataSubscriber
     {
     public:
         virtual ZenError processData(gsl::span<const std::byte> data) noexcept = 0;
+
+        /** Called from the IO thread when the IO interface stopped working, e.g. because the device was unplugged */
+        virtual void processError(ZenError) noexcept {}
     };
 
     class IIoInterface
@@ -52,12 +59,37 @@ namespace zen
         /** Returns whether the IO interface equals the sensor description */
         virtual bool equals(const ZenSensorDesc& desc) const noexcept = 0;
 
+        /** Attach a capture which records all sent and received data. A capture can only be attached once
+         *  and stays attached for the lifetime of the IO interface.
+         */
+        ZenError setCapture(std::shared_ptr<IoCapture> capture) noexcept
+        {
+            if (m_captureOwner)
+                return ZenError_AlreadyInitialized;
+
+            m_captureOwner = std::move(capture);
+            m_capture = m_captureOwner.get();
+            return ZenError_None;
+        }
+
+        /** Record data which is about to be sent, if a capture is attached */
+        void captureSent(gsl::span<const std::byte> data) noexcept;
+
     protected:
         /** Publish received data to the subscriber */
-        ZenError publishReceivedData(gsl::span<const std::byte> data) { return m_subscriber.processData(data); }
+        ZenError publishReceivedData(gsl::span<const std::byte> data);
+
+        /** Notify the subscriber that no more data can be received */
+        void publishError(ZenError error) noexcept
+        {
+            m_subscriber.processError(error);
+        }
 
     private:
         IIoDataSubscriber& m_subscriber;
+
+        std::shared_ptr<IoCapture> m_captureOwner;
+        std::atomic<IoCapture*> m_capture = nullptr;
     };
 }
 
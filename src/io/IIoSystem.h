@@ -22,6 +22,16 @@
 
 namespace zen
 {
+    class IIoDeviceSubscriber
+    {
+    public:
+        /** Called when a sensor has been attached to the IO system */
+        virtual void deviceAttached(const ZenSensorDesc& desc) noexcept = 0;
+
+        /** Called when a sensor has been detached from the IO system */
+        virtual void deviceDetached(const ZenSensorDesc& desc) noexcept = 0;
+    };
+
     class IIoSystem
     {
     public:
@@ -45,6 +55,11 @@ namespace zen
         }
 
         virtual uint32_t getDefaultBaudrate() { return 0; }
+
+        /** Sets the subscriber which is notified about attached and detached sensors. IO systems which cannot
+         *  monitor their devices ignore it. Pass nullptr to stop the notifications.
+         */
+        virtual void setDeviceSubscriber(IIoDeviceSubscriber*) noexcept {}
     };
 }
 
@@ -0,0 +1,268 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/IoCapture.h"
+
+#include "utility/Finally.h"
+#include "utility/LittleEndian.h"
+#include "utility/StringView.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+namespace zen
+{
+    namespace
+    {
+        constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(100);
+    }
+
+    nonstd::expected<std::shared_ptr<IoCapture>, ZenError> IoCapture::open(const std::string& path, size_t bufferSize) noexcept
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            spdlog::error("Cannot open IO capture file {}", path);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        const int64_t wallClockStart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        std::byte header[IoCaptureFormat::FileHeaderSize];
+        std::memcpy(header, IoCaptureFormat::Magic, sizeof(IoCaptureFormat::Magic));
+        auto dst = writeLittleEndian(header + sizeof(IoCaptureFormat::Magic), IoCaptureFormat::Version);
+        writeLittleEndian(dst, wallClockStart);
+
+        if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header))
+        {
+            std::fclose(file);
+            spdlog::error("Cannot write header of IO capture file {}", path);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        spdlog::info("Capturing IO traffic to {}", path);
+        return std::shared_ptr<IoCapture>(new IoCapture(file, bufferSize));
+    }
+
+    std::shared_ptr<IoCapture> IoCapture::openFromEnvironment(const ZenSensorDesc& desc) noexcept
+    {
+        const char* directory = std::getenv("OPENZEN_IO_CAPTURE_DIR");
+        if (directory == nullptr || directory[0] == '\0')
+            return nullptr;
+
+        const auto epochMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        const std::string path = std::string(directory) + "/" + util::sanitizeFileName(desc.ioType) + "_"
+            + util::sanitizeFileName(desc.identifier) + "_" + std::to_string(epochMs) + IoCaptureFormat::FileExtension;
+
+        if (auto capture = open(path))
+            return std::move(*capture);
+
+        return nullptr;
+    }
+
+    nonstd::expected<std::vector<IoCaptureRecord>, ZenError> IoCapture::load(const std::string& path) noexcept
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            spdlog::error("Cannot open IO capture file {}", path);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        auto guard = finally([file]() {
+            std::fclose(file);
+        });
+
+        std::byte header[IoCaptureFormat::FileHeaderSize];
+        if (std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
+            std::memcmp(header, IoCaptureFormat::Magic, sizeof(IoCaptureFormat::Magic)) != 0)
+        {
+            spdlog::error("{} is not an IO capture file", path);
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+        }
+
+        uint32_t version;
+        readLittleEndian(header + sizeof(IoCaptureFormat::Magic), version);
+        if (version != IoCaptureFormat::Version)
+        {
+            spdlog::error("IO capture file {} has unsupported version {}", path, version);
+            return nonstd::make_unexpected(ZenError_NotSupported);
+        }
+
+        // The payload sizes are checked against the file size, so a corrupt size cannot allocate arbitrary amounts of memory
+        long fileSize = -1;
+        const long dataStart = std::ftell(file);
+        if (dataStart != -1 && std::fseek(file, 0, SEEK_END) == 0)
+            fileSize = std::ftell(file);
+        if (fileSize == -1 || std::fseek(file, dataStart, SEEK_SET) != 0)
+        {
+            spdlog::error("Cannot determine the size of IO capture file {}", path);
+            return nonstd::make_unexpected(ZenError_Io_ReadFailed);
+        }
+
+        std::vector<IoCaptureRecord> records;
+        std::byte recordHeader[IoCaptureFormat::RecordHeaderSize];
+        while (true)
+        {
+            const size_t nRead = std::fread(recordHeader, 1, sizeof(recordHeader), file);
+            if (nRead != sizeof(recordHeader))
+            {
+                if (std::ferror(file))
+                {
+                    spdlog::error("Cannot read record of IO capture file {}", path);
+                    return nonstd::make_unexpected(ZenError_Io_ReadFailed);
+                }
+
+                // A capture which was not closed properly, e.g. after a crash, can end with a partial record
+                if (nRead != 0)
+                    spdlog::warn("IO capture file {} ends with a truncated record header", path);
+                break;
+            }
+
+            IoCaptureRecord record;
+            uint8_t direction;
+            uint32_t size;
+
+            auto src = readLittleEndian(recordHeader, record.timestamp);
+            src = readLittleEndian(src, direction);
+            readLittleEndian(src, size);
+
+            const long position = std::ftell(file);
+            if (position == -1)
+            {
+                spdlog::error("Cannot read record of IO capture file {}", path);
+                return nonstd::make_unexpected(ZenError_Io_ReadFailed);
+            }
+
+            if (size > static_cast<unsigned long>(fileSize - position))
+            {
+                spdlog::warn("IO capture file {} ends with a truncated record of {} bytes", path, size);
+                break;
+            }
+
+            record.direction = static_cast<IoCaptureDirection>(direction);
+            record.data.resize(size);
+            if (std::fread(record.data.data(), 1, size, file) != size)
+            {
+                spdlog::error("Cannot read record of IO capture file {}", path);
+                return nonstd::make_unexpected(ZenError_Io_ReadFailed);
+            }
+
+            records.emplace_back(std::move(record));
+        }
+
+        return records;
+    }
+
+    IoCapture::IoCapture(std::FILE* file, size_t bufferSize) noexcept
+        : m_file(file)
+        , m_start(std::chrono::steady_clock::now())
+        , m_front(bufferSize)
+        , m_back(bufferSize)
+        , m_frontSize(0)
+        , m_backSize(0)
+        , m_backPending(false)
+        , m_terminate(false)
+        , m_droppedBytes(0)
+        , m_flushThread(&IoCapture::flushLoop, this)
+    {}
+
+    IoCapture::~IoCapture() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_terminate = true;
+        }
+        m_cv.notify_one();
+
+        if (m_flushThread.joinable())
+            m_flushThread.join();
+
+        if (m_droppedBytes > 0)
+            spdlog::warn("IO capture dropped {} bytes because the disk could not keep up", m_droppedBytes.load());
+
+        std::fclose(m_file);
+    }
+
+    void IoCapture::record(IoCaptureDirection direction, gsl::span<const std::byte> data) noexcept
+    {
+        const uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count();
+
+        const size_t recordSize = IoCaptureFormat::RecordHeaderSize + data.size();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_frontSize + recordSize > m_front.size())
+        {
+            // Hand the full buffer to the flush thread, unless it is still busy with the previous one
+            if (m_backPending || recordSize > m_front.size())
+            {
+                m_droppedBytes += data.size();
+                return;
+            }
+
+            std::swap(m_front, m_back);
+            m_backSize = m_frontSize;
+            m_frontSize = 0;
+            m_backPending = true;
+
+            lock.unlock();
+            m_cv.notify_one();
+            lock.lock();
+        }
+
+        auto dst = m_front.data() + m_frontSize;
+        dst = writeLittleEndian(dst, timestamp);
+        dst = writeLittleEndian(dst, static_cast<uint8_t>(direction));
+        dst = writeLittleEndian(dst, static_cast<uint32_t>(data.size()));
+        if (!data.empty())
+            std::memcpy(dst, data.data(), data.size());
+
+        m_frontSize += recordSize;
+    }
+
+    void IoCapture::flushLoop() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cv.wait_for(lock, FLUSH_INTERVAL, [this]() { return m_backPending || m_terminate; });
+
+            // Periodically flush partially filled buffers as well, so the capture survives a crash
+            if (!m_backPending && m_frontSize > 0)
+            {
+                std::swap(m_front, m_back);
+                m_backSize = m_frontSize;
+                m_frontSize = 0;
+                m_backPending = true;
+            }
+
+            if (m_backPending)
+            {
+                lock.unlock();
+                if (std::fwrite(m_back.data(), 1, m_backSize, m_file) != m_backSize)
+                    spdlog::error("Failed to write to IO capture file");
+                std::fflush(m_file);
+                lock.lock();
+
+                m_backSize = 0;
+                m_backPending = false;
+            }
+
+            if (m_terminate && m_frontSize == 0)
+                return;
+        }
+    }
+}
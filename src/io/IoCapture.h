@@ -0,0 +1,124 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_IOCAPTURE_H_
+#define ZEN_IO_IOCAPTURE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gsl/span>
+#include <nonstd/expected.hpp>
+
+#include "ZenTypes.h"
+
+namespace zen
+{
+    /** Direction of a captured byte chunk, as seen from the host */
+    enum class IoCaptureDirection : uint8_t
+    {
+        Received = 0,
+        Sent = 1
+    };
+
+    /** Layout of a capture file. All values are stored in little-endian byte order.
+     *
+     *  File header (16 bytes):
+     *    char[4]  magic "ZCAP"
+     *    uint32   format version
+     *    int64    wall-clock time of the capture start (ns since the UNIX epoch)
+     *
+     *  Followed by records (13 byte header + payload):
+     *    uint64   monotonic timestamp relative to the capture start (ns)
+     *    uint8    IoCaptureDirection
+     *    uint32   payload size
+     *    byte[]   payload
+     */
+    namespace IoCaptureFormat
+    {
+        constexpr char Magic[4] = { 'Z', 'C', 'A', 'P' };
+        constexpr uint32_t Version = 1;
+        constexpr size_t FileHeaderSize = 16;
+        constexpr size_t RecordHeaderSize = 13;
+        constexpr const char FileExtension[] = ".zcap";
+    }
+
+    /** A single chunk of a capture file */
+    struct IoCaptureRecord
+    {
+        /** Monotonic time since the capture start (ns) */
+        uint64_t timestamp;
+        IoCaptureDirection direction;
+        std::vector<std::byte> data;
+    };
+
+    /** Records raw byte chunks exchanged with an IO interface into a capture file.
+     *
+     *  Records are appended to a preallocated buffer on the calling thread and written
+     *  to disk by a background thread, so recording never blocks on file IO. If the disk
+     *  cannot keep up, records are dropped and counted instead of stalling the caller.
+     */
+    class IoCapture
+    {
+    public:
+        static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+        /** Creates the capture file at path and starts the flush thread */
+        static nonstd::expected<std::shared_ptr<IoCapture>, ZenError> open(const std::string& path, size_t bufferSize = DEFAULT_BUFFER_SIZE) noexcept;
+
+        /** Opens a capture file for the sensor in the directory set by the OPENZEN_IO_CAPTURE_DIR
+         *  environment variable. Returns nullptr if the variable is not set.
+         */
+        static std::shared_ptr<IoCapture> openFromEnvironment(const ZenSensorDesc& desc) noexcept;
+
+        /** Reads all records of the capture file at path. A truncated record at the end of the file is skipped. */
+        static nonstd::expected<std::vector<IoCaptureRecord>, ZenError> load(const std::string& path) noexcept;
+
+        ~IoCapture() noexcept;
+
+        /** Appends a timestamped chunk to the capture */
+        void record(IoCaptureDirection direction, gsl::span<const std::byte> data) noexcept;
+
+        /** Returns the number of bytes which could not be captured because the buffers were full */
+        uint64_t droppedBytes() const noexcept { return m_droppedBytes; }
+
+    private:
+        IoCapture(std::FILE* file, size_t bufferSize) noexcept;
+
+        void flushLoop() noexcept;
+
+        std::FILE* m_file;
+        const std::chrono::steady_clock::time_point m_start;
+
+        /** Records are appended to the front buffer, the back buffer is owned by the flush thread while m_backPending is set */
+        std::vector<std::byte> m_front;
+        std::vector<std::byte> m_back;
+        size_t m_frontSize;
+        size_t m_backSize;
+        bool m_backPending;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::atomic_bool m_terminate;
+        std::atomic_uint64_t m_droppedBytes;
+
+        std::thread m_flushThread;
+    };
+}
+
+#endif
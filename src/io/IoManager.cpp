@@ -15,6 +15,7 @@
 
 #include "io/systems/BleSystem.h"
 #include "io/systems/BluetoothSystem.h"
+#include "io/systems/ReplaySystem.h"
 #include "io/systems/TestSensorSystem.h"
 #ifdef ZEN_NETWORK
 #include "io/systems/ZeroMQSystem.h"
@@ -28,6 +29,8 @@
 #include "io/systems/windows/WindowsDeviceSystem.h"
 #elif __linux__
 #include "io/systems/linux/LinuxDeviceSystem.h"
+#include "io/systems/linux/SocketCanSystem.h"
+#include "io/systems/linux/SharedMemorySystem.h"
 #elif __APPLE__
 #include "io/systems/mac/MacDeviceSystem.h"
 #endif
@@ -35,6 +38,7 @@
 namespace zen
 {
     static auto testSensorRegistry = makeRegistry<TestSensorSystem>();
+    static auto replayRegistry = makeRegistry<ReplaySystem>();
 #ifdef ZEN_BLUETOOTH_BLE
     static auto bleRegistry = makeRegistry<BleSystem>();
 #endif
@@ -56,6 +60,8 @@ namespace zen
     static auto windowsDeviceRegistry = makeRegistry<WindowsDeviceSystem>();
 #elif __linux__
     static auto linuxDeviceRegistry = makeRegistry<LinuxDeviceSystem>();
+    static auto socketCanRegistry = makeRegistry<SocketCanSystem>();
+    static auto sharedMemoryRegistry = makeRegistry<SharedMemorySystem>();
 #elif __APPLE__
     static auto macDeviceRegistry = makeRegistry<MacDeviceSystem>();
 #endif
@@ -13,6 +13,8 @@
 #include <new>
 #include <type_traits>
 
+#include <spdlog/spdlog.h>
+
 namespace zen
 {
     namespace CanManagerSingleton
@@ -39,28 +41,53 @@ namespace zen
         return CanManagerSingleton::g_singleton;
     }
 
+    CanManager::~CanManager()
+    {
+        std::lock_guard<std::mutex> lock(m_channelsMutex);
+        for (auto& [channel, thread] : m_channels)
+        {
+            channel->cancelWait();
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
     bool CanManager::registerChannel(ICanChannel& channel)
     {
-        auto result = m_channels.emplace(&channel);
-        return result.second;
+        std::lock_guard<std::mutex> lock(m_channelsMutex);
+        if (m_channels.find(&channel) != m_channels.end())
+            return false;
+
+        m_channels.emplace(&channel, std::thread(&CanManager::dispatchLoop, std::ref(channel)));
+        return true;
     }
 
     void CanManager::unregisterChannel(ICanChannel& channel)
     {
-        m_channels.erase(&channel);
+        std::lock_guard<std::mutex> lock(m_channelsMutex);
+        auto it = m_channels.find(&channel);
+        if (it == m_channels.end())
+            return;
+
+        channel.cancelWait();
+        if (it->second.joinable())
+            it->second.join();
+
+        m_channels.erase(it);
     }
 
     bool CanManager::available()
     {
+        std::lock_guard<std::mutex> lock(m_channelsMutex);
         return !m_channels.empty();
     }
 
-    ZenError CanManager::poll()
+    void CanManager::dispatchLoop(ICanChannel& channel) noexcept
     {
-        for (auto& channel : m_channels)
-            if (auto error = channel->poll())
-                return error;
-
-        return ZenError_None;
+        while (channel.waitForData())
+        {
+            if (auto error = channel.poll())
+                spdlog::error("Failed to poll CAN channel {}: {}", channel.channel(), error);
+        }
     }
 }
@@ -12,31 +12,40 @@
 #define ZEN_IO_CAN_CANMANAGER_H_
 
 #include <atomic>
-#include <set>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include "ZenTypes.h"
 #include "io/can/ICanChannel.h"
 
 namespace zen
 {
+    /**
+    Dispatches the data of all registered CAN channels. Every channel gets a dispatch
+    thread when it registers, which sleeps until the channel signals received data.
+    */
     class CanManager
     {
     public:
         static CanManager& get();
 
+        ~CanManager();
+
         bool registerChannel(ICanChannel& channel);
         void unregisterChannel(ICanChannel& channel);
 
         bool available();
 
-        ZenError poll();
-
         // [XXX] Should not be able to change after init (config?) Requires restart
         uint32_t id() const { return m_id; }
         void setId(uint32_t id) { m_id = id; }
 
     private:
-        std::set<ICanChannel*> m_channels;
+        static void dispatchLoop(ICanChannel& channel) noexcept;
+
+        std::map<ICanChannel*, std::thread> m_channels;
+        std::mutex m_channelsMutex;
         std::atomic_uint32_t m_id;
     };
 
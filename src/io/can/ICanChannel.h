@@ -48,6 +48,12 @@ namespace zen
         /** Poll data from CAN bus */
         virtual ZenError poll() noexcept = 0;
 
+        /** Blocks until data can be polled from the CAN bus. Returns false if the wait was cancelled. */
+        virtual bool waitForData() noexcept = 0;
+
+        /** Wakes up waitForData and makes all further calls return immediately */
+        virtual void cancelWait() noexcept = 0;
+
         /** Returns the channel Id */
         virtual unsigned int channel() const noexcept = 0;
 
@@ -57,6 +63,9 @@ namespace zen
         /** Returns whether the CAN channel equals the IO type */
         virtual bool equals(std::string_view ioType) const noexcept = 0;
 
+        /** Returns whether the CAN channel is connected to the named bus, as in "<id>@<bus>" identifiers */
+        virtual bool equalsBus(std::string_view) const noexcept { return false; }
+
     protected:
         ZenError publishReceivedData(CanInterface& canInterface, gsl::span<const std::byte> data) { return canInterface.publishReceivedData(data); }
 
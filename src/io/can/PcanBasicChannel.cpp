@@ -13,6 +13,8 @@
 #include <limits>
 #include <string>
 
+#include <spdlog/spdlog.h>
+
 #include "communication/Modbus.h"
 #include "io/can/CanManager.h"
 #include "io/interfaces/CanInterface.h"
@@ -24,6 +26,9 @@ namespace zen
 {
     namespace
     {
+        /** Polling interval if the driver cannot signal received messages */
+        constexpr DWORD FALLBACK_POLL_INTERVAL_MS = 1;
+
         TPCANMsg makeMsg(uint32_t id, unsigned char type, const std::byte* data, uint8_t length) noexcept
         {
             TPCANMsg m;
@@ -79,13 +84,32 @@ namespace zen
 
     PcanBasicChannel::PcanBasicChannel(TPCANHandle channel)
         : m_channel(channel)
-    {}
+        , m_receiveEvent(::CreateEvent(nullptr, FALSE, FALSE, nullptr))
+        , m_cancelEvent(::CreateEvent(nullptr, TRUE, FALSE, nullptr))
+        , m_hasReceiveEvent(false)
+    {
+        if (m_receiveEvent == nullptr)
+            spdlog::warn("Cannot create receive event for PCAN channel {}, polling instead", m_channel);
+        else if (auto error = PcanBasicSystem::fnTable.setValue(m_channel, PCAN_RECEIVE_EVENT, &m_receiveEvent, sizeof(m_receiveEvent)))
+            spdlog::warn("PCAN channel {} does not support receive events (error {}), polling instead", m_channel, error);
+        else
+            m_hasReceiveEvent = true;
+    }
 
     PcanBasicChannel::~PcanBasicChannel()
     {
         CanManager::get().unregisterChannel(*this);
 
+        if (m_hasReceiveEvent)
+        {
+            HANDLE noEvent = nullptr;
+            PcanBasicSystem::fnTable.setValue(m_channel, PCAN_RECEIVE_EVENT, &noEvent, sizeof(noEvent));
+        }
         PcanBasicSystem::fnTable.uninitialize(m_channel);
+
+        if (m_receiveEvent != nullptr)
+            ::CloseHandle(m_receiveEvent);
+        ::CloseHandle(m_cancelEvent);
     }
 
     bool PcanBasicChannel::subscribe(CanInterface& i) noexcept
@@ -149,11 +173,20 @@ namespace zen
         TPCANMsg m;
         TPCANTimestamp t;
 
+        // The receive event is reset by waiting on it, so the queue has to be drained completely
+        // even if a subscriber fails. Otherwise the remaining messages are only read once the
+        // next message arrives.
+        ZenError publishError = ZenError_None;
         for (;;)
         {
             if (auto error = PcanBasicSystem::fnTable.read(m_channel, &m, &t))
-                return error == PCAN_ERROR_QRCVEMPTY ? ZenError_None : ZenError_Io_ReadFailed;
-             
+            {
+                if (error != PCAN_ERROR_QRCVEMPTY)
+                    return ZenError_Io_ReadFailed;
+
+                return publishError;
+            }
+
             auto it = m_subscribers.find(static_cast<uint32_t>(m.ID));
             if (it == m_subscribers.cend())
             {
@@ -161,11 +194,26 @@ namespace zen
                 continue;
             }
 
-            if (auto error = publishReceivedData(*it->second, gsl::make_span(reinterpret_cast<std::byte*>(m.DATA), static_cast<size_t>(m.LEN))))
-                return error;
+            const auto error = publishReceivedData(*it->second, gsl::make_span(reinterpret_cast<std::byte*>(m.DATA), static_cast<size_t>(m.LEN)));
+            if (error && publishError == ZenError_None)
+                publishError = error;
         }
     }
 
+    bool PcanBasicChannel::waitForData() noexcept
+    {
+        if (!m_hasReceiveEvent)
+            return ::WaitForSingleObject(m_cancelEvent, FALLBACK_POLL_INTERVAL_MS) == WAIT_TIMEOUT;
+
+        const HANDLE events[2] = { m_receiveEvent, m_cancelEvent };
+        return ::WaitForMultipleObjects(2, events, FALSE, INFINITE) == WAIT_OBJECT_0;
+    }
+
+    void PcanBasicChannel::cancelWait() noexcept
+    {
+        ::SetEvent(m_cancelEvent);
+    }
+
     bool PcanBasicChannel::equals(std::string_view ioType) const noexcept
     {
         return ioType == PcanBasicSystem::KEY;
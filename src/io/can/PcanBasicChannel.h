@@ -42,6 +42,14 @@ namespace zen
         /** Poll data from CAN bus */
         ZenError poll() noexcept override;
 
+        /** Blocks until the PCAN receive event is signalled, or for the polling interval if the driver
+         *  does not support receive events. Returns false if the wait was cancelled.
+         */
+        bool waitForData() noexcept override;
+
+        /** Wakes up waitForData and makes all further calls return immediately */
+        void cancelWait() noexcept override;
+
         /** Returns the channel Id */
         unsigned int channel() const noexcept override { return m_channel; }
 
@@ -74,6 +82,11 @@ namespace zen
 
         TPCANHandle m_channel;
         unsigned int m_baudrate;
+
+        /** Signalled by the PCAN driver when a message was received */
+        HANDLE m_receiveEvent;
+        HANDLE m_cancelEvent;
+        bool m_hasReceiveEvent;
     };
 }
 
@@ -0,0 +1,341 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/can/SocketCanChannel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <set>
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "io/can/CanManager.h"
+#include "io/interfaces/CanInterface.h"
+#include "io/systems/linux/SocketCanSystem.h"
+
+namespace zen
+{
+    namespace
+    {
+        /** Time to listen on the bus for sensors which are not connected yet */
+        constexpr auto DISCOVERY_WINDOW = std::chrono::milliseconds(500);
+
+        /** Bitrate assumed for the bus, as it is configured outside of OpenZen */
+        constexpr unsigned int DEFAULT_BAUDRATE = 125000;
+
+        nonstd::expected<int, ZenError> openSocket(unsigned int interfaceIndex) noexcept
+        {
+            const int fd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+            if (fd == -1)
+                return nonstd::make_unexpected(ZenError_Io_InitFailed);
+
+            struct sockaddr_can address;
+            std::memset(&address, 0, sizeof(address));
+            address.can_family = AF_CAN;
+            address.can_ifindex = static_cast<int>(interfaceIndex);
+            if (-1 == ::bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)))
+            {
+                ::close(fd);
+                return nonstd::make_unexpected(ZenError_Io_InitFailed);
+            }
+
+            return fd;
+        }
+
+        bool isDataFrame(const struct can_frame& frame) noexcept
+        {
+            return (frame.can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG)) == 0;
+        }
+
+        uint32_t frameId(const struct can_frame& frame) noexcept
+        {
+            return frame.can_id & ((frame.can_id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK);
+        }
+    }
+
+    nonstd::expected<std::unique_ptr<SocketCanChannel>, ZenError> SocketCanChannel::open(const std::string& interfaceName) noexcept
+    {
+        const unsigned int interfaceIndex = ::if_nametoindex(interfaceName.c_str());
+        if (interfaceIndex == 0)
+        {
+            spdlog::error("CAN network interface {} does not exist", interfaceName);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        auto fd = openSocket(interfaceIndex);
+        if (!fd)
+        {
+            spdlog::error("Cannot open raw CAN socket on {}", interfaceName);
+            return nonstd::make_unexpected(fd.error());
+        }
+
+        const int wakeFd = ::eventfd(0, EFD_CLOEXEC);
+        if (wakeFd == -1)
+        {
+            ::close(*fd);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        // Receive nothing until the first interface subscribes
+        if (-1 == ::setsockopt(*fd, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0))
+        {
+            ::close(wakeFd);
+            ::close(*fd);
+            return nonstd::make_unexpected(ZenError_Io_SetFailed);
+        }
+
+        return std::unique_ptr<SocketCanChannel>(new SocketCanChannel(interfaceName, interfaceIndex, *fd, wakeFd));
+    }
+
+    SocketCanChannel::SocketCanChannel(std::string interfaceName, unsigned int interfaceIndex, int fd, int wakeFd) noexcept
+        : m_interfaceName(std::move(interfaceName))
+        , m_interfaceIndex(interfaceIndex)
+        , m_fd(fd)
+        , m_wakeFd(wakeFd)
+        , m_baudRate(DEFAULT_BAUDRATE)
+        , m_terminate(false)
+    {}
+
+    SocketCanChannel::~SocketCanChannel()
+    {
+        CanManager::get().unregisterChannel(*this);
+
+        ::close(m_wakeFd);
+        ::close(m_fd);
+    }
+
+    bool SocketCanChannel::subscribe(CanInterface& i) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_subscribersMutex);
+
+        // Did someone already subscribe to this ID?
+        if (m_subscribers.find(i.id()) != m_subscribers.cend())
+            return false;
+
+        m_subscribers.emplace(i.id(), &i);
+        if (updateFilter() != ZenError_None)
+        {
+            m_subscribers.erase(i.id());
+            return false;
+        }
+
+        return true;
+    }
+
+    void SocketCanChannel::unsubscribe(CanInterface& i) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_subscribersMutex);
+
+        auto it = m_subscribers.find(i.id());
+        if (it != m_subscribers.cend() && it->second == &i)
+        {
+            m_subscribers.erase(it);
+            updateFilter();
+        }
+    }
+
+    ZenError SocketCanChannel::listDevices(std::vector<ZenSensorDesc>& outDevices) noexcept
+    {
+        // The receive socket only sees subscribed IDs, so listen on a separate
+        // unfiltered socket for a moment to find the other sensors on the bus
+        auto fd = openSocket(m_interfaceIndex);
+        if (!fd)
+            return ZenError_Device_ListingFailed;
+
+        std::set<uint32_t> deviceIds;
+        const auto deadline = std::chrono::steady_clock::now() + DISCOVERY_WINDOW;
+        for (auto now = std::chrono::steady_clock::now(); now < deadline; now = std::chrono::steady_clock::now())
+        {
+            struct pollfd pfd = { *fd, POLLIN, 0 };
+            const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            if (::poll(&pfd, 1, static_cast<int>(timeout)) <= 0)
+                break;
+
+            struct can_frame frame;
+            if (::read(*fd, &frame, sizeof(frame)) != sizeof(frame))
+                continue;
+
+            if (isDataFrame(frame))
+                deviceIds.emplace(frameId(frame));
+        }
+        ::close(*fd);
+
+        std::lock_guard<std::mutex> lock(m_subscribersMutex);
+        for (uint32_t deviceId : deviceIds)
+        {
+            if (m_subscribers.find(deviceId) != m_subscribers.cend())
+                continue;
+
+            // The network interface is appended to the ID, so sensors can be obtained on the right bus
+            const std::string identifier = std::to_string(deviceId) + "@" + m_interfaceName;
+            if (identifier.size() >= sizeof(ZenSensorDesc::identifier))
+                continue;
+
+            ZenSensorDesc desc;
+            std::memcpy(desc.name, identifier.c_str(), identifier.size());
+            desc.name[identifier.size()] = '\0';
+
+            desc.serialNumber[0] = '\0';
+            std::memcpy(desc.ioType, SocketCanSystem::KEY, sizeof(SocketCanSystem::KEY));
+
+            std::memcpy(desc.identifier, identifier.c_str(), identifier.size());
+            desc.identifier[identifier.size()] = '\0';
+
+            desc.baudRate = m_baudRate;
+            outDevices.emplace_back(desc);
+        }
+
+        return ZenError_None;
+    }
+
+    std::string_view SocketCanChannel::type() const noexcept
+    {
+        return SocketCanSystem::KEY;
+    }
+
+    bool SocketCanChannel::equals(std::string_view ioType) const noexcept
+    {
+        return ioType == SocketCanSystem::KEY;
+    }
+
+    ZenError SocketCanChannel::send(uint32_t id, gsl::span<const std::byte> data) noexcept
+    {
+        struct can_frame frame;
+        std::memset(&frame, 0, sizeof(frame));
+        frame.can_id = id > CAN_SFF_MASK ? (id | CAN_EFF_FLAG) : id;
+
+        for (auto it = data.begin(); it != data.end();)
+        {
+            const auto length = std::min<std::ptrdiff_t>(CAN_MAX_DLEN, data.end() - it);
+            frame.can_dlc = static_cast<uint8_t>(length);
+            std::memcpy(frame.data, &*it, static_cast<size_t>(length));
+            it += length;
+
+            if (::write(m_fd, &frame, sizeof(frame)) != sizeof(frame))
+                return ZenError_Io_SendFailed;
+        }
+
+        return ZenError_None;
+    }
+
+    ZenError SocketCanChannel::setBaudRate(unsigned int rate) noexcept
+    {
+        if (rate == m_baudRate)
+            return ZenError_None;
+
+        spdlog::warn("Bitrate of CAN interface {} needs to be configured by the system", m_interfaceName);
+        return ZenError_NotSupported;
+    }
+
+    nonstd::expected<std::vector<int32_t>, ZenError> SocketCanChannel::supportedBaudRates() const noexcept
+    {
+        return std::vector<int32_t>{ static_cast<int32_t>(m_baudRate.load()) };
+    }
+
+    ZenError SocketCanChannel::updateFilter() noexcept
+    {
+        std::vector<struct can_filter> filters;
+        filters.reserve(m_subscribers.size());
+        for (const auto& subscriber : m_subscribers)
+        {
+            struct can_filter filter;
+            filter.can_id = subscriber.first > CAN_SFF_MASK ? (subscriber.first | CAN_EFF_FLAG) : subscriber.first;
+            filter.can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG | (subscriber.first > CAN_SFF_MASK ? CAN_EFF_MASK : CAN_SFF_MASK);
+            filters.emplace_back(filter);
+        }
+
+        const auto size = static_cast<socklen_t>(filters.size() * sizeof(struct can_filter));
+        if (-1 == ::setsockopt(m_fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.empty() ? nullptr : filters.data(), size))
+        {
+            spdlog::error("Cannot set CAN filter on {}", m_interfaceName);
+            return ZenError_Io_SetFailed;
+        }
+
+        return ZenError_None;
+    }
+
+    bool SocketCanChannel::waitForData() noexcept
+    {
+        struct pollfd pfds[2] = {
+            { m_fd, POLLIN, 0 },
+            { m_wakeFd, POLLIN, 0 }
+        };
+
+        while (!m_terminate)
+        {
+            if (::poll(pfds, 2, -1) == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                spdlog::error("Polling CAN interface {} failed", m_interfaceName);
+                return false;
+            }
+
+            if (pfds[1].revents & POLLIN)
+                return false;
+
+            // The socket can no longer be used, e.g. after it was closed
+            if (pfds[0].revents & (POLLHUP | POLLNVAL))
+            {
+                spdlog::error("CAN interface {} was closed", m_interfaceName);
+                return false;
+            }
+
+            // Errors like a network interface that went down are reported without data. Reading
+            // the socket clears them, otherwise poll would return immediately from now on.
+            if (pfds[0].revents & (POLLIN | POLLERR))
+                return true;
+        }
+
+        return false;
+    }
+
+    void SocketCanChannel::cancelWait() noexcept
+    {
+        m_terminate = true;
+
+        const uint64_t wake = 1;
+        if (::write(m_wakeFd, &wake, sizeof(wake)) != sizeof(wake))
+            spdlog::error("Cannot wake up dispatch thread of CAN channel {}", m_interfaceName);
+    }
+
+    ZenError SocketCanChannel::poll() noexcept
+    {
+        for (;;)
+        {
+            struct can_frame frame;
+            const auto size = ::recv(m_fd, &frame, sizeof(frame), MSG_DONTWAIT);
+            if (size == -1)
+                return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? ZenError_None : ZenError_Io_ReadFailed;
+
+            if (size != sizeof(frame) || !isDataFrame(frame))
+                continue;
+
+            std::lock_guard<std::mutex> lock(m_subscribersMutex);
+            auto it = m_subscribers.find(frameId(frame));
+            if (it == m_subscribers.cend())
+                continue;
+
+            if (auto error = publishReceivedData(*it->second, gsl::make_span(reinterpret_cast<const std::byte*>(frame.data), static_cast<size_t>(frame.can_dlc))))
+                spdlog::error("Failed to process CAN frame of ID {}: {}", it->first, error);
+        }
+    }
+}
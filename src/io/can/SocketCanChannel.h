@@ -0,0 +1,108 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_CAN_SOCKETCANCHANNEL_H_
+#define ZEN_IO_CAN_SOCKETCANCHANNEL_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "io/can/ICanChannel.h"
+
+namespace zen
+{
+    /*
+    CAN channel on top of a Linux SocketCAN network interface (e.g. can0 or vcan0).
+
+    Frames are received on a raw CAN socket. The dispatch thread of the CanManager
+    blocks in waitForData until the socket becomes readable and then dispatches the
+    frames to the subscribed CanInterface right away. The kernel only delivers frames
+    with subscribed IDs to the socket (CAN_RAW_FILTER).
+
+    The bitrate of the bus is configured by the system, for example with
+
+    sudo ip link set can0 type can bitrate 125000
+    sudo ip link set can0 up
+    */
+    class SocketCanChannel : public ICanChannel
+    {
+    public:
+        /** Opens a raw CAN socket on the network interface */
+        static nonstd::expected<std::unique_ptr<SocketCanChannel>, ZenError> open(const std::string& interfaceName) noexcept;
+
+        ~SocketCanChannel();
+
+        /** Subscribe IO Interface to CAN interface  */
+        bool subscribe(CanInterface& i) noexcept override;
+
+        /** Unsubscribe IO Interface from CAN interface */
+        void unsubscribe(CanInterface& i) noexcept override;
+
+        /** List devices connected to the CAN interface */
+        ZenError listDevices(std::vector<ZenSensorDesc>& outDevices) noexcept override;
+
+        /** Dispatches all frames which are queued on the socket */
+        ZenError poll() noexcept override;
+
+        /** Blocks until the socket is readable. Returns false if the wait was cancelled. */
+        bool waitForData() noexcept override;
+
+        /** Wakes up waitForData and makes all further calls return immediately */
+        void cancelWait() noexcept override;
+
+        /** Returns the channel Id */
+        unsigned int channel() const noexcept override { return m_interfaceIndex; }
+
+        /** Returns the type of IO used by the CAN channel */
+        std::string_view type() const noexcept override;
+
+        /** Returns whether the CAN channel equals the IO type */
+        bool equals(std::string_view ioType) const noexcept override;
+
+        /** Returns whether the CAN channel uses the network interface */
+        bool equalsBus(std::string_view busName) const noexcept override { return m_interfaceName == busName; }
+
+        /** Returns the name of the network interface */
+        const std::string& interfaceName() const noexcept { return m_interfaceName; }
+
+    private:
+        SocketCanChannel(std::string interfaceName, unsigned int interfaceIndex, int fd, int wakeFd) noexcept;
+
+        /** Send data to CAN bus */
+        ZenError send(uint32_t id, gsl::span<const std::byte> data) noexcept override;
+
+        /** Returns the CAN bus' baudrate (bit/s) */
+        unsigned baudRate() const noexcept override { return m_baudRate; }
+
+        /** The bitrate is configured by the system and cannot be changed by OpenZen */
+        ZenError setBaudRate(unsigned int rate) noexcept override;
+
+        /** Returns the supported baudrates of the CAN bus (bit/s) */
+        nonstd::expected<std::vector<int32_t>, ZenError> supportedBaudRates() const noexcept override;
+
+        /** Restricts the socket to the IDs of the subscribers. Requires m_subscribersMutex. */
+        ZenError updateFilter() noexcept;
+
+        const std::string m_interfaceName;
+        const unsigned int m_interfaceIndex;
+        const int m_fd;
+        const int m_wakeFd;
+        std::atomic_uint m_baudRate;
+
+        std::mutex m_subscribersMutex;
+        std::unordered_map<uint32_t, CanInterface*> m_subscribers;
+
+        std::atomic_bool m_terminate;
+    };
+}
+
+#endif
@@ -10,7 +10,8 @@
 
 #include "io/interfaces/CanInterface.h"
 
-#include <cstring>
+#include <cstdlib>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -54,12 +55,19 @@ bool CanInterface::equals(const ZenSensorDesc& desc) const noexcept
     if (!m_channel.equals(desc.ioType))
         return false;
 
-    char* end = const_cast<char*>(std::strchr(desc.identifier, '\0'));
+    char* end = nullptr;
     const auto deviceId = std::strtoul(desc.identifier, &end, 10);
-    if (deviceId == std::numeric_limits<unsigned long>::max())
+    if (end == desc.identifier || deviceId == std::numeric_limits<unsigned long>::max())
         return false;
 
-    return m_id == deviceId;
+    if (m_id != deviceId)
+        return false;
+
+    // The same ID can be used on several buses, "<id>@<bus>" selects one of them
+    if (*end == '@')
+        return m_channel.equalsBus(end + 1);
+
+    return true;
 }
 
 ZenError CanInterface::send(gsl::span<const std::byte> data) noexcept
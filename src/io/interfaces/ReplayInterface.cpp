@@ -0,0 +1,155 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/interfaces/ReplayInterface.h"
+#include "io/systems/ReplaySystem.h"
+
+#include <spdlog/spdlog.h>
+
+namespace zen
+{
+    namespace
+    {
+        /** Time to wait for the host to send a recorded command, before the replay continues regardless */
+        constexpr auto COMMAND_TIMEOUT = std::chrono::seconds(5);
+
+        /** Frames sent by the host which are not yet matched against the recording */
+        constexpr size_t MAX_PENDING_FRAMES = 256;
+    }
+
+    ReplayInterface::ReplayInterface(IIoDataSubscriber& subscriber, std::string identifier, std::vector<IoCaptureRecord> records,
+        double speed, int32_t baudRate) noexcept
+        : IIoInterface(subscriber)
+        , m_identifier(std::move(identifier))
+        , m_records(std::move(records))
+        , m_speed(speed)
+        , m_baudRate(baudRate)
+        , m_terminate(false)
+        , m_finished(false)
+        , m_replayThread(&ReplayInterface::run, this)
+    {}
+
+    ReplayInterface::~ReplayInterface()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_terminate = true;
+        }
+        m_cv.notify_all();
+
+        if (m_replayThread.joinable())
+            m_replayThread.join();
+    }
+
+    ZenError ReplayInterface::send(gsl::span<const std::byte> data) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_sentFrames.size() == MAX_PENDING_FRAMES)
+                m_sentFrames.pop_front();
+
+            m_sentFrames.emplace_back(data.begin(), data.end());
+        }
+        m_cv.notify_all();
+
+        return ZenError_None;
+    }
+
+    ZenError ReplayInterface::setBaudRate(unsigned int rate) noexcept
+    {
+        m_baudRate = static_cast<int32_t>(rate);
+        return ZenError_None;
+    }
+
+    nonstd::expected<std::vector<int32_t>, ZenError> ReplayInterface::supportedBaudRates() const noexcept
+    {
+        return std::vector<int32_t>{ m_baudRate.load() };
+    }
+
+    std::string_view ReplayInterface::type() const noexcept
+    {
+        return ReplaySystem::KEY;
+    }
+
+    bool ReplayInterface::equals(const ZenSensorDesc& desc) const noexcept
+    {
+        if (std::string_view(ReplaySystem::KEY) != desc.ioType)
+            return false;
+
+        return m_identifier == desc.identifier;
+    }
+
+    void ReplayInterface::run() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        // Received chunks are scheduled relative to the last synchronisation point with the host
+        auto anchorTime = std::chrono::steady_clock::now();
+        uint64_t anchorTimestamp = m_records.empty() ? 0 : m_records.front().timestamp;
+
+        for (const auto& record : m_records)
+        {
+            if (m_terminate)
+                break;
+
+            if (record.direction == IoCaptureDirection::Sent)
+            {
+                if (!waitForSent(lock, record))
+                    break;
+
+                anchorTime = std::chrono::steady_clock::now();
+                anchorTimestamp = record.timestamp;
+                continue;
+            }
+
+            if (m_speed > 0.0 && record.timestamp > anchorTimestamp)
+            {
+                const std::chrono::duration<double, std::nano> offset((record.timestamp - anchorTimestamp) / m_speed);
+                const auto publishTime = anchorTime + std::chrono::duration_cast<std::chrono::nanoseconds>(offset);
+                if (m_cv.wait_until(lock, publishTime, [this]() { return m_terminate.load(); }))
+                    break;
+            }
+
+            lock.unlock();
+            if (auto error = publishReceivedData(record.data))
+                spdlog::error("Failed to publish replayed data: {}", error);
+            lock.lock();
+        }
+
+        m_finished = true;
+        spdlog::info("Replay of {} finished", m_identifier);
+    }
+
+    bool ReplayInterface::waitForSent(std::unique_lock<std::mutex>& lock, const IoCaptureRecord& record) noexcept
+    {
+        const auto deadline = std::chrono::steady_clock::now() + COMMAND_TIMEOUT;
+        while (!m_terminate)
+        {
+            while (!m_sentFrames.empty())
+            {
+                const auto frame = std::move(m_sentFrames.front());
+                m_sentFrames.pop_front();
+
+                if (frame == record.data)
+                    return true;
+
+                SPDLOG_DEBUG("Replay ignores a frame which does not match the recording");
+            }
+
+            if (!m_cv.wait_until(lock, deadline, [this]() { return m_terminate || !m_sentFrames.empty(); }))
+            {
+                spdlog::warn("Host did not send the recorded command within {} s, continuing replay", COMMAND_TIMEOUT.count());
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,83 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_INTERFACES_REPLAYINTERFACE_H_
+#define ZEN_IO_INTERFACES_REPLAYINTERFACE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io/IIoInterface.h"
+#include "io/IoCapture.h"
+
+namespace zen
+{
+    /** Plays back a capture file as if the recorded sensor was connected.
+     *
+     *  Received chunks are published with their recorded spacing divided by the replay speed.
+     *  When the replay reaches a chunk which was sent by the host, it waits until the host sends
+     *  the same frame again, so command replies are answered from the recording.
+     */
+    class ReplayInterface : public IIoInterface
+    {
+    public:
+        /** A replay speed of zero publishes the recording as fast as possible */
+        ReplayInterface(IIoDataSubscriber& subscriber, std::string identifier, std::vector<IoCaptureRecord> records,
+            double speed, int32_t baudRate) noexcept;
+        ~ReplayInterface();
+
+        /** Send data to IO interface */
+        ZenError send(gsl::span<const std::byte> data) noexcept override;
+
+        /** Returns the IO interface's baudrate (bit/s) */
+        nonstd::expected<int32_t, ZenError> baudRate() const noexcept override { return m_baudRate.load(); }
+
+        /** Set Baudrate of IO interface (bit/s) */
+        ZenError setBaudRate(unsigned int rate) noexcept override;
+
+        /** Returns the supported baudrates of the IO interface (bit/s) */
+        nonstd::expected<std::vector<int32_t>, ZenError> supportedBaudRates() const noexcept override;
+
+        /** Returns the type of IO interface */
+        std::string_view type() const noexcept override;
+
+        /** Returns whether the IO interface equals the sensor description */
+        bool equals(const ZenSensorDesc& desc) const noexcept override;
+
+        /** Returns whether all records of the capture have been played back */
+        bool finished() const noexcept { return m_finished; }
+
+    private:
+        void run() noexcept;
+
+        /** Waits until the host sends the recorded frame. Returns false on termination. */
+        bool waitForSent(std::unique_lock<std::mutex>& lock, const IoCaptureRecord& record) noexcept;
+
+        const std::string m_identifier;
+        const std::vector<IoCaptureRecord> m_records;
+        const double m_speed;
+        std::atomic_int32_t m_baudRate;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::vector<std::byte>> m_sentFrames;
+
+        std::atomic_bool m_terminate;
+        std::atomic_bool m_finished;
+        std::thread m_replayThread;
+    };
+}
+
+#endif
@@ -43,19 +43,30 @@ namespace zen
         m_context = std::make_unique< zmq::context_t>();
         m_subscriber = std::make_unique<zmq::socket_t>(*m_context.get(), ZMQ_SUB);
 
+        // an optional selector after '#' restricts the subscription to one sensor or message type
+        const auto selectorStart = endpoint.find('#');
+        const auto address = endpoint.substr(0, selectorStart);
+        const auto subscriptions = zen::Streaming::streamingSubscriptions(selectorStart == std::string::npos
+            ? std::string_view() : std::string_view(endpoint).substr(selectorStart + 1));
+        if (subscriptions.empty()) {
+            spdlog::error("Invalid topic selector in endpoint {0}", endpoint);
+            return false;
+        }
+
         m_endpoint = endpoint;
         try {
             // next line may throw zmq::error_t if the endpoint string is not solid
-            m_subscriber->connect(endpoint);
+            m_subscriber->connect(address);
         }
         catch (zmq::error_t & err) {
             spdlog::error("Cannot connect to endpoint {0} due to error: {1}",
-                endpoint, err.what());
+                address, err.what());
             return false;
         }
 
-        // subscribe to all messages
-        m_subscriber->setsockopt(ZMQ_SUBSCRIBE, nullptr, 0);
+        // the publisher only sends messages whose topic starts with one of the subscriptions
+        for (const auto& subscription : subscriptions)
+            m_subscriber->setsockopt(ZMQ_SUBSCRIBE, subscription.data(), subscription.size());
 
         spdlog::info("Created ZMQ interface for endpoint {} done", endpoint);
 
@@ -78,34 +89,61 @@ namespace zen
         return std::string(desc.name) == m_endpoint;
     }
 
+    nonstd::expected<ZenStreamingStatistics, ZenError> ZeroMQInterface::streamingStatistics() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsMutex);
+        return m_statistics.summary();
+    }
+
     int ZeroMQInterface::run()
     {
       spdlog::info("Running ZMQ interface thread");
+      // received messages are decoded in place, so one message object is reused for all of them
+      zmq::message_t zmqMessage;
+      // topic of the next message, which identifies its stream for the sequence numbers
+      std::string topic;
       while (!m_terminate)
         {
-          zmq::message_t zmqMessage;
-
           try
           {
               // todo: package event in some data struct and use proper serializer
               const auto recv_result = this->m_subscriber->recv(zmqMessage, zmq::recv_flags::none);
+              const uint64_t receiveTimeNs = zen::Streaming::streamingClockNs();
+              // a frame followed by more frames is the topic of the message in the last frame
+              if (zmqMessage.more()) {
+                  topic.assign(static_cast<const char*>(zmqMessage.data()), zmqMessage.size());
+                  continue;
+              }
+
               if (recv_result.has_value() && (*recv_result > 0)) {
-                  auto unpackedMessage = zen::Streaming::fromZmqMessage(zmqMessage);
-                  if (unpackedMessage.has_value()) {
+                  // batched messages are unpacked into one event per contained message
+                  size_t nEvents = 0;
+                  const bool unpacked = zen::Streaming::unpackZmqMessage(zmqMessage,
+                      [this, &nEvents](const zen::Streaming::StreamingMessage& unpackedMessage) {
+                      ++nEvents;
                       if (!m_terminate) {
-                          auto zenEvent = zen::Streaming::streamingMessageToZenEvent(*unpackedMessage);
+                          auto zenEvent = zen::Streaming::streamingMessageToZenEvent(unpackedMessage);
                           if (zenEvent) {
                               publishReceivedData(*zenEvent);
                           } else {
                               spdlog::error("Cannot convert streaming message of type {0} to ZenEvent",
-                                  unpackedMessage->type);
+                                  unpackedMessage.type);
                           }
                       }
-                  }
-                  else {
+                  });
+                  if (!unpacked) {
                       spdlog::error("Cannot unpack ZeroMQ message of size {0}", zmqMessage.size());
                   }
+
+                  const auto sequence = zen::Streaming::streamingSequence(zmqMessage);
+                  std::lock_guard<std::mutex> lock(m_statisticsMutex);
+                  if (sequence) {
+                      m_statistics.addMessage(topic, sequence->sequence, sequence->sendTimeNs, receiveTimeNs, nEvents);
+                  } else {
+                      m_statistics.addUnsequencedMessage(nEvents);
+                  }
               }
+              topic.clear();
           }
           catch (const zmq::error_t& ex)
           {
@@ -13,8 +13,10 @@
 
 #include <array>
 #include <atomic>
+#include <mutex>
 #include <thread>
 
+#include "communication/StreamingStatistics.h"
 #include "io/IIoEventInterface.h"
 
 #include <zmq.hpp>
@@ -35,6 +37,9 @@ namespace zen
         /** Returns whether the IO interface equals the sensor description */
         bool equals(const ZenSensorDesc& desc) const noexcept override;
 
+        /** Returns the losses, reordering and latency of the received messages */
+        nonstd::expected<ZenStreamingStatistics, ZenError> streamingStatistics() const noexcept override;
+
     private:
         int run();
 
@@ -45,6 +50,9 @@ namespace zen
         std::thread m_pollingThread;
 
         std::string m_endpoint;
+
+        mutable std::mutex m_statisticsMutex;
+        StreamingStatistics m_statistics;
     };
 }
 
@@ -0,0 +1,93 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/interfaces/linux/SharedMemoryInterface.h"
+
+#include <chrono>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "io/systems/linux/SharedMemorySystem.h"
+#include "streaming/StreamingMessage.h"
+
+namespace zen
+{
+    namespace
+    {
+        /** Interval in which the polling thread checks whether it is terminated */
+        constexpr auto POLL_TIMEOUT = std::chrono::milliseconds(100);
+    }
+
+    SharedMemoryInterface::SharedMemoryInterface(IIoEventSubscriber& subscriber, std::unique_ptr<SharedMemoryRing> ring)
+        : IIoEventInterface(subscriber)
+        , m_ring(std::move(ring))
+        , m_terminate(false)
+    {
+        m_pollingThread = std::thread(&SharedMemoryInterface::run, this);
+    }
+
+    SharedMemoryInterface::~SharedMemoryInterface()
+    {
+        m_terminate = true;
+        if (m_pollingThread.joinable())
+            m_pollingThread.join();
+    }
+
+    std::string_view SharedMemoryInterface::type() const noexcept
+    {
+        return SharedMemorySystem::KEY;
+    }
+
+    bool SharedMemoryInterface::equals(const ZenSensorDesc& desc) const noexcept
+    {
+        if (std::string_view(SharedMemorySystem::KEY) != desc.ioType)
+            return false;
+
+        return m_ring->name() == desc.identifier;
+    }
+
+    void SharedMemoryInterface::run() noexcept
+    {
+        std::vector<std::byte> entry(m_ring->slotSize());
+        uint64_t lostEntries = 0;
+
+        while (!m_terminate)
+        {
+            const size_t size = m_ring->read(entry, POLL_TIMEOUT);
+            if (size == 0)
+            {
+                if (m_ring->closed())
+                {
+                    spdlog::info("Shared memory ring {0} was closed by its writer", m_ring->name());
+                    break;
+                }
+                continue;
+            }
+
+            if (m_ring->lostEntries() != lostEntries)
+            {
+                spdlog::warn("Skipped {0} events of shared memory ring {1}, which were overwritten before they were read",
+                    m_ring->lostEntries() - lostEntries, m_ring->name());
+                lostEntries = m_ring->lostEntries();
+            }
+
+            Streaming::StreamingMessage message;
+            if (Streaming::readRecord(entry.data(), size, message) == 0)
+            {
+                spdlog::error("Cannot decode entry of shared memory ring {0} of size {1}", m_ring->name(), size);
+                continue;
+            }
+
+            if (auto zenEvent = Streaming::streamingMessageToZenEvent(message))
+                publishReceivedData(*zenEvent);
+        }
+    }
+}
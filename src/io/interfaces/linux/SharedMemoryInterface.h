@@ -0,0 +1,46 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_INTERFACES_LINUX_SHAREDMEMORYINTERFACE_H_
+#define ZEN_IO_INTERFACES_LINUX_SHAREDMEMORYINTERFACE_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "io/IIoEventInterface.h"
+#include "utility/linux/SharedMemoryRing.h"
+
+namespace zen
+{
+    /** Delivers the events which another process on this host writes to a shared memory ring */
+    class SharedMemoryInterface : public IIoEventInterface
+    {
+    public:
+        SharedMemoryInterface(IIoEventSubscriber& subscriber, std::unique_ptr<SharedMemoryRing> ring);
+        ~SharedMemoryInterface();
+
+        /** Returns the type of IO interface */
+        std::string_view type() const noexcept override;
+
+        /** Returns whether the IO interface equals the sensor description */
+        bool equals(const ZenSensorDesc& desc) const noexcept override;
+
+    private:
+        void run() noexcept;
+
+        std::unique_ptr<SharedMemoryRing> m_ring;
+
+        std::atomic_bool m_terminate;
+        std::thread m_pollingThread;
+    };
+}
+
+#endif
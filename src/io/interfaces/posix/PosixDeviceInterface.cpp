@@ -14,6 +14,7 @@
 
 #include <cstring>
 
+#include <poll.h>
 #include <sys/errno.h>
 #include <sys/ioctl.h>
 #ifdef __APPLE__
@@ -69,7 +70,29 @@ namespace zen
         return true;
     }
 
-    int PosixDeviceInterfaceImpl::run()
+    void PosixDeviceInterfaceImpl::run() noexcept
+    {
+        if (auto error = receive())
+        {
+            // An error during shutdown is expected, as the file descriptors are closed
+            if (!m_terminate)
+            {
+                spdlog::error("Reading from {} failed: {}", m_identifier, error);
+                publishError(error);
+            }
+        }
+    }
+
+    bool PosixDeviceInterfaceImpl::hungUp() const noexcept
+    {
+        struct pollfd pfd = { m_fdRead, POLLIN, 0 };
+        if (::poll(&pfd, 1, 0) == -1)
+            return false;
+
+        return (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0;
+    }
+
+    ZenError PosixDeviceInterfaceImpl::receive() noexcept
     {
         std::array<std::byte, 256> buffer1, buffer2;
 
@@ -109,6 +132,11 @@ namespace zen
             if (nBytesReceived > 0) {
                 if (auto error = publishReceivedData(gsl::make_span((std::byte *)lastCB->aio_buf, nBytesReceived)))
                     return error;
+            } else if (hungUp()) {
+                // A removed device does not fail reads, but keeps returning end-of-file
+                ::aio_cancel(m_fdRead, currentCB);
+                ::aio_suspend(&currentCB, 1, nullptr);
+                return ZenError_Io_ReadFailed;
             }
         }
 
@@ -48,7 +48,12 @@ namespace zen
         bool equals(const ZenSensorDesc& desc) const noexcept override;
 
     private:
-        int run();
+        void run() noexcept;
+
+        ZenError receive() noexcept;
+
+        /** Returns whether the device has been removed, which ends reading with zero bytes */
+        bool hungUp() const noexcept;
 
         std::string m_identifier;
 
@@ -0,0 +1,74 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/systems/ReplaySystem.h"
+#include "io/interfaces/ReplayInterface.h"
+
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+namespace zen
+{
+    namespace
+    {
+        /** Returns the replay speed encoded in the identifier, zero means as fast as possible */
+        std::optional<double> parseSpeed(std::string_view speed)
+        {
+            if (speed == "max")
+                return 0.0;
+
+            const std::string speedString(speed);
+            char* end = nullptr;
+            const double value = std::strtod(speedString.c_str(), &end);
+            if (end == speedString.c_str() || *end != '\0' || value <= 0.0)
+                return std::nullopt;
+
+            return value;
+        }
+    }
+
+    ZenError ReplaySystem::listDevices(std::vector<ZenSensorDesc>&)
+    {
+        return ZenError_None;
+    }
+
+    nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> ReplaySystem::obtain(const ZenSensorDesc& desc, IIoDataSubscriber& subscriber) noexcept
+    {
+        const std::string_view identifier(desc.identifier);
+        std::string_view path = identifier;
+        double speed = 1.0;
+
+        const auto separator = identifier.rfind('@');
+        if (separator != std::string_view::npos)
+        {
+            if (auto parsedSpeed = parseSpeed(identifier.substr(separator + 1)))
+            {
+                path = identifier.substr(0, separator);
+                speed = *parsedSpeed;
+            }
+            else
+            {
+                spdlog::error("Invalid replay speed in {}", identifier);
+                return nonstd::make_unexpected(ZenSensorInitError_InvalidAddress);
+            }
+        }
+
+        auto records = IoCapture::load(std::string(path));
+        if (!records)
+            return nonstd::make_unexpected(ZenSensorInitError_UnknownIdentifier);
+
+        spdlog::info("Replaying {} records from {} at speed {}", records->size(), path, speed);
+        return std::make_unique<ReplayInterface>(subscriber, std::string(identifier), std::move(*records),
+            speed, static_cast<int32_t>(desc.baudRate));
+    }
+}
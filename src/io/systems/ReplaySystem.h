@@ -0,0 +1,42 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_SYSTEMS_REPLAYSYSTEM_H_
+#define ZEN_IO_SYSTEMS_REPLAYSYSTEM_H_
+
+#include "io/IIoSystem.h"
+
+namespace zen
+{
+    /** Replays capture files recorded with OPENZEN_IO_CAPTURE_DIR as low-level sensors.
+     *
+     *  The sensor identifier is the path of the capture file, optionally followed by the replay
+     *  speed: "capture.zcap" replays in real-time, "capture.zcap@4" four times faster and
+     *  "capture.zcap@max" as fast as possible. As the identifier is limited to 63 characters,
+     *  relative paths are usually needed.
+     */
+    class ReplaySystem : public IIoSystem
+    {
+    public:
+        constexpr static const char KEY[] = "Replay";
+
+        bool available() override { return true; }
+
+        // this system won't list any devices to connect to, ZenObtainSensorByName can
+        // be used to replay a capture file
+        ZenError listDevices(std::vector<ZenSensorDesc>& outDevices) override;
+
+        nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> obtain(const ZenSensorDesc& desc, IIoDataSubscriber& subscriber) noexcept override;
+
+        uint32_t getDefaultBaudrate() override { return 115200; }
+    };
+}
+
+#endif
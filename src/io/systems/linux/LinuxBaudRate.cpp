@@ -0,0 +1,50 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/systems/linux/LinuxBaudRate.h"
+
+// Do not include <termios.h> in this file, it conflicts with the kernel header
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+namespace zen
+{
+    namespace LinuxBaudRate
+    {
+        ZenError setForFD(int fd, uint32_t baudRate) noexcept
+        {
+            struct termios2 config;
+            if (-1 == ::ioctl(fd, TCGETS2, &config))
+                return ZenError_Io_GetFailed;
+
+            // BOTHER tells the kernel to use the speed fields instead of a Bxxx constant
+            config.c_cflag &= ~CBAUD;
+            config.c_cflag |= BOTHER;
+            config.c_cflag &= ~(CBAUD << IBSHIFT);
+            config.c_cflag |= BOTHER << IBSHIFT;
+            config.c_ispeed = baudRate;
+            config.c_ospeed = baudRate;
+
+            if (-1 == ::ioctl(fd, TCSETS2, &config))
+                return ZenError_Io_SetFailed;
+
+            return ZenError_None;
+        }
+
+        nonstd::expected<uint32_t, ZenError> getForFD(int fd) noexcept
+        {
+            struct termios2 config;
+            if (-1 == ::ioctl(fd, TCGETS2, &config))
+                return nonstd::make_unexpected(ZenError_Io_GetFailed);
+
+            return config.c_ospeed;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_SYSTEMS_LINUX_LINUXBAUDRATE_H_
+#define ZEN_IO_SYSTEMS_LINUX_LINUXBAUDRATE_H_
+
+#include <cstdint>
+
+#include <nonstd/expected.hpp>
+
+#include "ZenTypes.h"
+
+namespace zen
+{
+    /** Arbitrary baud rates via the termios2 interface of the Linux kernel.
+     *
+     *  These live in their own translation unit because the kernel's termios
+     *  definitions clash with the ones of the C library.
+     */
+    namespace LinuxBaudRate
+    {
+        /** Sets input and output speed of the file to exactly baudRate (bit/s) */
+        ZenError setForFD(int fd, uint32_t baudRate) noexcept;
+
+        /** Reads back the output speed of the file (bit/s) as applied by the driver */
+        nonstd::expected<uint32_t, ZenError> getForFD(int fd) noexcept;
+    }
+}
+
+#endif
@@ -0,0 +1,298 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/systems/linux/LinuxDeviceMonitor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "io/systems/linux/LinuxDeviceQuery.h"
+
+namespace zen
+{
+    namespace
+    {
+        /** Multicast group of the kernel's uevents (as opposed to the ones re-broadcast by udev) */
+        constexpr unsigned int KERNEL_UEVENT_GROUP = 1;
+
+        constexpr size_t UEVENT_BUFFER_SIZE = 8192;
+
+        int openUeventSocket() noexcept
+        {
+            const int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+            if (fd == -1)
+                return -1;
+
+            struct sockaddr_nl address;
+            std::memset(&address, 0, sizeof(address));
+            address.nl_family = AF_NETLINK;
+            address.nl_groups = KERNEL_UEVENT_GROUP;
+            if (-1 == ::bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)))
+            {
+                ::close(fd);
+                return -1;
+            }
+
+            return fd;
+        }
+
+        LinuxDeviceTable::Devices scanDevices() noexcept
+        {
+            try
+            {
+                return LinuxDeviceQuery::getSiLabsDevices();
+            }
+            catch (const std::exception& e)
+            {
+                spdlog::error("Cannot list USB devices: {}", e.what());
+                return {};
+            }
+        }
+    }
+
+    LinuxDeviceTable::LinuxDeviceTable(Scanner scanner, ChangeCallback callback) noexcept
+        : m_scanner(std::move(scanner))
+        , m_callback(std::move(callback))
+        , m_monitoring(false)
+    {}
+
+    LinuxDeviceTable::Devices LinuxDeviceTable::devices() noexcept
+    {
+        if (!monitoring())
+            rescan();
+
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        return m_devices;
+    }
+
+    std::vector<std::string> LinuxDeviceTable::devicesForSerial(const std::string& serialNumber) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            auto it = m_devices.find(serialNumber);
+            if (monitoring() && it != m_devices.cend())
+                return it->second;
+        }
+
+        // The device might have been attached before its change was processed
+        rescan();
+
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        auto it = m_devices.find(serialNumber);
+        return it != m_devices.cend() ? it->second : std::vector<std::string>();
+    }
+
+    void LinuxDeviceTable::rescan() noexcept
+    {
+        std::lock_guard<std::mutex> scanLock(m_scanMutex);
+
+        auto devices = m_scanner();
+
+        Devices previous;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            previous = std::exchange(m_devices, devices);
+        }
+
+        // Without monitoring, differences are only noticed when listing, which does not make them events
+        if (!m_callback || !monitoring())
+            return;
+
+        for (const auto& change : changes(previous, devices))
+            m_callback(change.serialNumber, change.ttyDevice, change.attached);
+    }
+
+    void LinuxDeviceTable::startMonitoring() noexcept
+    {
+        std::lock_guard<std::mutex> scanLock(m_scanMutex);
+
+        auto devices = m_scanner();
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            m_devices = std::move(devices);
+        }
+        m_monitoring = true;
+    }
+
+    std::vector<LinuxDeviceTable::Change> LinuxDeviceTable::changes(const Devices& previous, const Devices& current) noexcept
+    {
+        const auto contains = [](const Devices& devices, const std::string& serialNumber, const std::string& ttyDevice) {
+            auto it = devices.find(serialNumber);
+            if (it == devices.cend())
+                return false;
+
+            return std::find(it->second.cbegin(), it->second.cend(), ttyDevice) != it->second.cend();
+        };
+
+        std::vector<Change> result;
+        for (const auto& [serialNumber, ttyDevices] : previous)
+            for (const auto& ttyDevice : ttyDevices)
+                if (!contains(current, serialNumber, ttyDevice))
+                    result.push_back({ serialNumber, ttyDevice, false });
+
+        for (const auto& [serialNumber, ttyDevices] : current)
+            for (const auto& ttyDevice : ttyDevices)
+                if (!contains(previous, serialNumber, ttyDevice))
+                    result.push_back({ serialNumber, ttyDevice, true });
+
+        return result;
+    }
+
+    void UeventSettleDeadline::changed(Clock::time_point now) noexcept
+    {
+        if (!m_deadline)
+            m_deadline = now + SETTLE_TIME;
+    }
+
+    int UeventSettleDeadline::pollTimeout(Clock::time_point now) const noexcept
+    {
+        if (!m_deadline)
+            return -1;
+
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*m_deadline - now);
+        return static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+    }
+
+    bool UeventSettleDeadline::expired(Clock::time_point now) noexcept
+    {
+        if (!m_deadline || now < *m_deadline)
+            return false;
+
+        m_deadline.reset();
+        return true;
+    }
+
+    LinuxDeviceMonitor::LinuxDeviceMonitor(ChangeCallback callback) noexcept
+        : m_table(scanDevices, std::move(callback))
+        , m_fd(openUeventSocket())
+        , m_wakeFd(-1)
+        , m_terminate(false)
+    {
+        if (m_fd != -1)
+        {
+            m_wakeFd = ::eventfd(0, EFD_CLOEXEC);
+            if (m_wakeFd == -1)
+            {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+        }
+
+        if (m_fd == -1)
+        {
+            spdlog::warn("Cannot monitor USB devices, they will be listed on every request");
+            return;
+        }
+
+        // Subscribe before the initial scan, so no device is missed in between
+        m_table.startMonitoring();
+        m_monitorThread = std::thread(&LinuxDeviceMonitor::run, this);
+    }
+
+    LinuxDeviceMonitor::~LinuxDeviceMonitor()
+    {
+        m_terminate = true;
+
+        if (m_monitorThread.joinable())
+        {
+            const uint64_t wake = 1;
+            if (::write(m_wakeFd, &wake, sizeof(wake)) != sizeof(wake))
+                spdlog::error("Cannot wake up USB device monitor");
+
+            m_monitorThread.join();
+        }
+
+        if (m_wakeFd != -1)
+            ::close(m_wakeFd);
+        if (m_fd != -1)
+            ::close(m_fd);
+    }
+
+    bool LinuxDeviceMonitor::isRelevantUevent(const char* message, size_t size) noexcept
+    {
+        // The strings are preceded by "action@devpath", which does not contain a '='
+        bool relevantAction = false;
+        bool relevantSubsystem = false;
+        for (size_t offset = 0; offset < size;)
+        {
+            const std::string_view entry(message + offset, ::strnlen(message + offset, size - offset));
+            offset += entry.size() + 1;
+
+            if (entry == "ACTION=add" || entry == "ACTION=remove")
+                relevantAction = true;
+            else if (entry == "SUBSYSTEM=tty" || entry == "SUBSYSTEM=usb" || entry == "SUBSYSTEM=usb-serial")
+                relevantSubsystem = true;
+        }
+
+        return relevantAction && relevantSubsystem;
+    }
+
+    void LinuxDeviceMonitor::run() noexcept
+    {
+        struct pollfd pfds[2] = {
+            { m_fd, POLLIN, 0 },
+            { m_wakeFd, POLLIN, 0 }
+        };
+
+        std::vector<char> buffer(UEVENT_BUFFER_SIZE);
+        UeventSettleDeadline scanDeadline;
+        while (!m_terminate)
+        {
+            const int result = ::poll(pfds, 2, scanDeadline.pollTimeout(std::chrono::steady_clock::now()));
+            if (result == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                spdlog::error("Polling USB device events failed, devices will be listed on every request");
+                m_table.stopMonitoring();
+                return;
+            }
+
+            if (scanDeadline.expired(std::chrono::steady_clock::now()))
+                m_table.rescan();
+
+            if (result == 0)
+                continue;
+
+            if (pfds[1].revents & POLLIN)
+                return;
+
+            if (pfds[0].revents & (POLLHUP | POLLNVAL))
+            {
+                spdlog::error("USB device events can no longer be received, devices will be listed on every request");
+                m_table.stopMonitoring();
+                return;
+            }
+
+            // Lost events are reported as an error without data, which receiving clears
+            if (pfds[0].revents & (POLLIN | POLLERR))
+            {
+                const auto size = ::recv(m_fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+                const bool changed = (size > 0 && isRelevantUevent(buffer.data(), static_cast<size_t>(size))) ||
+                    (size == -1 && errno == ENOBUFS); // Events were lost, the table needs to be refreshed
+                if (changed)
+                    scanDeadline.changed(std::chrono::steady_clock::now());
+            }
+        }
+    }
+}
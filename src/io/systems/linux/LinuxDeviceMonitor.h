@@ -0,0 +1,150 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_SYSTEMS_LINUX_LINUXDEVICEMONITOR_H_
+#define ZEN_IO_SYSTEMS_LINUX_LINUXDEVICEMONITOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace zen
+{
+    /**
+    Table of the connected SiLabs USB-UART devices, which reports the differences whenever it is
+    scanned again. While the table is not monitored, every query scans again instead.
+    */
+    class LinuxDeviceTable
+    {
+    public:
+        /** Serial number of the SiLabs chip mapped to its tty device files */
+        using Devices = std::map<std::string, std::vector<std::string>>;
+
+        /** Called for every tty device which has been attached (true) or detached (false) */
+        using ChangeCallback = std::function<void(const std::string& serialNumber, const std::string& ttyDevice, bool attached)>;
+
+        using Scanner = std::function<Devices()>;
+
+        struct Change
+        {
+            std::string serialNumber;
+            std::string ttyDevice;
+            bool attached;
+        };
+
+        LinuxDeviceTable(Scanner scanner, ChangeCallback callback) noexcept;
+
+        /** Returns all known devices */
+        Devices devices() noexcept;
+
+        /** Returns the tty device files of a serial number. Scans again, if the serial number is not known. */
+        std::vector<std::string> devicesForSerial(const std::string& serialNumber) noexcept;
+
+        /** Scans the devices, updates the table and reports the differences while it is monitored */
+        void rescan() noexcept;
+
+        /** Returns whether rescan is called on every change */
+        bool monitoring() const noexcept { return m_monitoring; }
+
+        /** Scans the devices once without reporting them, after which rescan is called on every change */
+        void startMonitoring() noexcept;
+
+        /** Falls back to scanning on every query, e.g. once changes can no longer be received */
+        void stopMonitoring() noexcept { m_monitoring = false; }
+
+        /** Returns the detached devices followed by the attached ones */
+        static std::vector<Change> changes(const Devices& previous, const Devices& current) noexcept;
+
+    private:
+        const Scanner m_scanner;
+        const ChangeCallback m_callback;
+
+        /** Serialises rescans, so changes are reported in order */
+        std::mutex m_scanMutex;
+
+        std::mutex m_devicesMutex;
+        Devices m_devices;
+
+        std::atomic_bool m_monitoring;
+    };
+
+    /**
+    A device being plugged in emits a burst of uevents, so devices are only scanned once the burst settled.
+    The first relevant uevent sets the deadline. Later uevents do not postpone it, otherwise steady uevent
+    traffic could delay the scan indefinitely.
+    */
+    class UeventSettleDeadline
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr auto SETTLE_TIME = std::chrono::milliseconds(100);
+
+        /** Starts the deadline, unless it is already running */
+        void changed(Clock::time_point now) noexcept;
+
+        /** Returns how many milliseconds to poll for, or -1 to poll until the next uevent */
+        int pollTimeout(Clock::time_point now) const noexcept;
+
+        /** Returns whether the deadline passed, in which case it is cleared */
+        bool expired(Clock::time_point now) noexcept;
+
+    private:
+        std::optional<Clock::time_point> m_deadline;
+    };
+
+    /**
+    Keeps a table of the connected SiLabs USB-UART devices up to date.
+
+    The sysfs tree is only scanned on start-up and when the kernel reports that a
+    USB or tty device was added or removed (netlink uevent socket). Listing and
+    obtaining sensors is answered from the cached table. If the uevent socket is
+    not available, e.g. in restricted containers, every query scans sysfs again.
+    */
+    class LinuxDeviceMonitor
+    {
+    public:
+        using Devices = LinuxDeviceTable::Devices;
+        using ChangeCallback = LinuxDeviceTable::ChangeCallback;
+
+        LinuxDeviceMonitor(ChangeCallback callback) noexcept;
+        ~LinuxDeviceMonitor();
+
+        /** Returns all known devices */
+        Devices devices() noexcept { return m_table.devices(); }
+
+        /** Returns the tty device files of a serial number. Scans sysfs again, if the serial number is not known. */
+        std::vector<std::string> devicesForSerial(const std::string& serialNumber) noexcept { return m_table.devicesForSerial(serialNumber); }
+
+        /** Returns whether changes are reported by the kernel. Stops once the uevent socket failed. */
+        bool monitoring() const noexcept { return m_table.monitoring(); }
+
+        /** Returns whether the uevent, which consists of null-terminated "KEY=value" strings, adds or removes a USB or tty device */
+        static bool isRelevantUevent(const char* message, size_t size) noexcept;
+
+    private:
+        void run() noexcept;
+
+        LinuxDeviceTable m_table;
+
+        int m_fd;
+        int m_wakeFd;
+        std::atomic_bool m_terminate;
+        std::thread m_monitorThread;
+    };
+}
+
+#endif
@@ -9,13 +9,14 @@
 //===========================================================================//
 
 
-#include "io/systems/linux/LinuxDeviceQuery.h"
+#include "io/systems/linux/LinuxBaudRate.h"
 #include "io/systems/linux/LinuxDeviceSystem.h"
 
 #include "io/interfaces/posix/PosixDeviceInterface.h"
 
 #include <spdlog/spdlog.h>
 
+#include <cmath>
 #include <cstring>
 
 #include <fcntl.h>
@@ -26,6 +27,9 @@ namespace zen
 {
     namespace
     {
+        /** Relative deviation from the requested baudrate which still allows reliable communication */
+        constexpr double MAX_BAUDRATE_DEVIATION = 0.02;
+
         ZenSensorInitError setupFD(int fd)
         {
             struct termios config;
@@ -52,39 +56,66 @@ namespace zen
 
             return ZenSensorInitError_None;
         }
+
+        ZenSensorDesc makeSensorDesc(const std::string& siLabsSerialNumber, const std::string& ttyDevice, uint32_t baudRate) noexcept
+        {
+            ZenSensorDesc desc;
+            std::memcpy(desc.name, siLabsSerialNumber.c_str(), siLabsSerialNumber.size());
+            desc.name[siLabsSerialNumber.size()] = '\0';
+
+            std::memcpy(desc.serialNumber, siLabsSerialNumber.c_str(), siLabsSerialNumber.size());
+            desc.serialNumber[siLabsSerialNumber.size()] = '\0';
+
+            std::memcpy(desc.ioType, LinuxDeviceSystem::KEY, sizeof(LinuxDeviceSystem::KEY));
+
+            // output the device path (like "/dev/ttyUSB0") just for additional information
+            std::memcpy(desc.identifier, ttyDevice.c_str(), ttyDevice.size());
+            desc.identifier[ttyDevice.size()] = '\0';
+
+            desc.baudRate = baudRate;
+            return desc;
+        }
     }
 
+    LinuxDeviceSystem::LinuxDeviceSystem() noexcept
+        : m_subscriber(nullptr)
+        , m_monitor([this](const std::string& serialNumber, const std::string& ttyDevice, bool attached) {
+            deviceChanged(serialNumber, ttyDevice, attached);
+        })
+    {}
+
     ZenError LinuxDeviceSystem::listDevices(std::vector<ZenSensorDesc>& outDevices)
     {
-        // LPMS sensors use SiLabs UART interface chips, this call will list them
+        // LPMS sensors use SiLabs UART interface chips, the monitor lists them
         // with all their serial names coming directly from the USB SiLabs driver
-        const auto siLabsDevices = LinuxDeviceQuery::getSiLabsDevices();
+        const auto siLabsDevices = m_monitor.devices();
 
         for (const auto& siLabsSerialDevs : siLabsDevices ) {
             // one serial name can be on multiple ports
-            for (const auto& siLabsDevs: siLabsSerialDevs.second) {
-                ZenSensorDesc desc;
-                auto const siLabsSerialNumber = siLabsSerialDevs.first;
-
-                std::memcpy(desc.name, siLabsSerialNumber.c_str(), siLabsSerialNumber.size());
-                desc.name[siLabsSerialNumber.size()] = '\0';
-
-                std::memcpy(desc.serialNumber, siLabsSerialNumber.c_str(), siLabsSerialNumber.size());
-                desc.serialNumber[siLabsSerialNumber.size()] = '\0';
-
-                std::memcpy(desc.ioType, LinuxDeviceSystem::KEY, sizeof(LinuxDeviceSystem::KEY));
+            for (const auto& siLabsDevs: siLabsSerialDevs.second)
+                outDevices.emplace_back(makeSensorDesc(siLabsSerialDevs.first, siLabsDevs, getDefaultBaudrate()));
+        }
 
-                // output the device path (like "/dev/ttyUSB0") just for additional information
-                std::memcpy(desc.identifier, siLabsDevs.c_str(), siLabsDevs.size());
-                desc.identifier[siLabsDevs.size()] = '\0';
+        return ZenError_None;
+    }
 
-                desc.baudRate = getDefaultBaudrate();
+    void LinuxDeviceSystem::setDeviceSubscriber(IIoDeviceSubscriber* subscriber) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_subscriberMutex);
+        m_subscriber = subscriber;
+    }
 
-                outDevices.emplace_back(desc);
-            }
-        }
+    void LinuxDeviceSystem::deviceChanged(const std::string& serialNumber, const std::string& ttyDevice, bool attached) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_subscriberMutex);
+        if (m_subscriber == nullptr)
+            return;
 
-        return ZenError_None;
+        const auto desc = makeSensorDesc(serialNumber, ttyDevice, getDefaultBaudrate());
+        if (attached)
+            m_subscriber->deviceAttached(desc);
+        else
+            m_subscriber->deviceDetached(desc);
     }
 
     nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> LinuxDeviceSystem::obtain(
@@ -97,7 +128,7 @@ namespace zen
             serialNumberConnectTo = std::string(desc.identifier);
         }
 
-        const auto ttyDevices = LinuxDeviceQuery::getDeviceFileForSiLabsSerial(serialNumberConnectTo);
+        const auto ttyDevices = m_monitor.devicesForSerial(serialNumberConnectTo);
 
         if (ttyDevices.size() == 0) {
             spdlog::error("Cannot find USB sensor with serial number {0}", serialNumberConnectTo);
@@ -130,99 +161,46 @@ namespace zen
 
     nonstd::expected<std::vector<int32_t>, ZenError> LinuxDeviceSystem::supportedBaudRates() noexcept
     {
-        std::vector<int32_t> baudRates;
-        baudRates.reserve(22);
-
-        baudRates.emplace_back(50);
-        baudRates.emplace_back(75);
-        baudRates.emplace_back(110);
-        baudRates.emplace_back(134);
-        baudRates.emplace_back(150);
-        baudRates.emplace_back(200);
-        baudRates.emplace_back(300);
-        baudRates.emplace_back(600);
-        baudRates.emplace_back(1200);
-        baudRates.emplace_back(1800);
-        baudRates.emplace_back(2400);
-        baudRates.emplace_back(4800);
-        baudRates.emplace_back(9600);
-        baudRates.emplace_back(19200);
-        baudRates.emplace_back(38400);
-        baudRates.emplace_back(57600);
-        baudRates.emplace_back(115200);
-        baudRates.emplace_back(230400);
-        baudRates.emplace_back(460800);
-        baudRates.emplace_back(500000);
-        baudRates.emplace_back(576000);
-        baudRates.emplace_back(921600);
-
-        return baudRates;
+        // The termios2 interface accepts arbitrary rates, these are the ones
+        // which are commonly supported by USB-UART adapters
+        return std::vector<int32_t>{
+            50, 75, 110, 134, 150, 200, 300, 600, 1200, 1800, 2400, 4800, 9600,
+            19200, 38400, 57600, 115200, 230400, 460800, 500000, 576000, 921600,
+            1000000, 1152000, 1500000, 2000000, 2500000, 3000000, 3500000, 4000000
+        };
     }
 
     constexpr int32_t LinuxDeviceSystem::mapBaudRate(unsigned int baudRate) noexcept
     {
-        if (baudRate > 576000)
-            return B921600;
-        else if (baudRate > 500000)
-            return B576000;
-        else if (baudRate > 460800)
-            return B500000;
-        else if (baudRate > 230400)
-            return B460800;
-        else if (baudRate > 115200)
-            return B230400;
-        else if (baudRate > 57600)
-            return B115200;
-        else if (baudRate > 38400)
-            return B57600;
-        else if (baudRate > 19200)
-            return B38400;
-        else if (baudRate > 9600)
-            return B19200;
-        else if (baudRate > 4800)
-            return B9600;
-        else if (baudRate > 2400)
-            return B4800;
-        else if (baudRate > 1800)
-            return B2400;
-        else if (baudRate > 1200)
-            return B1800;
-        else if (baudRate > 600)
-            return B1200;
-        else if (baudRate > 300)
-            return B600;
-        else if (baudRate > 200)
-            return B300;
-        else if (baudRate > 150)
-            return B200;
-        else if (baudRate > 134)
-            return B150;
-        else if (baudRate > 110)
-            return B134;
-        else if (baudRate > 75)
-            return B110;
-        else if (baudRate > 50)
-            return B75;
-        else if (baudRate > 0)
-            return B50;
-        else
-            return B0;
+        // no rounding to Bxxx constants needed, the rate is applied as is
+        return static_cast<int32_t>(baudRate);
     }
 
     ZenError LinuxDeviceSystem::setBaudRateForFD(int fd, int speed) noexcept
     {
-        struct termios config;
-        if (-1 == ::tcgetattr(fd, &config)) {
-            spdlog::error("Cannot get configuration of io interface file");
-            return ZenError_Io_GetFailed;
+        if (auto error = LinuxBaudRate::setForFD(fd, static_cast<uint32_t>(speed))) {
+            spdlog::error("Cannot set baudrate {} on io interface file", speed);
+            return error;
         }
 
-        cfsetispeed(&config, speed);
-        cfsetospeed(&config, speed);
-        if (-1 == ::tcsetattr(fd, TCSANOW, &config)) {
-            spdlog::error("Cannot set configuration of io interface file");
-            return ZenError_Io_SetFailed;
+        // The driver may only approximate the requested rate, make sure it is
+        // within the tolerance of the UART
+        const auto applied = LinuxBaudRate::getForFD(fd);
+        if (!applied) {
+            spdlog::error("Cannot read back baudrate of io interface file");
+            return applied.error();
         }
+
+        if (*applied != static_cast<uint32_t>(speed)) {
+            const auto deviation = std::abs(static_cast<double>(*applied) - speed) / speed;
+            if (deviation > MAX_BAUDRATE_DEVIATION) {
+                spdlog::error("Driver applied baudrate {} instead of requested {}", *applied, speed);
+                return ZenError_Io_SetFailed;
+            }
+
+            spdlog::warn("Driver applied baudrate {} instead of requested {}", *applied, speed);
+        }
+
         return ZenError_None;
     }
 }
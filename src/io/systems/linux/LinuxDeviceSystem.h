@@ -11,7 +11,11 @@
 #ifndef ZEN_IO_SYSTEMS_LINUX_LINUXDEVICESYSTEM_H_
 #define ZEN_IO_SYSTEMS_LINUX_LINUXDEVICESYSTEM_H_
 
+#include <memory>
+#include <mutex>
+
 #include "io/IIoSystem.h"
+#include "io/systems/linux/LinuxDeviceMonitor.h"
 
 namespace zen
 {
@@ -20,6 +24,8 @@ namespace zen
     public:
         constexpr static const char KEY[] = "LinuxDevice";
 
+        LinuxDeviceSystem() noexcept;
+
         bool available() override { return true; }
 
         ZenError listDevices(std::vector<ZenSensorDesc>& outDevices) override;
@@ -31,6 +37,16 @@ namespace zen
         static ZenError setBaudRateForFD(int fd, int speed) noexcept;
 
         uint32_t getDefaultBaudrate() override { return 115200; }
+
+        void setDeviceSubscriber(IIoDeviceSubscriber* subscriber) noexcept override;
+
+    private:
+        void deviceChanged(const std::string& serialNumber, const std::string& ttyDevice, bool attached) noexcept;
+
+        std::mutex m_subscriberMutex;
+        IIoDeviceSubscriber* m_subscriber;
+
+        LinuxDeviceMonitor m_monitor;
     };
 }
 
@@ -0,0 +1,42 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/systems/linux/SharedMemorySystem.h"
+
+#include "io/interfaces/linux/SharedMemoryInterface.h"
+#include "utility/linux/SharedMemoryRing.h"
+
+namespace zen
+{
+    bool SharedMemorySystem::available()
+    {
+        return true;
+    }
+
+    ZenError SharedMemorySystem::listDevices(std::vector<ZenSensorDesc>&)
+    {
+        return ZenError_None;
+    }
+
+    nonstd::expected<std::unique_ptr<IIoEventInterface>, ZenSensorInitError> SharedMemorySystem::obtainEventBased(const ZenSensorDesc& desc,
+        IIoEventSubscriber& subscriber) noexcept
+    {
+        auto ring = SharedMemoryRing::open(desc.identifier);
+        if (!ring)
+            return nonstd::make_unexpected(ZenSensorInitError_ConnectFailed);
+
+        return std::make_unique<SharedMemoryInterface>(subscriber, std::move(*ring));
+    }
+
+    nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> SharedMemorySystem::obtain(const ZenSensorDesc&, IIoDataSubscriber&) noexcept
+    {
+        return nonstd::make_unexpected(ZenSensorInitError_UnsupportedFunction);
+    }
+}
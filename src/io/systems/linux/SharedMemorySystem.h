@@ -0,0 +1,45 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_SYSTEMS_LINUX_SHAREDMEMORYSYSTEM_H_
+#define ZEN_IO_SYSTEMS_LINUX_SHAREDMEMORYSYSTEM_H_
+
+#include "io/IIoSystem.h"
+#include "io/IIoInterface.h"
+#include "io/IIoEventInterface.h"
+
+namespace zen
+{
+    /**
+    Receives the events which another process on this host publishes with the endpoint
+    "shm://<name>". The identifier of the sensor description is the name of the ring.
+    */
+    class SharedMemorySystem : public IIoSystem
+    {
+    public:
+        constexpr static const char KEY[] = "SharedMemory";
+
+        bool available() override;
+
+        bool isHighLevel() override { return true; }
+
+        // this system won't list any devices to connect to, ZenObtainSensorByName can
+        // be used to read a ring
+        ZenError listDevices(std::vector<ZenSensorDesc>& outDevices) override;
+
+        nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> obtain(const ZenSensorDesc& desc, IIoDataSubscriber& subscriber) noexcept override;
+
+        /** Opens the ring named by the identifier of the sensor description */
+        nonstd::expected<std::unique_ptr<IIoEventInterface>, ZenSensorInitError> obtainEventBased(const ZenSensorDesc& desc,
+            IIoEventSubscriber& subscriber) noexcept override;
+    };
+}
+
+#endif
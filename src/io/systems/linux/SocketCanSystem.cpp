@@ -0,0 +1,116 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "io/systems/linux/SocketCanSystem.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <linux/can.h>
+
+#include <spdlog/spdlog.h>
+
+#include "io/can/CanManager.h"
+#include "io/interfaces/CanInterface.h"
+
+namespace zen
+{
+    namespace
+    {
+        /** Hardware type of CAN network interfaces (ARPHRD_CAN) */
+        constexpr int CAN_INTERFACE_TYPE = 280;
+
+        std::vector<std::string> listCanInterfaces()
+        {
+            std::vector<std::string> interfaces;
+
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator("/sys/class/net", error))
+            {
+                std::ifstream typeFile(entry.path() / "type");
+                int type = 0;
+                if (typeFile >> type && type == CAN_INTERFACE_TYPE)
+                    interfaces.emplace_back(entry.path().filename().string());
+            }
+
+            return interfaces;
+        }
+    }
+
+    SocketCanSystem::~SocketCanSystem()
+    {
+        m_channels.clear();
+    }
+
+    bool SocketCanSystem::available()
+    {
+        if (!m_channels.empty())
+            return true;
+
+        for (const auto& interfaceName : listCanInterfaces())
+        {
+            if (auto channel = SocketCanChannel::open(interfaceName))
+            {
+                spdlog::info("Using CAN network interface {}", interfaceName);
+                CanManager::get().registerChannel(*channel->get());
+                m_channels.emplace_back(std::move(*channel));
+            }
+        }
+
+        return !m_channels.empty();
+    }
+
+    ZenError SocketCanSystem::listDevices(std::vector<ZenSensorDesc>& outDevices)
+    {
+        for (const auto& channel : m_channels)
+            if (auto error = channel->listDevices(outDevices))
+                return error;
+
+        return ZenError_None;
+    }
+
+    nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> SocketCanSystem::obtain(const ZenSensorDesc& desc, IIoDataSubscriber& subscriber) noexcept
+    {
+        char* end = nullptr;
+        const auto deviceId = std::strtoul(desc.identifier, &end, 10);
+        if (end == desc.identifier || deviceId > CAN_EFF_MASK)
+            return nonstd::make_unexpected(ZenSensorInitError_UnknownIdentifier);
+
+        SocketCanChannel* channel = m_channels.front().get();
+        if (*end == '@')
+        {
+            const std::string_view interfaceName(end + 1);
+            auto it = std::find_if(m_channels.begin(), m_channels.end(), [interfaceName](const auto& candidate) {
+                return candidate->interfaceName() == interfaceName;
+            });
+
+            if (it == m_channels.end())
+            {
+                spdlog::error("CAN network interface {} is not available", interfaceName);
+                return nonstd::make_unexpected(ZenSensorInitError_InvalidAddress);
+            }
+
+            channel = it->get();
+        }
+
+        auto ioInterface = std::make_unique<CanInterface>(subscriber, *channel, static_cast<uint32_t>(deviceId));
+        if (!channel->subscribe(*ioInterface.get()))
+        {
+            spdlog::error("CAN ID {} is already in use on {}", deviceId, channel->interfaceName());
+            return nonstd::make_unexpected(ZenSensorInitError_InvalidAddress);
+        }
+
+        return ioInterface;
+    }
+}
@@ -0,0 +1,47 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_IO_SYSTEMS_LINUX_SOCKETCANSYSTEM_H_
+#define ZEN_IO_SYSTEMS_LINUX_SOCKETCANSYSTEM_H_
+
+#include <memory>
+#include <vector>
+
+#include "io/IIoSystem.h"
+#include "io/can/SocketCanChannel.h"
+
+namespace zen
+{
+    /** IO system for sensors on the CAN network interfaces of the Linux kernel.
+     *
+     *  Sensors are identified by their CAN ID, optionally followed by the network
+     *  interface, e.g. "1@can0". Without an interface the first one is used.
+     */
+    class SocketCanSystem : public IIoSystem
+    {
+    public:
+        constexpr static const char KEY[] = "SocketCAN";
+
+        ~SocketCanSystem();
+
+        bool available() override;
+
+        ZenError listDevices(std::vector<ZenSensorDesc>& outDevices) override;
+
+        nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> obtain(const ZenSensorDesc& desc, IIoDataSubscriber& subscriber) noexcept override;
+
+        uint32_t getDefaultBaudrate() override { return 125000; }
+
+    private:
+        std::vector<std::unique_ptr<SocketCanChannel>> m_channels;
+    };
+}
+
+#endif
@@ -14,6 +14,8 @@
 #include "utility/LockingQueue.h"
 #include "ZenTypes.h"
 
+#include <nonstd/expected.hpp>
+
 namespace zen
 {
     /**
@@ -30,6 +32,11 @@ namespace zen
 
         virtual void release() = 0;
 
+        /** Returns the sent and dropped messages, if the processor publishes the events */
+        virtual nonstd::expected<ZenPublishStatistics, ZenError> publishStatistics() const noexcept {
+            return nonstd::make_unexpected(ZenError_NotSupported);
+        }
+
     };
 
 }
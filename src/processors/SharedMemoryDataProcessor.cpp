@@ -0,0 +1,101 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "processors/SharedMemoryDataProcessor.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "streaming/StreamingMessage.h"
+
+namespace zen
+{
+    namespace
+    {
+        std::mutex s_ringsMutex;
+        std::map<std::string, std::weak_ptr<SharedMemoryRing>> s_rings;
+    }
+
+    nonstd::expected<std::unique_ptr<SharedMemoryDataProcessor>, ZenError> SharedMemoryDataProcessor::make(const std::string& ringName) noexcept
+    {
+        std::lock_guard<std::mutex> lock(s_ringsMutex);
+
+        auto& entry = s_rings[ringName];
+        auto ring = entry.lock();
+        if (!ring)
+        {
+            // every slot holds one record
+            auto created = SharedMemoryRing::create(ringName, static_cast<uint32_t>(Streaming::maxRecordSize()));
+            if (!created)
+                return nonstd::make_unexpected(created.error());
+
+            ring = std::move(*created);
+            entry = ring;
+            spdlog::info("Publishing events to shared memory ring {0}", ringName);
+        }
+
+        return std::unique_ptr<SharedMemoryDataProcessor>(new SharedMemoryDataProcessor(std::move(ring)));
+    }
+
+    SharedMemoryDataProcessor::SharedMemoryDataProcessor(std::shared_ptr<SharedMemoryRing> ring)
+        : m_ring(std::move(ring))
+        , m_terminate(false)
+    {
+        m_writerThread = std::thread(&SharedMemoryDataProcessor::run, this);
+    }
+
+    SharedMemoryDataProcessor::~SharedMemoryDataProcessor()
+    {
+        release();
+    }
+
+    LockingQueue<ZenEvent>& SharedMemoryDataProcessor::getEventQueue()
+    {
+        return m_queue;
+    }
+
+    void SharedMemoryDataProcessor::release()
+    {
+        if (!m_writerThread.joinable())
+            return;
+
+        // wake up the writer thread
+        m_terminate = true;
+        m_queue.push(ZenEvent{});
+        m_writerThread.join();
+
+        // the ring is removed once the last of its sensors is released
+        m_ring.reset();
+    }
+
+    void SharedMemoryDataProcessor::run() noexcept
+    {
+        // records are encoded here and copied into a slot of the ring with one memcpy
+        std::vector<std::byte> record(m_ring->slotSize());
+        while (auto event = m_queue.waitToPop())
+        {
+            if (m_terminate)
+                break;
+
+            if (const size_t size = Streaming::writeRecord(*event, record.data()))
+            {
+                if (auto error = m_ring->write(gsl::make_span(record.data(), size)))
+                    spdlog::error("Cannot write to shared memory ring {0}: {1}", m_ring->name(), error);
+            }
+            else
+            {
+                SPDLOG_DEBUG("Got sensor message which is not streamable");
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_SHARED_MEMORY_DATA_PROCESSOR_H_
+#define ZEN_SHARED_MEMORY_DATA_PROCESSOR_H_
+
+#include "DataProcessor.h"
+#include "utility/linux/SharedMemoryRing.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <nonstd/expected.hpp>
+
+namespace zen
+{
+    /**
+    Writes the data events of one sensor into a shared memory ring, from which processes
+    on the same host read them with the SharedMemory IO system. Every entry of the ring is
+    one streaming record (see Streaming::writeRecord). Sensors which write to the same ring
+    name share the ring.
+    */
+    class SharedMemoryDataProcessor final : public DataProcessor {
+    public:
+        /** Creates the ring of the name, unless another sensor of this process already writes to it */
+        static nonstd::expected<std::unique_ptr<SharedMemoryDataProcessor>, ZenError> make(const std::string& ringName) noexcept;
+
+        ~SharedMemoryDataProcessor();
+
+        LockingQueue<ZenEvent>& getEventQueue() override;
+
+        void release() override;
+
+    private:
+        SharedMemoryDataProcessor(std::shared_ptr<SharedMemoryRing> ring);
+
+        void run() noexcept;
+
+        std::shared_ptr<SharedMemoryRing> m_ring;
+
+        /** Our own event queue where the Sensor class will send new sensor events*/
+        LockingQueue<ZenEvent> m_queue;
+
+        std::atomic_bool m_terminate;
+        std::thread m_writerThread;
+    };
+}
+
+#endif
@@ -13,68 +13,27 @@
 namespace zen
 {
 
-ZmqDataProcessor::ZmqDataProcessor() :
-    m_senderThread([](SenderThreadParams& p ) {
-    auto eventResult = p.m_queue.waitToPop();
-
-    bool terminate = !eventResult.has_value();
-    if (eventResult.has_value()) {
-        // check for disconnect
-        terminate = terminate || eventResult->eventType == ZenEventType_SensorDisconnected;
-    }
-
-    if (terminate) {
-        // in case the waitToPop returns with an emtpy optional its signaling
-        // that the connected queue will be shutdown.
-        spdlog::info("ZmqDataProcessor will terminate because sensor event queue terminated.");
-                
-        p.m_publisher->close();
-        return false;
-    }
-
-    zmq::message_t message;
-    bool streamable = zen::Streaming::toZmqMessage(*eventResult, message);
-
-    if (streamable) {
-        p.m_publisher->send(message, zmq::send_flags::dontwait);
-    } else {
-        spdlog::error("Got sensor message which is not streamable");
-    }
-
-    // continue wait for next event
-    return true;
-    })
+ZmqDataProcessor::ZmqDataProcessor(std::shared_ptr<ZmqPublisherHub> hub, uintptr_t sensor) :
+    m_hub(std::move(hub)),
+    m_sensor(sensor)
 {
 }
 
-bool ZmqDataProcessor::connect(const std::string & endpoint) {
-    m_endpoint = endpoint;
-    m_publisher = std::make_unique<zmq::socket_t>(m_context, ZMQ_PUB);
-    try {
-        m_publisher->bind(m_endpoint);
-    }
-    catch (zmq::error_t & err) {
-        spdlog::error("Cannot publish events on endpoint {0} because: {1}",
-            m_endpoint, err.what());
-        return false;
-    }
-
-    // start polling thread
-    m_senderThread.start(SenderThreadParams{ getEventQueue(), m_publisher });
-    return true;
+ZmqDataProcessor::~ZmqDataProcessor() {
+    release();
 }
 
 LockingQueue<ZenEvent>& ZmqDataProcessor::getEventQueue() {
-    return m_queue;
+    return m_hub->eventQueue();
 }
 
 void ZmqDataProcessor::release() {
-    ZenEvent evt;
+    // the hub stops once the last of its sensors is released
+    m_hub->remove(m_sensor);
+}
 
-    evt.eventType = ZenEventType_SensorDisconnected;
-    m_queue.push(evt);
-    // wait for the thread to terminate
-    m_senderThread.stop();
+nonstd::expected<ZenPublishStatistics, ZenError> ZmqDataProcessor::publishStatistics() const noexcept {
+    return m_hub->statistics();
 }
 
 }
@@ -12,43 +12,32 @@
 #define ZEN_ZMQ_DATA_PROCESSOR_H_
 
 #include "DataProcessor.h"
-#include "utility/LockingQueue.h"
-#include "utility/ManagedThread.h"
-#include "streaming/StreamingProtocol.h"
+#include "processors/ZmqPublisherHub.h"
 
-#include <zmq.hpp>
-#include <spdlog/spdlog.h>
+#include <memory>
 
 namespace zen
 {
     /**
+    Publishes the data events of one sensor through the ZmqPublisherHub of its endpoint,
+    which is shared with the other sensors publishing there.
     */
     class ZmqDataProcessor final : public DataProcessor {
     public:
-        ZmqDataProcessor();
-
-        bool connect(const std::string & endpoint);
+        ZmqDataProcessor(std::shared_ptr<ZmqPublisherHub> hub, uintptr_t sensor);
+        ~ZmqDataProcessor();
 
         LockingQueue<ZenEvent>& getEventQueue() override;
 
         void release() override;
 
-    private:
-        /** Our own event queue where the Sensor class will send new sensor events*/
-        LockingQueue<ZenEvent> m_queue;
-
-        std::string m_endpoint;
-        
-        struct SenderThreadParams {
-            LockingQueue<ZenEvent>& m_queue;
-            std::unique_ptr<zmq::socket_t> & m_publisher;
-        };
+        /** Returns the messages which were sent or dropped on the hub's endpoint */
+        nonstd::expected<ZenPublishStatistics, ZenError> publishStatistics() const noexcept override;
 
-        zmq::context_t m_context;
-        std::unique_ptr<zmq::socket_t> m_publisher;
-
-        ManagedThread<SenderThreadParams> m_senderThread;
+    private:
+        std::shared_ptr<ZmqPublisherHub> m_hub;
+        const uintptr_t m_sensor;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
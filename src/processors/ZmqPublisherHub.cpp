@@ -0,0 +1,318 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "processors/ZmqPublisherHub.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+
+#include "streaming/StreamingProtocol.h"
+
+namespace zen
+{
+    namespace
+    {
+        std::mutex s_hubsMutex;
+        std::map<std::string, std::weak_ptr<ZmqPublisherHub>> s_hubs;
+        std::weak_ptr<zmq::context_t> s_context;
+
+        /** Returns the sensor topic of the options, or nothing if it is invalid */
+        std::optional<std::string_view> sensorTopic(const ZenPublishOptions& options) noexcept
+        {
+            const auto end = std::find(std::begin(options.sensorTopic), std::end(options.sensorTopic), '\0');
+            const std::string_view topic(options.sensorTopic, static_cast<size_t>(end - std::begin(options.sensorTopic)));
+            if (end == std::end(options.sensorTopic) || topic.find('/') != std::string_view::npos || topic == "*")
+                return std::nullopt;
+
+            return topic;
+        }
+
+        bool sameSocketOptions(const ZenPublishOptions& lhs, const ZenPublishOptions& rhs) noexcept
+        {
+            return lhs.sendHighWaterMark == rhs.sendHighWaterMark && lhs.sendBufferBytes == rhs.sendBufferBytes &&
+                lhs.lingerMs == rhs.lingerMs && lhs.conflate == rhs.conflate && lhs.countDrops == rhs.countDrops;
+        }
+
+        /** Messages only carry sequence numbers on request, so older subscribers can still decode them */
+        Streaming::StreamingEncoding streamingEncoding(const ZenPublishOptions& options) noexcept
+        {
+            return options.sequenceNumbers ? Streaming::StreamingEncoding_FixedLayoutV2 : Streaming::StreamingEncoding_FixedLayoutV1;
+        }
+
+        /** Applies the socket options which differ from the defaults, before the socket is bound */
+        void setSocketOptions(zmq::socket_t& socket, const ZenPublishOptions& options)
+        {
+            if (options.sendHighWaterMark != 0)
+                socket.setsockopt(ZMQ_SNDHWM, static_cast<int>(options.sendHighWaterMark));
+            if (options.sendBufferBytes != 0)
+                socket.setsockopt(ZMQ_SNDBUF, static_cast<int>(options.sendBufferBytes));
+            if (options.lingerMs != 0)
+                socket.setsockopt(ZMQ_LINGER, std::max(options.lingerMs, 0));
+            if (options.conflate)
+                socket.setsockopt(ZMQ_CONFLATE, 1);
+            if (options.countDrops)
+                socket.setsockopt(ZMQ_XPUB_NODROP, 1);
+        }
+    }
+
+    nonstd::expected<std::shared_ptr<ZmqPublisherHub>, ZenError> ZmqPublisherHub::obtain(const std::string& endpoint, const ZenPublishOptions& options) noexcept
+    {
+        std::lock_guard<std::mutex> lock(s_hubsMutex);
+
+        auto& entry = s_hubs[endpoint];
+        if (auto hub = entry.lock())
+        {
+            if (hub->m_options.batchSize != options.batchSize || hub->m_options.batchIntervalUs != options.batchIntervalUs ||
+                hub->m_options.batchBytes != options.batchBytes)
+                spdlog::warn("Events published on endpoint {0} are batched with the options of the first sensor", endpoint);
+            if (!sameSocketOptions(hub->m_options, options))
+                spdlog::warn("Events published on endpoint {0} are sent with the socket options of the first sensor", endpoint);
+            if (hub->m_options.sequenceNumbers != options.sequenceNumbers)
+                spdlog::warn("Events published on endpoint {0} are encoded with the options of the first sensor", endpoint);
+
+            return hub;
+        }
+
+        auto context = s_context.lock();
+        if (!context)
+        {
+            context = std::make_shared<zmq::context_t>();
+            s_context = context;
+        }
+
+        try
+        {
+            // next line may throw zmq::error_t if the endpoint string is not solid
+            std::shared_ptr<ZmqPublisherHub> hub(new ZmqPublisherHub(endpoint, options, std::move(context)));
+            entry = hub;
+            return hub;
+        }
+        catch (zmq::error_t& err)
+        {
+            spdlog::error("Cannot publish events on endpoint {0} because: {1}", endpoint, err.what());
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+        }
+    }
+
+    ZmqPublisherHub::ZmqPublisherHub(std::string endpoint, const ZenPublishOptions& options, std::shared_ptr<zmq::context_t> context)
+        : m_endpoint(std::move(endpoint))
+        , m_options(options)
+        , m_context(std::move(context))
+        , m_publisher(*m_context, ZMQ_PUB)
+        , m_sentMessages(0)
+        , m_droppedMessages(0)
+        , m_terminate(false)
+    {
+        setSocketOptions(m_publisher, m_options);
+        m_publisher.bind(m_endpoint);
+        m_senderThread = std::thread(&ZmqPublisherHub::run, this);
+    }
+
+    ZmqPublisherHub::~ZmqPublisherHub()
+    {
+        // wake up the sender thread
+        m_terminate = true;
+        m_queue.push(ZenEvent{});
+        m_senderThread.join();
+
+        m_publisher.close();
+        spdlog::info("Stopped publishing events on endpoint {0}", m_endpoint);
+    }
+
+    ZenError ZmqPublisherHub::add(uintptr_t sensor, const ZenPublishOptions& options) noexcept
+    {
+        const auto topic = sensorTopic(options);
+        if (!topic)
+        {
+            spdlog::error("Cannot publish events with invalid sensor topic");
+            return ZenError_InvalidArgument;
+        }
+
+        SensorTopics topics;
+        if (!topic->empty())
+        {
+            topics.imu = Streaming::streamingTopic(Streaming::StreamingMessageType_ZenEventImu, *topic);
+            topics.gnss = Streaming::streamingTopic(Streaming::StreamingMessageType_ZenEventGnss, *topic);
+
+            if (m_options.conflate)
+            {
+                spdlog::error("Cannot publish events with a sensor topic on endpoint {0}, which conflates its messages", m_endpoint);
+                return ZenError_InvalidArgument;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
+        for (const auto& registered : m_sensors)
+        {
+            if (!topic->empty() && registered.second.imu == topics.imu)
+            {
+                spdlog::error("Sensor topic {0} is already published on endpoint {1}", *topic, m_endpoint);
+                return ZenError_InvalidArgument;
+            }
+        }
+
+        if (!m_sensors.emplace(sensor, std::move(topics)).second)
+        {
+            spdlog::error("Sensor already publishes its events on endpoint {0}", m_endpoint);
+            return ZenError_InvalidArgument;
+        }
+
+        spdlog::info("Publishing events to endpoint {0} with sensor topic '{1}'", m_endpoint, *topic);
+        return ZenError_None;
+    }
+
+    void ZmqPublisherHub::remove(uintptr_t sensor) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
+        m_sensors.erase(sensor);
+    }
+
+    void ZmqPublisherHub::run() noexcept
+    {
+        while (auto event = m_queue.waitToPop())
+        {
+            if (m_terminate)
+                break;
+
+            try
+            {
+                if (m_options.batchSize > 1)
+                    sendBatch(std::move(*event));
+                else
+                    sendEvent(*event);
+            }
+            catch (const zmq::error_t& err)
+            {
+                spdlog::error("Cannot publish events on endpoint {0} because: {1}", m_endpoint, err.what());
+            }
+        }
+    }
+
+    void ZmqPublisherHub::sendEvent(const ZenEvent& event)
+    {
+        zmq::message_t message;
+        if (!Streaming::toZmqMessage(event, message, streamingEncoding(m_options)))
+        {
+            SPDLOG_DEBUG("Got sensor message which is not streamable");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
+        if (auto eventTopic = topic(event))
+            send(*eventTopic, message);
+    }
+
+    void ZmqPublisherHub::sendBatch(ZenEvent first)
+    {
+        const size_t maxEvents = std::min<size_t>(m_options.batchSize, Streaming::STREAMING_MAX_BATCH_SIZE);
+        const size_t maxBytes = m_options.batchBytes == 0 ? std::numeric_limits<size_t>::max() : m_options.batchBytes;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(m_options.batchIntervalUs);
+
+        std::vector<ZenEvent> batch;
+        batch.reserve(maxEvents);
+        size_t batchBytes = Streaming::streamingHeaderSize(streamingEncoding(m_options)) + Streaming::STREAMING_BATCH_COUNT_SIZE;
+
+        auto addEvent = [&batch, &batchBytes](ZenEvent&& event) {
+            if (const size_t recordSize = Streaming::recordSize(event)) {
+                batch.emplace_back(std::move(event));
+                batchBytes += recordSize;
+            } else {
+                SPDLOG_DEBUG("Got sensor message which is not streamable");
+            }
+        };
+        addEvent(std::move(first));
+
+        // the batch is sent when the next event might not fit anymore
+        while (batch.size() < maxEvents && batchBytes + Streaming::maxRecordSize() <= maxBytes)
+        {
+            auto event = m_options.batchIntervalUs == 0 ? m_queue.tryToPop() : m_queue.waitToPopUntil(deadline);
+            if (!event.has_value() || m_terminate)
+                break;
+
+            addEvent(std::move(*event));
+        }
+
+        std::lock_guard<std::mutex> lock(m_sensorsMutex);
+
+        // every topic carries the messages of one sensor and type, so the batch is split by topic
+        batch.erase(std::remove_if(batch.begin(), batch.end(), [this](const ZenEvent& event) {
+            return topic(event) == nullptr;
+        }), batch.end());
+        std::stable_sort(batch.begin(), batch.end(), [this](const ZenEvent& lhs, const ZenEvent& rhs) {
+            return *topic(lhs) < *topic(rhs);
+        });
+
+        zmq::message_t message;
+        for (auto begin = batch.begin(); begin != batch.end();)
+        {
+            const std::string& batchTopic = *topic(*begin);
+            const auto end = std::find_if(begin, batch.end(), [this, &batchTopic](const ZenEvent& event) {
+                return *topic(event) != batchTopic;
+            });
+
+            Streaming::toZmqBatchMessage(gsl::make_span(&*begin, static_cast<size_t>(end - begin)), message, streamingEncoding(m_options));
+            send(batchTopic, message);
+            begin = end;
+        }
+    }
+
+    void ZmqPublisherHub::send(const std::string& topic, zmq::message_t& message)
+    {
+        // messages which are dropped at the high-water mark leave a gap in the sequence of their topic
+        if (m_options.sequenceNumbers)
+            Streaming::setStreamingSequence(message, { m_nextSequences[topic]++, Streaming::streamingClockNs() });
+
+        // libzmq only reports messages which reach the high-water mark with ZMQ_XPUB_NODROP, by failing with EAGAIN
+        if (!topic.empty())
+        {
+            zmq::message_t topicMessage(topic.data(), topic.size());
+            if (!m_publisher.send(topicMessage, zmq::send_flags::sndmore | zmq::send_flags::dontwait))
+            {
+                ++m_droppedMessages;
+                return;
+            }
+        }
+
+        if (m_publisher.send(message, zmq::send_flags::dontwait))
+            ++m_sentMessages;
+        else
+            ++m_droppedMessages;
+    }
+
+    ZenPublishStatistics ZmqPublisherHub::statistics() const noexcept
+    {
+        ZenPublishStatistics statistics{};
+        statistics.sentMessages = m_sentMessages;
+        statistics.droppedMessages = m_droppedMessages;
+        return statistics;
+    }
+
+    const std::string* ZmqPublisherHub::topic(const ZenEvent& event) const noexcept
+    {
+        auto it = m_sensors.find(event.sensor.handle);
+        if (it == m_sensors.end())
+            return nullptr;
+
+        const auto msgType = Streaming::streamingMessageType(event);
+        if (msgType == Streaming::StreamingMessageType_ZenEventImu)
+            return &it->second.imu;
+        if (msgType == Streaming::StreamingMessageType_ZenEventGnss)
+            return &it->second.gnss;
+
+        return nullptr;
+    }
+}
@@ -0,0 +1,106 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_PROCESSORS_ZMQPUBLISHERHUB_H_
+#define ZEN_PROCESSORS_ZMQPUBLISHERHUB_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <nonstd/expected.hpp>
+#include <zmq.hpp>
+
+#include "ZenTypes.h"
+#include "utility/LockingQueue.h"
+
+namespace zen
+{
+    /**
+    Publishes the data events of all sensors which stream to the same endpoint on one
+    PUB socket. The sensors feed their events into one queue, from which a single sender
+    thread encodes them and sends them under the topics of their sensors. All hubs share
+    one ZeroMQ context.
+    */
+    class ZmqPublisherHub
+    {
+    public:
+        /** Returns the hub which publishes on the endpoint, creates and binds it if there is none yet.
+         * The batching and socket options of the first sensor apply to all sensors of the hub.
+         */
+        static nonstd::expected<std::shared_ptr<ZmqPublisherHub>, ZenError> obtain(const std::string& endpoint, const ZenPublishOptions& options) noexcept;
+
+        ~ZmqPublisherHub();
+
+        /** Publishes the events of the sensor under its sensor topic, see ZenPublishOptions */
+        ZenError add(uintptr_t sensor, const ZenPublishOptions& options) noexcept;
+
+        /** Stops publishing the events of the sensor */
+        void remove(uintptr_t sensor) noexcept;
+
+        /** Queue to which the registered sensors publish their events */
+        LockingQueue<ZenEvent>& eventQueue() noexcept { return m_queue; }
+
+        const std::string& endpoint() const noexcept { return m_endpoint; }
+
+        /** Returns the messages which were sent or dropped on the endpoint */
+        ZenPublishStatistics statistics() const noexcept;
+
+    private:
+        ZmqPublisherHub(std::string endpoint, const ZenPublishOptions& options, std::shared_ptr<zmq::context_t> context);
+
+        void run() noexcept;
+
+        /** Sends the event in its own message */
+        void sendEvent(const ZenEvent& event);
+
+        /** Packs the event and the following ones into batches until the batch is full or its interval has passed */
+        void sendBatch(ZenEvent first);
+
+        /** Numbers the message within its topic and sends it, after its topic frame if there is one */
+        void send(const std::string& topic, zmq::message_t& message);
+
+        /** Returns the topic of the event's messages, or nullptr if it is not published. Requires m_sensorsMutex. */
+        const std::string* topic(const ZenEvent& event) const noexcept;
+
+        struct SensorTopics
+        {
+            std::string imu;
+            std::string gnss;
+        };
+
+        const std::string m_endpoint;
+        const ZenPublishOptions m_options;
+
+        /** Destroyed after the socket, so the context does not wait for it to close */
+        std::shared_ptr<zmq::context_t> m_context;
+        zmq::socket_t m_publisher;
+
+        LockingQueue<ZenEvent> m_queue;
+
+        mutable std::mutex m_sensorsMutex;
+        std::unordered_map<uintptr_t, SensorTopics> m_sensors;
+
+        /** Sequence number of the next message of each topic, only accessed by the sender thread */
+        std::unordered_map<std::string, uint64_t> m_nextSequences;
+
+        std::atomic<uint64_t> m_sentMessages;
+        std::atomic<uint64_t> m_droppedMessages;
+
+        std::atomic_bool m_terminate;
+        std::thread m_senderThread;
+    };
+}
+
+#endif
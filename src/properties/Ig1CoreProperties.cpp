@@ -38,7 +38,8 @@ namespace zen
                 });
 
                 const auto function = static_cast<DeviceProperty_t>(base::v1::mapCommand(command));
-                return m_communicator.sendAndWaitForAck(0, function, function, {});
+                // Commands like storing the settings in flash keep the sensor busy
+                return m_communicator.sendAndWaitForAck(0, function, function, {}, SyncedModbusCommunicator::LONG_COMMAND_TIMEOUT);
             }
             else
             {
@@ -142,11 +143,11 @@ namespace zen
                 if (auto result = m_communicator.sendAndWaitForResult<uint32_t>(0, function, function, {}))
                     return *result != 0;
                 else
-                    return result.error();
+                    return nonstd::make_unexpected(result.error());
             }
             else
             {
-                return streaming.error();
+                return nonstd::make_unexpected(streaming.error());
             }
         }
 
@@ -204,16 +205,16 @@ namespace zen
                     if (auto result = m_communicator.sendAndWaitForResult<uint32_t>(0, function, function, {}))
                         return static_cast<int32_t>(*result);
                     else
-                        return result.error();
+                        return nonstd::make_unexpected(result.error());
                 }
                 else
                 {
-                    return streaming.error();
+                    return nonstd::make_unexpected(streaming.error());
                 }
             }
         }
 
-        return ZenError_UnknownProperty;
+        return nonstd::make_unexpected(ZenError_UnknownProperty);
     }
 
     ZenError Ig1CoreProperties::setInt32(ZenProperty_t property, int32_t value) noexcept
@@ -281,6 +282,7 @@ namespace zen
         case ZenSensorProperty_FirmwareVersion:
         case ZenSensorProperty_SerialNumber:
         case ZenSensorProperty_SupportedBaudRates:
+        case ZenSensorProperty_BatteryCharging:
         case ZenSensorProperty_BatteryLevel:
         case ZenSensorProperty_BatteryVoltage:
             return true;
@@ -165,7 +165,8 @@ template <> struct OutputDataFlag<ZenImuProperty_OutputLowPrecision>
                 });
 
                 const auto function = static_cast<DeviceProperty_t>(imu::v1::mapCommand(command));
-                return m_communicator.sendAndWaitForAck(0, function, function, {});
+                // Commands like storing the settings in flash keep the sensor busy
+                return m_communicator.sendAndWaitForAck(0, function, function, {}, SyncedModbusCommunicator::LONG_COMMAND_TIMEOUT);
             }
             else
             {
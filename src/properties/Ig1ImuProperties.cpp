@@ -183,7 +183,8 @@ template <> struct OutputDataFlag<ZenImuProperty_OutputLowPrecision>
                         return error;
                     return ZenError_None;
                 } else {
-                    return m_communicator.sendAndWaitForAck(0, function, function, {});
+                    // Commands like calibrating the gyroscope keep the sensor busy
+                    return m_communicator.sendAndWaitForAck(0, function, function, {}, SyncedModbusCommunicator::LONG_COMMAND_TIMEOUT);
                 }
             }
             else
@@ -353,11 +354,11 @@ template <> struct OutputDataFlag<ZenImuProperty_OutputLowPrecision>
                 if (auto result = m_communicator.sendAndWaitForResult<uint32_t>(0, function, function, {}))
                     return static_cast<int32_t>(*result);
                 else
-                    return result.error();
+                    return nonstd::make_unexpected(result.error());
             }
             else
             {
-                return streaming.error();
+                return nonstd::make_unexpected(streaming.error());
             }
         }
 
@@ -670,11 +671,11 @@ template <> struct OutputDataFlag<ZenImuProperty_OutputLowPrecision>
             if (auto result = m_communicator.sendAndWaitForResult<uint32_t>(0, function, function, {}))
                 return static_cast<int32_t>(*result) > 0;
             else
-                return result.error();
+                return nonstd::make_unexpected(result.error());
         }
         else
         {
-            return streaming.error();
+            return nonstd::make_unexpected(streaming.error());
         }
     }
 
@@ -195,7 +195,8 @@ namespace zen
                 });
 
                 const auto function = static_cast<DeviceProperty_t>(imu::v0::mapCommand(command));
-                return m_communicator.sendAndWaitForAck(0, function, function, {});
+                // Commands like calibrating the gyroscope keep the sensor busy
+                return m_communicator.sendAndWaitForAck(0, function, function, {}, SyncedModbusCommunicator::LONG_COMMAND_TIMEOUT);
             }
             else
             {
@@ -0,0 +1,158 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_STREAMING_FIXEDLAYOUTARCHIVE_H_
+#define ZEN_STREAMING_FIXEDLAYOUTARCHIVE_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include <gsl/span>
+
+#include "utility/LittleEndian.h"
+
+namespace zen {
+
+    namespace Streaming {
+        /**
+        Fixed-layout encoding of the streamed data structures.
+
+        The archives visit the same serialize functions as cereal and encode every field
+        in little-endian byte order with the size of its type, without padding or length
+        prefixes. Hence the size of an encoded structure only depends on its type and it
+        can be written directly into a preallocated buffer. On little-endian hosts the
+        bytes match the output of cereal's binary archive.
+        */
+        namespace FixedLayout {
+            template <typename T>
+            constexpr bool isScalar = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+        }
+
+        /** Sums up the encoded size of the visited fields */
+        class FixedLayoutSizeArchive {
+        public:
+            template <typename... T>
+            void operator()(T&... values) noexcept {
+                (add(values), ...);
+            }
+
+            size_t size() const noexcept { return m_size; }
+
+        private:
+            template <typename T>
+            void add(T& value) noexcept {
+                if constexpr (FixedLayout::isScalar<T>)
+                    m_size += sizeof(T);
+                else if constexpr (std::is_array_v<T>)
+                    for (auto& element : value)
+                        add(element);
+                else
+                    serialize(*this, value);
+            }
+
+            size_t m_size = 0;
+        };
+
+        /** Writes the visited fields to a buffer of at least the encoded size */
+        class FixedLayoutOutputArchive {
+        public:
+            explicit FixedLayoutOutputArchive(std::byte* buffer) noexcept
+                : m_pos(buffer)
+            {}
+
+            template <typename... T>
+            void operator()(T&... values) noexcept {
+                (write(values), ...);
+            }
+
+        private:
+            template <typename T>
+            void write(T& value) noexcept {
+                if constexpr (FixedLayout::isScalar<T>)
+                    m_pos = writeLittleEndian(m_pos, value);
+                else if constexpr (std::is_array_v<T>)
+                    for (auto& element : value)
+                        write(element);
+                else
+                    serialize(*this, value);
+            }
+
+            std::byte* m_pos;
+        };
+
+        /** Reads the visited fields from a buffer. Fails if the buffer is too short. */
+        class FixedLayoutInputArchive {
+        public:
+            explicit FixedLayoutInputArchive(gsl::span<const std::byte> buffer) noexcept
+                : m_pos(buffer.data())
+                , m_end(buffer.data() + buffer.size())
+            {}
+
+            template <typename... T>
+            void operator()(T&... values) noexcept {
+                (read(values), ...);
+            }
+
+            /** Returns false if the buffer ended before all fields were read */
+            bool good() const noexcept { return m_pos != nullptr; }
+
+        private:
+            template <typename T>
+            void read(T& value) noexcept {
+                if constexpr (FixedLayout::isScalar<T>) {
+                    if (m_pos == nullptr || m_end - m_pos < static_cast<std::ptrdiff_t>(sizeof(T))) {
+                        m_pos = nullptr;
+                        return;
+                    }
+
+                    m_pos = readLittleEndian(m_pos, value);
+                }
+                else if constexpr (std::is_array_v<T>)
+                    for (auto& element : value)
+                        read(element);
+                else
+                    serialize(*this, value);
+            }
+
+            const std::byte* m_pos;
+            const std::byte* m_end;
+        };
+
+        /** Returns the size of a structure in the fixed-layout encoding */
+        template <typename T>
+        size_t fixedLayoutSize() noexcept {
+            static const size_t size = [] {
+                T value{};
+                FixedLayoutSizeArchive archive;
+                archive(value);
+                return archive.size();
+            }();
+            return size;
+        }
+
+        /** Encodes the structure into a buffer of at least fixedLayoutSize<T>() bytes */
+        template <typename T>
+        void writeFixedLayout(T const& value, std::byte* buffer) noexcept {
+            FixedLayoutOutputArchive archive(buffer);
+            // the serialize functions take mutable references, but only read when writing
+            archive(const_cast<T&>(value));
+        }
+
+        /** Decodes the structure, returns false if the buffer is too short */
+        template <typename T>
+        bool readFixedLayout(gsl::span<const std::byte> buffer, T& outValue) noexcept {
+            FixedLayoutInputArchive archive(buffer);
+            archive(outValue);
+            return archive.good();
+        }
+    }
+}
+
+#endif
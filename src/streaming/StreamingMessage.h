@@ -0,0 +1,158 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_STREAMING_STREAMINGMESSAGE_H_
+#define ZEN_STREAMING_STREAMINGMESSAGE_H_
+
+#include "streaming/FixedLayoutArchive.h"
+#include "streaming/ZenTypesSerialization.h"
+#include "ZenTypes.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <optional>
+
+namespace zen {
+
+    namespace Streaming {
+        enum StreamingMessageType {
+            StreamingMessageType_ZenEventImu = 1,
+            StreamingMessageType_ZenEventGnss = 2,
+            /// several messages in the fixed-layout encoding, see toZmqBatchMessage
+            StreamingMessageType_Batch = 3,
+            StreamingMessageType_Unknown = 99
+        };
+
+        union StreamingMessagePayload {
+            zen::Serialization::ZenEventImuSerialization imuData;
+            zen::Serialization::ZenEventGnssSerialization gnssData;
+        };
+
+        class StreamingMessage {
+        public:
+            StreamingMessagePayload payload;
+            StreamingMessageType type;
+        };
+
+        inline std::optional<ZenEvent> streamingMessageToZenEvent(StreamingMessage const& msg) {
+            ZenEvent evt;
+            if (msg.type == StreamingMessageType_ZenEventImu) {
+                evt.component.handle = msg.payload.imuData.component;
+                evt.sensor.handle = msg.payload.imuData.sensor;
+                evt.eventType = ZenEventType_ImuData;
+                evt.data.imuData = msg.payload.imuData.data;
+            }
+            else if (msg.type == StreamingMessageType_ZenEventGnss) {
+                evt.component.handle = msg.payload.gnssData.component;
+                evt.sensor.handle = msg.payload.gnssData.sensor;
+                evt.eventType = ZenEventType_GnssData;
+                evt.data.gnssData = msg.payload.gnssData.data;
+            }
+            else {
+                spdlog::error("Streaming Message not supported");
+                return std::nullopt;
+            }
+
+            return evt;
+        }
+
+        /** Returns the type under which an event is streamed, or StreamingMessageType_Unknown */
+        inline StreamingMessageType streamingMessageType(ZenEvent const& evt) noexcept {
+            // todo: this needs to be refactored when the event type numbering scheme is fixed
+            // right now the component numbers for IMU and GNSS are hard-coded
+            if (evt.component.handle == 1)
+                return StreamingMessageType_ZenEventImu;
+            if (evt.component.handle == 2)
+                return StreamingMessageType_ZenEventGnss;
+
+            return StreamingMessageType_Unknown;
+        }
+
+        inline zen::Serialization::ZenEventImuSerialization imuSerialization(ZenEvent const& evt) noexcept {
+            zen::Serialization::ZenEventImuSerialization imuData;
+            imuData.sensor = evt.sensor.handle;
+            imuData.component = evt.component.handle;
+            imuData.data = evt.data.imuData;
+            return imuData;
+        }
+
+        inline zen::Serialization::ZenEventGnssSerialization gnssSerialization(ZenEvent const& evt) noexcept {
+            zen::Serialization::ZenEventGnssSerialization gnssData;
+            gnssData.sensor = evt.sensor.handle;
+            gnssData.component = evt.component.handle;
+            gnssData.data = evt.data.gnssData;
+            return gnssData;
+        }
+
+        /** Returns the fixed-layout payload size of a message type, or 0 if it cannot be streamed */
+        inline size_t fixedLayoutPayloadSize(StreamingMessageType type) noexcept {
+            if (type == StreamingMessageType_ZenEventImu)
+                return fixedLayoutSize<zen::Serialization::ZenEventImuSerialization>();
+            if (type == StreamingMessageType_ZenEventGnss)
+                return fixedLayoutSize<zen::Serialization::ZenEventGnssSerialization>();
+
+            return 0;
+        }
+
+        /**
+        A record is the type of a message (1 byte) followed by its fixed-layout payload,
+        whose size follows from the type. Batches and shared-memory rings consist of records.
+        */
+        constexpr size_t STREAMING_RECORD_HEADER_SIZE = 1;
+
+        /** Returns the size of the largest record */
+        inline size_t maxRecordSize() noexcept {
+            return STREAMING_RECORD_HEADER_SIZE + std::max(
+                fixedLayoutPayloadSize(StreamingMessageType_ZenEventImu),
+                fixedLayoutPayloadSize(StreamingMessageType_ZenEventGnss));
+        }
+
+        /** Returns the size of the event's record, or 0 if it cannot be streamed */
+        inline size_t recordSize(ZenEvent const& evt) noexcept {
+            const size_t payloadSize = fixedLayoutPayloadSize(streamingMessageType(evt));
+            return payloadSize == 0 ? 0 : STREAMING_RECORD_HEADER_SIZE + payloadSize;
+        }
+
+        /** Writes the event's record to a buffer of at least recordSize(evt) bytes. Returns its size, or 0 if it cannot be streamed. */
+        inline size_t writeRecord(ZenEvent const& evt, std::byte* buffer) noexcept {
+            const auto msgType = streamingMessageType(evt);
+            if (msgType == StreamingMessageType_ZenEventImu)
+                writeFixedLayout(imuSerialization(evt), buffer + STREAMING_RECORD_HEADER_SIZE);
+            else if (msgType == StreamingMessageType_ZenEventGnss)
+                writeFixedLayout(gnssSerialization(evt), buffer + STREAMING_RECORD_HEADER_SIZE);
+            else
+                return 0;
+
+            buffer[0] = std::byte(msgType);
+            return STREAMING_RECORD_HEADER_SIZE + fixedLayoutPayloadSize(msgType);
+        }
+
+        /** Reads the record at the start of the buffer. Returns its size, or 0 if it is malformed. */
+        inline size_t readRecord(const std::byte* buffer, size_t size, StreamingMessage& outMessage) noexcept {
+            if (size < STREAMING_RECORD_HEADER_SIZE)
+                return 0;
+
+            outMessage.type = StreamingMessageType(buffer[0]);
+            const size_t payloadSize = fixedLayoutPayloadSize(outMessage.type);
+            if (payloadSize == 0 || size - STREAMING_RECORD_HEADER_SIZE < payloadSize)
+                return 0;
+
+            const auto payload = gsl::make_span(buffer + STREAMING_RECORD_HEADER_SIZE, payloadSize);
+            const bool decoded = outMessage.type == StreamingMessageType_ZenEventImu
+                ? readFixedLayout(payload, outMessage.payload.imuData)
+                : readFixedLayout(payload, outMessage.payload.gnssData);
+
+            return decoded ? STREAMING_RECORD_HEADER_SIZE + payloadSize : 0;
+        }
+    }
+}
+
+#endif
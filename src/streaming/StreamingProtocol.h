@@ -11,6 +11,7 @@
 #ifndef ZEN_STREAMING_PROTOCOL_H_
 #define ZEN_STREAMING_PROTOCOL_H_
 
+#include "streaming/StreamingMessage.h"
 #include "streaming/ZenTypesSerialization.h"
 #include "ZenTypes.h"
 
@@ -19,87 +20,212 @@
 
 #include <spdlog/spdlog.h>
 #include <zmq.hpp>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <istream>
+#include <limits>
 #include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace zen {
 
     namespace Streaming {
-        enum StreamingMessageType {
-            StreamingMessageType_ZenEventImu = 1,
-            StreamingMessageType_ZenEventGnss = 2,
-            StreamingMessageType_Unknown = 99
+        /**
+        Encoding of the payload, stored in the first byte of the 4-byte message header.
+        The last header byte holds the StreamingMessageType.
+        */
+        enum StreamingEncoding {
+            /// cereal binary archive, sent by earlier versions of OpenZen
+            StreamingEncoding_Cereal = 0,
+            /// FixedLayoutArchive, version 1
+            StreamingEncoding_FixedLayoutV1 = 1,
+            /// FixedLayoutArchive, with a StreamingSequence after the 4-byte header
+            StreamingEncoding_FixedLayoutV2 = 2
         };
 
-        union StreamingMessagePayload {
-            zen::Serialization::ZenEventImuSerialization imuData;
-            zen::Serialization::ZenEventGnssSerialization gnssData;
+        constexpr size_t STREAMING_HEADER_SIZE = 4;
+
+        /**
+        Sequence number of a message in its stream, i.e. among the messages with the same topic
+        of one publisher, and the publisher's monotonic clock (ns) when it was sent.
+        */
+        struct StreamingSequence {
+            uint64_t sequence;
+            uint64_t sendTimeNs;
         };
 
-        class StreamingMessage {
+        template <class Archive>
+        void serialize(Archive& archive, StreamingSequence& sequence) {
+            archive(sequence.sequence, sequence.sendTimeNs);
+        }
+
+        constexpr size_t STREAMING_SEQUENCE_SIZE = 2 * sizeof(uint64_t);
+
+        /** Returns the size of the header including the StreamingSequence of the encodings which carry one */
+        inline size_t streamingHeaderSize(StreamingEncoding encoding) noexcept {
+            return encoding == StreamingEncoding_FixedLayoutV2 ? STREAMING_HEADER_SIZE + STREAMING_SEQUENCE_SIZE : STREAMING_HEADER_SIZE;
+        }
+
+        /** Monotonic clock (ns) of the send times, which processes on the same host share */
+        inline uint64_t streamingClockNs() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /** A batch payload is the number of records (uint16_t) followed by the records, see writeRecord */
+        constexpr size_t STREAMING_BATCH_COUNT_SIZE = sizeof(uint16_t);
+        constexpr size_t STREAMING_MAX_BATCH_SIZE = std::numeric_limits<uint16_t>::max();
+
+        /** Name of the message type in topics, empty if it is not streamed on its own */
+        inline std::string_view streamingTopicType(StreamingMessageType type) noexcept {
+            if (type == StreamingMessageType_ZenEventImu)
+                return "imu";
+            if (type == StreamingMessageType_ZenEventGnss)
+                return "gnss";
+
+            return {};
+        }
+
+        /** Returns the topic "<type>/<sensorTopic>/" of a sensor's messages of one type */
+        inline std::string streamingTopic(StreamingMessageType type, std::string_view sensorTopic) {
+            std::string topic(streamingTopicType(type));
+            topic += '/';
+            topic += sensorTopic;
+            topic += '/';
+            return topic;
+        }
+
+        /**
+        Returns the subscription filters for a selector of the form "<sensorTopic>" or
+        "<sensorTopic>/<type>". The sensor topic "*" selects all sensors. An empty selector
+        subscribes to all messages. Returns nothing if the selector is invalid.
+        */
+        inline std::vector<std::string> streamingSubscriptions(std::string_view selector) {
+            if (selector.empty())
+                return { std::string() };
+
+            const auto separator = selector.find('/');
+            const auto sensorTopic = selector.substr(0, separator);
+            if (sensorTopic.empty())
+                return {};
+
+            if (selector == "*")
+                return { std::string() };
+
+            if (separator == std::string_view::npos)
+                return {
+                    streamingTopic(StreamingMessageType_ZenEventImu, sensorTopic),
+                    streamingTopic(StreamingMessageType_ZenEventGnss, sensorTopic)
+                };
+
+            const auto type = selector.substr(separator + 1);
+            for (auto msgType : { StreamingMessageType_ZenEventImu, StreamingMessageType_ZenEventGnss }) {
+                if (type != streamingTopicType(msgType))
+                    continue;
+
+                if (sensorTopic == "*")
+                    return { std::string(type) + '/' };
+
+                return { streamingTopic(msgType, sensorTopic) };
+            }
+
+            return {};
+        }
+
+        /** Read-only stream over a received buffer, so cereal can decode it without a copy */
+        class SpanStreamBuffer : public std::streambuf {
         public:
-            StreamingMessagePayload payload;
-            StreamingMessageType type;
+            explicit SpanStreamBuffer(gsl::span<const std::byte> buffer) {
+                // std::streambuf only provides mutable pointers, but the get area is never written to
+                auto begin = const_cast<char*>(reinterpret_cast<const char*>(buffer.data()));
+                setg(begin, begin, begin + buffer.size());
+            }
         };
 
-        inline std::optional<ZenEvent> streamingMessageToZenEvent(StreamingMessage const& msg) {
-            ZenEvent evt;
-            if (msg.type == StreamingMessageType_ZenEventImu) {
-                evt.component.handle = msg.payload.imuData.component;
-                evt.sensor.handle = msg.payload.imuData.sensor;
-                evt.eventType = ZenEventType_ImuData;
-                evt.data.imuData = msg.payload.imuData.data;
-            }
-            else if (msg.type == StreamingMessageType_ZenEventGnss) {
-                evt.component.handle = msg.payload.gnssData.component;
-                evt.sensor.handle = msg.payload.gnssData.sensor;
-                evt.eventType = ZenEventType_GnssData;
-                evt.data.gnssData = msg.payload.gnssData.data;
-            }
-            else {
-                spdlog::error("Streaming Message not supported");
-                return std::nullopt;
+        template <class TPayload>
+        inline bool decodePayload(StreamingEncoding encoding, gsl::span<const std::byte> buffer, TPayload& outPayload) {
+            if (encoding == StreamingEncoding_FixedLayoutV1 || encoding == StreamingEncoding_FixedLayoutV2)
+                return readFixedLayout(buffer, outPayload);
+
+            if (encoding == StreamingEncoding_Cereal) {
+                SpanStreamBuffer streamBuffer(buffer);
+                std::istream payloadBuffer(&streamBuffer);
+                try {
+                    cereal::BinaryInputArchive deser_archive(payloadBuffer);
+                    deser_archive(outPayload);
+                }
+                catch (const cereal::Exception&) {
+                    return false;
+                }
+                return true;
             }
 
-            return evt;
+            spdlog::error("Zmq Streaming encoding {0} not supported", encoding);
+            return false;
         }
 
-        inline std::optional<StreamingMessage> fromZmqMessage(zmq::message_t & msg) {
-            if (msg.size() < 4) {
+        /** Returns the StreamingSequence of the message, or nothing if its encoding does not carry one */
+        inline std::optional<StreamingSequence> streamingSequence(const zmq::message_t & msg) {
+            const auto received = static_cast<const std::byte*>(msg.data());
+            if (msg.size() < streamingHeaderSize(StreamingEncoding_FixedLayoutV2) ||
+                StreamingEncoding(received[0]) != StreamingEncoding_FixedLayoutV2)
                 return std::nullopt;
-            }
 
-            auto received = std::string(static_cast<char*>(msg.data()), msg.size());
+            StreamingSequence sequence;
+            if (!readFixedLayout(gsl::make_span(received + STREAMING_HEADER_SIZE, STREAMING_SEQUENCE_SIZE), sequence))
+                return std::nullopt;
 
-            auto header = received.substr(0, 4);
-            auto payload = received.substr(4, std::string::npos);
+            return sequence;
+        }
 
-            auto msg_type = StreamingMessageType(header[3]);
+        /** Stores the StreamingSequence in the header of an encoded message. Returns false if its encoding does not carry one. */
+        inline bool setStreamingSequence(zmq::message_t & msg, const StreamingSequence& sequence) {
+            const auto buffer = static_cast<std::byte*>(msg.data());
+            if (msg.size() < streamingHeaderSize(StreamingEncoding_FixedLayoutV2) ||
+                StreamingEncoding(buffer[0]) != StreamingEncoding_FixedLayoutV2)
+                return false;
 
-            std::stringstream payloadBuffer(payload);
+            writeFixedLayout(sequence, buffer + STREAMING_HEADER_SIZE);
+            return true;
+        }
 
-            if (msg_type == StreamingMessageType_ZenEventImu) {
-                zen::Serialization::ZenEventImuSerialization imuData;
-                {
-                    cereal::BinaryInputArchive deser_archive(payloadBuffer);
-                    deser_archive(imuData);
-                }
+        /** Writes the header of a message, the sequence is set later with setStreamingSequence */
+        inline void writeStreamingHeader(StreamingEncoding encoding, StreamingMessageType msgType, std::byte* buffer) noexcept {
+            buffer[0] = std::byte(encoding);
+            buffer[1] = std::byte(0);
+            buffer[2] = std::byte(0);
+            buffer[3] = std::byte(msgType);
+            if (encoding == StreamingEncoding_FixedLayoutV2)
+                writeFixedLayout(StreamingSequence{ 0, 0 }, buffer + STREAMING_HEADER_SIZE);
+        }
 
-                StreamingMessage strMsg;
-                strMsg.payload.imuData = imuData;
-                strMsg.type = msg_type;
-                return strMsg;
+        inline std::optional<StreamingMessage> fromZmqMessage(zmq::message_t & msg) {
+            if (msg.size() < STREAMING_HEADER_SIZE) {
+                return std::nullopt;
             }
-            else if (msg_type == StreamingMessageType_ZenEventGnss) {
-                zen::Serialization::ZenEventGnssSerialization gnssData;
-                {
-                    cereal::BinaryInputArchive deser_archive(payloadBuffer);
-                    deser_archive(gnssData);
-                }
 
-                StreamingMessage strMsg;
-                strMsg.payload.gnssData = gnssData;
-                strMsg.type = msg_type;
-                return strMsg;
+            const auto received = static_cast<const std::byte*>(msg.data());
+            const auto encoding = StreamingEncoding(received[0]);
+            const auto msg_type = StreamingMessageType(received[3]);
+            const size_t headerSize = streamingHeaderSize(encoding);
+            if (msg.size() < headerSize) {
+                return std::nullopt;
+            }
+            const auto payload = gsl::make_span(received + headerSize, msg.size() - headerSize);
+
+            StreamingMessage strMsg;
+            strMsg.type = msg_type;
+            if (msg_type == StreamingMessageType_ZenEventImu) {
+                if (decodePayload(encoding, payload, strMsg.payload.imuData))
+                    return strMsg;
+            }
+            else if (msg_type == StreamingMessageType_ZenEventGnss) {
+                if (decodePayload(encoding, payload, strMsg.payload.gnssData))
+                    return strMsg;
             } else {
             spdlog::error("Zmq Streaming message of type {0} not supported", msg_type);
             }
@@ -109,14 +235,18 @@ namespace zen {
 
         template <class TPayload>
         inline void copyToZmqMessage(zen::Streaming::StreamingMessageType msgType,
-            TPayload const& payload, zmq::message_t & zmqOut) {
+            TPayload const& payload, zmq::message_t & zmqOut,
+            StreamingEncoding encoding = StreamingEncoding_FixedLayoutV1) {
 
-            // header has 4 bytes
-            std::vector<std::byte> completeBuffer;
-            completeBuffer.push_back(std::byte(0));
-            completeBuffer.push_back(std::byte(0));
-            completeBuffer.push_back(std::byte(0));
-            completeBuffer.push_back(std::byte(msgType));
+            if (encoding == StreamingEncoding_FixedLayoutV1 || encoding == StreamingEncoding_FixedLayoutV2) {
+                // the size is known up front, so the payload is encoded in place
+                const size_t headerSize = streamingHeaderSize(encoding);
+                zmqOut.rebuild(headerSize + fixedLayoutSize<TPayload>());
+                auto buffer = static_cast<std::byte*>(zmqOut.data());
+                writeStreamingHeader(encoding, msgType, buffer);
+                writeFixedLayout(payload, buffer + headerSize);
+                return;
+            }
 
             std::stringstream buffer;
             {
@@ -124,40 +254,120 @@ namespace zen {
                 ser_archive(payload);
             }
 
-            auto sBuffer = buffer.str();
-            for (auto s : sBuffer) {
-                completeBuffer.push_back(std::byte(s));
+            // header has 4 bytes
+            const auto sBuffer = buffer.str();
+            zmqOut.rebuild(STREAMING_HEADER_SIZE + sBuffer.size());
+            auto completeBuffer = static_cast<std::byte*>(zmqOut.data());
+            completeBuffer[0] = std::byte(StreamingEncoding_Cereal);
+            completeBuffer[1] = std::byte(0);
+            completeBuffer[2] = std::byte(0);
+            completeBuffer[3] = std::byte(msgType);
+            std::memcpy(completeBuffer + STREAMING_HEADER_SIZE, sBuffer.data(), sBuffer.size());
+        }
+
+        inline bool toZmqMessage(ZenEvent const& evt, zmq::message_t & zmqOut,
+            StreamingEncoding encoding = StreamingEncoding_FixedLayoutV1) {
+            const auto msgType = streamingMessageType(evt);
+            if (msgType == StreamingMessageType_ZenEventImu) {
+                copyToZmqMessage(msgType, imuSerialization(evt), zmqOut, encoding);
+                return true;
+            } else if (msgType == StreamingMessageType_ZenEventGnss) {
+                copyToZmqMessage(msgType, gnssSerialization(evt), zmqOut, encoding);
+                return true;
             }
 
-            zmqOut.rebuild(completeBuffer.data(), completeBuffer.size());
+            // message cannot be streamed
+            return false;
         }
 
-        inline bool toZmqMessage(ZenEvent const& evt, zmq::message_t & zmqOut) {
-            // todo: this needs to be refactored when the event type numbering scheme is fixed
-            // right now the component numbers for IMU and GNSS are hard-coded
-            if (evt.component.handle == 1) {
+        /**
+        Packs up to STREAMING_MAX_BATCH_SIZE events into one message of type
+        StreamingMessageType_Batch. Events which cannot be streamed are skipped.
+        Returns the number of packed events.
+        */
+        inline size_t toZmqBatchMessage(gsl::span<const ZenEvent> events, zmq::message_t & zmqOut,
+            StreamingEncoding encoding = StreamingEncoding_FixedLayoutV1) {
+            const size_t headerSize = streamingHeaderSize(encoding);
+            size_t size = headerSize + STREAMING_BATCH_COUNT_SIZE;
+            uint16_t count = 0;
+            for (const auto& evt : events) {
+                if (count == STREAMING_MAX_BATCH_SIZE)
+                    break;
 
-                zen::Serialization::ZenEventImuSerialization imuData;
-                imuData.sensor = evt.sensor.handle;
-                imuData.component = evt.component.handle;
-                imuData.data = evt.data.imuData;
+                if (const size_t eventSize = recordSize(evt)) {
+                    size += eventSize;
+                    ++count;
+                }
+            }
 
-                copyToZmqMessage(zen::Streaming::StreamingMessageType_ZenEventImu,
-                    imuData, zmqOut);
-                return true;
-            } else if (evt.component.handle == 2) {
-                zen::Serialization::ZenEventGnssSerialization gnssData;
-                gnssData.sensor = evt.sensor.handle;
-                gnssData.component = evt.component.handle;
-                gnssData.data = evt.data.gnssData;
-
-                copyToZmqMessage(zen::Streaming::StreamingMessageType_ZenEventGnss,
-                    gnssData, zmqOut);
+            // the size is known up front, so all records are encoded in place
+            zmqOut.rebuild(size);
+            auto buffer = static_cast<std::byte*>(zmqOut.data());
+            writeStreamingHeader(encoding, StreamingMessageType_Batch, buffer);
+            writeFixedLayout(count, buffer + headerSize);
+
+            auto record = buffer + headerSize + STREAMING_BATCH_COUNT_SIZE;
+            uint16_t packed = 0;
+            for (auto it = events.begin(); packed < count; ++it) {
+                if (const size_t eventSize = writeRecord(*it, record)) {
+                    record += eventSize;
+                    ++packed;
+                }
+            }
+
+            return count;
+        }
+
+        /**
+        Decodes a single or a batched message and passes every contained StreamingMessage
+        to onMessage. Returns false if the message is malformed, in which case the
+        messages before the malformed part of a batch have already been passed on.
+        */
+        template <class TOnMessage>
+        inline bool unpackZmqMessage(zmq::message_t & msg, TOnMessage&& onMessage) {
+            if (msg.size() < STREAMING_HEADER_SIZE) {
+                return false;
+            }
+
+            const auto received = static_cast<const std::byte*>(msg.data());
+            if (StreamingMessageType(received[3]) != StreamingMessageType_Batch) {
+                auto unpackedMessage = fromZmqMessage(msg);
+                if (!unpackedMessage)
+                    return false;
+
+                onMessage(*unpackedMessage);
                 return true;
             }
 
-            // message cannot be streamed
-            return false;
+            const auto encoding = StreamingEncoding(received[0]);
+            if (encoding != StreamingEncoding_FixedLayoutV1 && encoding != StreamingEncoding_FixedLayoutV2) {
+                spdlog::error("Zmq Streaming batch with encoding {0} not supported", std::to_integer<int>(received[0]));
+                return false;
+            }
+
+            const size_t headerSize = streamingHeaderSize(encoding);
+            if (msg.size() < headerSize) {
+                return false;
+            }
+
+            const auto end = received + msg.size();
+            auto record = received + headerSize;
+            uint16_t count = 0;
+            if (!readFixedLayout(gsl::make_span(record, end), count))
+                return false;
+
+            record += STREAMING_BATCH_COUNT_SIZE;
+            for (uint16_t idx = 0; idx < count; ++idx) {
+                StreamingMessage strMsg;
+                const size_t size = readRecord(record, static_cast<size_t>(end - record), strMsg);
+                if (size == 0)
+                    return false;
+
+                onMessage(strMsg);
+                record += size;
+            }
+
+            return true;
         }
     }
 }
@@ -0,0 +1,142 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "OpenZen.h"
+#include "Sensor.h"
+#include "communication/EventCommunicator.h"
+
+#include "FakeSensorProperties.h"
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace zen;
+
+namespace
+{
+    /** Properties which take a while to write, and log the order in which they were written */
+    class SlowProperties : public FakeSensorProperties
+    {
+    public:
+        SlowProperties()
+        {
+            addInt32(ZenImuProperty_SamplingRate, ZenImuProperty_SamplingRate * 10);
+            addInt32(ZenImuProperty_FilterMode, ZenImuProperty_FilterMode * 10);
+            writeDelay = std::chrono::milliseconds(10);
+        }
+    };
+
+    std::unique_ptr<Sensor> makeSensor()
+    {
+        SensorConfig config;
+        config.version = 1;
+        return std::make_unique<Sensor>(config, std::make_unique<EventCommunicator>(), 1);
+    }
+}
+
+TEST(AsyncProperties, callbackRunsWithBatchResult) {
+    auto sensor = makeSensor();
+    SlowProperties properties;
+
+    std::vector<ZenPropertyValue> values{ makeInt32Value(ZenImuProperty_SamplingRate, 0), makeInt32Value(ZenImuProperty_FilterMode, 0) };
+    std::promise<ZenError> done;
+    ASSERT_EQ(ZenError_None, sensor->getPropertiesAsync(properties, values, [&done](ZenError error) {
+        done.set_value(error);
+    }));
+
+    auto result = done.get_future();
+    ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(5)));
+    ASSERT_EQ(ZenError_None, result.get());
+    ASSERT_EQ(ZenImuProperty_SamplingRate * 10, values[0].value.int32Value);
+    ASSERT_EQ(ZenImuProperty_FilterMode * 10, values[1].value.int32Value);
+}
+
+TEST(AsyncProperties, batchesCompleteInOrder) {
+    auto sensor = makeSensor();
+    SlowProperties properties;
+
+    constexpr int32_t nBatches = 5;
+    std::vector<std::vector<ZenPropertyValue>> batches;
+    for (int32_t idx = 0; idx < nBatches; ++idx)
+        batches.push_back({ makeInt32Value(ZenImuProperty_SamplingRate, 2 * idx), makeInt32Value(ZenImuProperty_SamplingRate, 2 * idx + 1) });
+
+    std::mutex mutex;
+    std::vector<int32_t> completed;
+    std::promise<void> done;
+    for (int32_t idx = 0; idx < nBatches; ++idx)
+        ASSERT_EQ(ZenError_None, sensor->setPropertiesAsync(properties, batches[idx], [&, idx](ZenError error) {
+            ASSERT_EQ(ZenError_None, error);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            completed.emplace_back(idx);
+            if (completed.size() == nBatches)
+                done.set_value();
+        }));
+
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(std::chrono::seconds(5)));
+    ASSERT_EQ((std::vector<int32_t>{ 0, 1, 2, 3, 4 }), completed);
+
+    // the properties of a batch are written in order, and batches do not interleave
+    ASSERT_EQ((std::vector<int32_t>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }), properties.writtenInt32s);
+}
+
+TEST(AsyncProperties, queueIsDrainedOnDestruction) {
+    auto sensor = makeSensor();
+    SlowProperties properties;
+
+    constexpr int32_t nBatches = 10;
+    std::vector<std::vector<ZenPropertyValue>> batches;
+    for (int32_t idx = 0; idx < nBatches; ++idx)
+        batches.push_back({ makeInt32Value(ZenImuProperty_SamplingRate, idx) });
+
+    std::atomic_int nCompleted = 0;
+    for (auto& batch : batches)
+        ASSERT_EQ(ZenError_None, sensor->setPropertiesAsync(properties, batch, [&nCompleted](ZenError) { ++nCompleted; }));
+
+    // every queued batch is still processed, as its caller waits for the callback
+    sensor.reset();
+    ASSERT_EQ(nBatches, nCompleted);
+    ASSERT_EQ(static_cast<size_t>(nBatches), properties.writtenInt32s.size());
+}
+
+TEST(AsyncProperties, futureResolvesWithValues) {
+    std::thread worker;
+    auto future = details::AsyncProperties::queue({ makeInt32Value(ZenImuProperty_SamplingRate, 0) },
+        [&worker](ZenPropertyValue* data, size_t size, ZenPropertiesCallback callback, void* userData) {
+            worker = std::thread([=]() {
+                data[0].value.int32Value = 400;
+                callback(ZenError_None, data, size, userData);
+            });
+            return ZenError_None;
+        });
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+    worker.join();
+
+    auto [error, values] = future.get();
+    ASSERT_EQ(ZenError_None, error);
+    ASSERT_EQ(1u, values.size());
+    ASSERT_EQ(400, values[0].value.int32Value);
+}
+
+TEST(AsyncProperties, futureResolvesIfQueueingFails) {
+    auto future = details::AsyncProperties::queue({ makeInt32Value(ZenImuProperty_SamplingRate, 0) },
+        [](ZenPropertyValue*, size_t, ZenPropertiesCallback, void*) {
+            return ZenError_InvalidSensorHandle;
+        });
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+    ASSERT_EQ(ZenError_InvalidSensorHandle, future.get().first);
+}
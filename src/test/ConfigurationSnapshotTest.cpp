@@ -0,0 +1,148 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "ConfigurationSnapshot.h"
+#include "InternalTypes.h"
+#include "communication/SyncedModbusCommunicator.h"
+#include "properties/LegacyCoreProperties.h"
+
+#include "FakeSensorProperties.h"
+#include "communication/MockbusCommunicator.h"
+
+#include <cstring>
+#include <limits>
+
+using namespace zen;
+
+namespace
+{
+    /** IMU properties with a sampling rate, an alignment matrix and the streaming state */
+    class FakeImuProperties : public FakeSensorProperties
+    {
+    public:
+        FakeImuProperties()
+        {
+            addFloatArray(ZenImuProperty_AccAlignment, { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f });
+            addInt32(ZenImuProperty_SamplingRate, 100);
+            addBool(ZenImuProperty_StreamData, true);
+
+            // constant, without a value
+            types[ZenImuProperty_SupportedSamplingRates] = ZenPropertyType_Int32;
+            constants.insert(ZenImuProperty_SupportedSamplingRates);
+        }
+    };
+
+    /** Answers the requests of the legacy protocol, acknowledgements and uint32 results */
+    class LegacySubscriber : public IModbusFrameSubscriber
+    {
+    public:
+        ZenError processReceivedData(uint8_t, uint8_t function, gsl::span<const std::byte> data) noexcept override
+        {
+            if (function == static_cast<uint8_t>(EDevicePropertyV0::Ack))
+                return communicator->publishAck(ZenSensorProperty_Invalid, ZenError_None);
+
+            uint32_t result;
+            std::memcpy(&result, data.data(), sizeof(result));
+            return communicator->publishResult(function, ZenError_None, result);
+        }
+
+        SyncedModbusCommunicator* communicator = nullptr;
+    };
+
+    std::vector<std::byte> uint32Reply(uint32_t value)
+    {
+        std::vector<std::byte> reply(sizeof(value));
+        std::memcpy(reply.data(), &value, sizeof(value));
+        return reply;
+    }
+}
+
+TEST(ConfigurationSnapshot, roundTripRestoresSettings) {
+    FakeImuProperties source;
+    source.arrays[ZenImuProperty_AccAlignment] = { 0.f, 1.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, -1.f };
+    source.ints[ZenImuProperty_SamplingRate] = 400;
+
+    auto section = readConfigurationSection(source, g_zenSensorType_Imu, 1);
+    ASSERT_TRUE(section);
+    // streaming and constant properties are not part of the configuration
+    ASSERT_EQ(2u, section->settings.size());
+
+    const auto blob = serializeConfiguration(ConfigurationSnapshot{ 2, { *section } });
+    ASSERT_TRUE(blob);
+    auto snapshot = deserializeConfiguration(*blob);
+    ASSERT_TRUE(snapshot);
+    ASSERT_EQ(2u, snapshot->version);
+    ASSERT_EQ(1u, snapshot->sections.size());
+    ASSERT_EQ(g_zenSensorType_Imu, snapshot->sections[0].type);
+    ASSERT_EQ(1u, snapshot->sections[0].version);
+
+    FakeImuProperties target;
+    ASSERT_EQ(ZenError_None, applyConfigurationSection(target, snapshot->sections[0]));
+    ASSERT_EQ(source.arrays[ZenImuProperty_AccAlignment], target.arrays[ZenImuProperty_AccAlignment]);
+    ASSERT_EQ(400, target.ints[ZenImuProperty_SamplingRate]);
+}
+
+TEST(ConfigurationSnapshot, rejectsCorruptBlobs) {
+    FakeImuProperties source;
+    auto section = readConfigurationSection(source, g_zenSensorType_Imu, 1);
+    ASSERT_TRUE(section);
+
+    auto blob = serializeConfiguration(ConfigurationSnapshot{ 2, { *section } });
+    ASSERT_TRUE(blob);
+    ASSERT_FALSE(deserializeConfiguration(gsl::make_span(blob->data(), blob->size() - 1)));
+
+    (*blob)[0] = std::byte{ 'X' };
+    ASSERT_EQ(ZenError_InvalidArgument, deserializeConfiguration(*blob).error());
+}
+
+TEST(ConfigurationSnapshot, roundTripCoreSection) {
+    const auto getTimeOffset = static_cast<uint8_t>(EDevicePropertyV0::GetPing);
+    const auto setTimeOffset = static_cast<uint8_t>(EDevicePropertyV0::SetTimestamp);
+    const auto ack = static_cast<uint8_t>(EDevicePropertyV0::Ack);
+
+    LegacySubscriber subscriber;
+    MockbusCommunicator::RepliesVector replies{ { 0, getTimeOffset, getTimeOffset, uint32Reply(1234) }, { 0, setTimeOffset, ack, {} } };
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, replies));
+    subscriber.communicator = &communicator;
+
+    FakeImuProperties imu;
+    imu.bools[ZenImuProperty_StreamData] = false;
+    LegacyCoreProperties core(communicator, imu);
+
+    auto section = readConfigurationSection(core, {}, 0);
+    ASSERT_TRUE(section);
+    // identifiers, the connection and the battery state are not part of the configuration
+    ASSERT_EQ(1u, section->settings.size());
+    ASSERT_EQ(ZenSensorProperty_TimeOffset, section->settings[0].first);
+    ASSERT_EQ(SensorPropertySetting(int32_t(1234)), section->settings[0].second);
+
+    const auto blob = serializeConfiguration(ConfigurationSnapshot{ 0, { *section } });
+    ASSERT_TRUE(blob);
+    auto snapshot = deserializeConfiguration(*blob);
+    ASSERT_TRUE(snapshot);
+
+    // every captured property can be written again
+    ASSERT_EQ(ZenError_None, applyConfigurationSection(core, snapshot->sections[0]));
+}
+
+TEST(ConfigurationSnapshot, rejectsOversizedSnapshots) {
+    ConfigurationSection section{ g_zenSensorType_Imu, 1, {} };
+    section.settings.emplace_back(ZenImuProperty_AccAlignment, std::vector<std::byte>(std::numeric_limits<uint16_t>::max() + 1));
+    ASSERT_EQ(ZenError_InvalidArgument, serializeConfiguration(ConfigurationSnapshot{ 2, { section } }).error());
+
+    section.settings.clear();
+    section.type.assign(std::numeric_limits<uint8_t>::max() + 1, 'x');
+    ASSERT_EQ(ZenError_InvalidArgument, serializeConfiguration(ConfigurationSnapshot{ 2, { section } }).error());
+
+    ConfigurationSnapshot snapshot{ 2, std::vector<ConfigurationSection>(std::numeric_limits<uint8_t>::max() + 1) };
+    ASSERT_EQ(ZenError_InvalidArgument, serializeConfiguration(snapshot).error());
+}
@@ -0,0 +1,175 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_FAKESENSORPROPERTIES_H_
+#define ZEN_FAKESENSORPROPERTIES_H_
+
+#include "ISensorProperties.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace zen
+{
+    /**
+    Properties which keep their values in memory instead of talking to a sensor.
+
+    Only declared properties exist, see addInt32, addBool and addFloatArray. A declared
+    property can be set even after its value was erased, e.g. to simulate a sensor which
+    lost its configuration. Every write is notified, so restoreSettings can reapply it.
+    */
+    class FakeSensorProperties : public ISensorProperties
+    {
+    public:
+        void addInt32(ZenProperty_t property, int32_t value)
+        {
+            types[property] = ZenPropertyType_Int32;
+            ints[property] = value;
+        }
+
+        void addBool(ZenProperty_t property, bool value)
+        {
+            types[property] = ZenPropertyType_Bool;
+            bools[property] = value;
+        }
+
+        void addFloatArray(ZenProperty_t property, std::vector<float> values)
+        {
+            types[property] = ZenPropertyType_Float;
+            arrayProperties.insert(property);
+            arrays[property] = std::move(values);
+        }
+
+        ZenError execute(ZenProperty_t) noexcept override { return ZenError_UnknownProperty; }
+
+        std::pair<ZenError, size_t> getArray(ZenProperty_t property, ZenPropertyType, gsl::span<std::byte> buffer) noexcept override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = arrays.find(property);
+            if (it == arrays.end())
+                return std::make_pair(ZenError_UnknownProperty, 0);
+
+            // Arrays are passed with their number of elements
+            if (static_cast<size_t>(buffer.size()) < it->second.size())
+                return std::make_pair(ZenError_BufferTooSmall, it->second.size());
+
+            std::memcpy(buffer.data(), it->second.data(), it->second.size() * sizeof(float));
+            return std::make_pair(ZenError_None, it->second.size());
+        }
+
+        ZenError setArray(ZenProperty_t property, ZenPropertyType, gsl::span<const std::byte> buffer) noexcept override
+        {
+            if (!isArray(property))
+                return ZenError_UnknownProperty;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const auto values = reinterpret_cast<const float*>(buffer.data());
+                arrays[property].assign(values, values + buffer.size());
+            }
+
+            notifyPropertyChange(property, buffer);
+            return ZenError_None;
+        }
+
+        nonstd::expected<bool, ZenError> getBool(ZenProperty_t property) noexcept override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = bools.find(property);
+            if (it == bools.end())
+                return nonstd::make_unexpected(ZenError_UnknownProperty);
+            return it->second;
+        }
+
+        ZenError setBool(ZenProperty_t property, bool value) noexcept override
+        {
+            if (type(property) != ZenPropertyType_Bool || isArray(property))
+                return ZenError_UnknownProperty;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                bools[property] = value;
+            }
+
+            notifyPropertyChange(property, value);
+            return ZenError_None;
+        }
+
+        nonstd::expected<int32_t, ZenError> getInt32(ZenProperty_t property) noexcept override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = ints.find(property);
+            if (it == ints.end())
+                return nonstd::make_unexpected(ZenError_UnknownProperty);
+            return it->second;
+        }
+
+        ZenError setInt32(ZenProperty_t property, int32_t value) noexcept override
+        {
+            if (type(property) != ZenPropertyType_Int32 || isArray(property))
+                return ZenError_UnknownProperty;
+
+            std::this_thread::sleep_for(writeDelay);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ints[property] = value;
+                writtenInt32s.emplace_back(value);
+            }
+
+            notifyPropertyChange(property, value);
+            return ZenError_None;
+        }
+
+        bool isArray(ZenProperty_t property) const noexcept override { return arrayProperties.count(property) != 0; }
+
+        bool isConstant(ZenProperty_t property) const noexcept override { return constants.count(property) != 0; }
+
+        ZenPropertyType type(ZenProperty_t property) const noexcept override
+        {
+            auto it = types.find(property);
+            return it != types.cend() ? it->second : ZenPropertyType_Invalid;
+        }
+
+        /** Declared properties. Arrays always have float elements. */
+        std::map<ZenProperty_t, ZenPropertyType> types;
+        std::set<ZenProperty_t> arrayProperties;
+        std::set<ZenProperty_t> constants;
+
+        /** Current values, which require the mutex while the properties are used from several threads */
+        std::map<ZenProperty_t, std::vector<float>> arrays;
+        std::map<ZenProperty_t, bool> bools;
+        std::map<ZenProperty_t, int32_t> ints;
+
+        /** The int32 values in the order they were written */
+        std::vector<int32_t> writtenInt32s;
+
+        /** Time every int32 write takes, e.g. to let writes of several threads overlap */
+        std::chrono::milliseconds writeDelay{ 0 };
+
+        std::mutex mutex;
+    };
+
+    inline ZenPropertyValue makeInt32Value(ZenProperty_t property, int32_t value)
+    {
+        ZenPropertyValue result{};
+        result.property = property;
+        result.type = ZenPropertyType_Int32;
+        result.value.int32Value = value;
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,265 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "InternalTypes.h"
+#include "Sensor.h"
+#include "communication/NegotiationCache.h"
+#include "utility/LockingQueue.h"
+
+#include "communication/MockbusCommunicator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace zen;
+
+namespace
+{
+    constexpr size_t PAGE_SIZE = 255;
+    constexpr size_t N_PAGES = 10;
+
+    /** Number of pages the sensor keeps in flight, see UPLOAD_WINDOW */
+    constexpr size_t UPLOAD_WINDOW = 4;
+
+    /** Answers the frames of the legacy protocol in order on its own thread, like a sensor behind a serial link,
+        so several pages can be in flight. Rejects the pages it is told to. */
+    class UploadCommunicator : public ModbusCommunicator
+    {
+    public:
+        UploadCommunicator(IModbusFrameSubscriber& subscriber, std::function<bool(size_t)> rejectPage) noexcept
+            : ModbusCommunicator(subscriber, std::make_unique<DummyFrameFactory>(), std::make_unique<DummyFrameParser>())
+            , m_rejectPage(std::move(rejectPage))
+            , m_responder(&UploadCommunicator::respond, this)
+        {}
+
+        ~UploadCommunicator()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_terminate = true;
+            }
+            m_cv.notify_all();
+            m_responder.join();
+        }
+
+        ZenError send(uint8_t address, uint8_t, gsl::span<const std::byte> data) noexcept override
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // every update starts with the page count, after which the sensor expects the first page
+            const bool isPage = data.size() == PAGE_SIZE;
+            if (isPage)
+            {
+                ++m_nSentPages;
+                maxPagesInFlight = std::max(maxPagesInFlight, m_nSentPages - m_nAnsweredPages);
+            }
+            else
+            {
+                pagesInFlightAtPageCount.emplace_back(m_nSentPages - m_nAnsweredPages);
+            }
+
+            m_frames.emplace_back(address, isPage);
+            m_cv.notify_all();
+            return ZenError_None;
+        }
+
+        /** Most pages which were sent, but not answered yet */
+        size_t maxPagesInFlight = 0;
+
+        /** Pages which were sent, but not answered yet, whenever a page count was sent */
+        std::vector<size_t> pagesInFlightAtPageCount;
+
+        /** Pages which were sent after a rejected page, but not answered yet, when it was rejected */
+        std::vector<size_t> pagesInFlightAtRejection;
+
+    private:
+        void respond()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_cv.wait(lock, [this]() { return m_terminate || !m_frames.empty(); });
+                if (m_terminate)
+                    return;
+
+                lock.unlock();
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                lock.lock();
+
+                const auto [address, isPage] = m_frames.front();
+                m_frames.pop_front();
+
+                bool rejected = false;
+                if (isPage)
+                {
+                    ++m_nAnsweredPages;
+                    rejected = m_rejectPage(m_nextPage++);
+                    if (rejected)
+                        pagesInFlightAtRejection.emplace_back(m_nSentPages - m_nAnsweredPages);
+                }
+                else
+                {
+                    m_nextPage = 0;
+                }
+
+                // pages are counted as answered before the reply, which completes the request
+                lock.unlock();
+                const auto reply = rejected ? EDevicePropertyV0::Nack : EDevicePropertyV0::Ack;
+                m_subscriber->processReceivedData(address, static_cast<uint8_t>(reply), {});
+                lock.lock();
+            }
+        }
+
+        std::function<bool(size_t)> m_rejectPage;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::pair<uint8_t, bool>> m_frames;
+        size_t m_nextPage = 0;
+        size_t m_nSentPages = 0;
+        size_t m_nAnsweredPages = 0;
+        bool m_terminate = false;
+
+        std::thread m_responder;
+    };
+
+    class NoSubscriber : public IModbusFrameSubscriber
+    {
+    public:
+        ZenError processReceivedData(uint8_t, uint8_t, gsl::span<const std::byte>) noexcept override { return ZenError_None; }
+    };
+
+    struct Upload
+    {
+        /** All progress events, of which the last one completed the update */
+        std::vector<ZenEventData_UpdateProgress> progress;
+
+        size_t maxPagesInFlight;
+        std::vector<size_t> pagesInFlightAtPageCount;
+        std::vector<size_t> pagesInFlightAtRejection;
+
+        const ZenEventData_UpdateProgress& result() const { return progress.back(); }
+    };
+
+    /** Uploads firmware of nPages pages and returns its progress, once the update completed */
+    std::optional<Upload> upload(std::function<bool(size_t)> rejectPage, std::string serialNumber = "", size_t nPages = N_PAGES)
+    {
+        NoSubscriber subscriber;
+        auto communicator = std::make_unique<UploadCommunicator>(subscriber, std::move(rejectPage));
+        const auto& uploadCommunicator = *communicator;
+
+        // The sensor reports its disconnection when it is destroyed, so the queue has to outlive it
+        LockingQueue<ZenEvent> events;
+
+        SensorConfig config;
+        config.version = 0;
+        Sensor sensor(config, std::move(communicator), 1);
+        sensor.setSerialNumber(std::move(serialNumber));
+        sensor.subscribe(events);
+
+        const std::vector<std::byte> firmware(nPages * PAGE_SIZE);
+        if (sensor.updateFirmwareAsync(firmware) != ZenAsync_Updating)
+            return std::nullopt;
+
+        Upload result;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (auto event = events.waitToPopUntil(deadline))
+        {
+            if (event->eventType != ZenEventType_UpdateProgress)
+                continue;
+
+            result.progress.emplace_back(event->data.updateProgress);
+            if (event->data.updateProgress.complete)
+            {
+                // every frame has been answered at this point
+                result.maxPagesInFlight = uploadCommunicator.maxPagesInFlight;
+                result.pagesInFlightAtPageCount = uploadCommunicator.pagesInFlightAtPageCount;
+                result.pagesInFlightAtRejection = uploadCommunicator.pagesInFlightAtRejection;
+                return result;
+            }
+        }
+
+        return std::nullopt;
+    }
+}
+
+TEST(FirmwareUpload, rejectedPageRestartsUpdate) {
+    bool rejected = false;
+    auto update = upload([&rejected](size_t page) {
+        return page == 2 && !std::exchange(rejected, true);
+    });
+    ASSERT_TRUE(update.has_value());
+    const auto& progress = update->result();
+    ASSERT_EQ(ZenError_None, progress.error);
+    ASSERT_EQ(N_PAGES, progress.pagesTotal);
+    ASSERT_EQ(N_PAGES, progress.pagesWritten);
+    ASSERT_EQ(1u, progress.retries);
+}
+
+TEST(FirmwareUpload, rejectedPageDrainsWindowBeforeRestart) {
+    bool rejected = false;
+    auto update = upload([&rejected](size_t page) {
+        return page == 2 && !std::exchange(rejected, true);
+    });
+    ASSERT_TRUE(update.has_value());
+    ASSERT_EQ(ZenError_None, update->result().error);
+
+    // the window is filled, but never exceeded
+    ASSERT_EQ(UPLOAD_WINDOW, update->maxPagesInFlight);
+
+    // the pages behind the rejected one are answered before the update starts over
+    ASSERT_EQ(1u, update->pagesInFlightAtRejection.size());
+    ASSERT_GE(update->pagesInFlightAtRejection.front(), 1u);
+    ASSERT_EQ(std::vector<size_t>({ 0, 0 }), update->pagesInFlightAtPageCount);
+}
+
+TEST(FirmwareUpload, reportsProgressEveryPercent) {
+    constexpr size_t nPages = 250;
+    auto update = upload([](size_t) { return false; }, "", nPages);
+    ASSERT_TRUE(update.has_value());
+    ASSERT_EQ(ZenError_None, update->result().error);
+    ASSERT_EQ(nPages, update->result().pagesWritten);
+
+    // once before the first page, once per percent and once on completion
+    ASSERT_EQ(102u, update->progress.size());
+    ASSERT_EQ(0u, update->progress.front().pagesWritten);
+    for (size_t idx = 1; idx + 1 < update->progress.size(); ++idx)
+        ASSERT_EQ(idx, update->progress[idx].pagesWritten * 100 / nPages);
+}
+
+TEST(FirmwareUpload, repeatedlyRejectedPageFails) {
+    auto update = upload([](size_t page) { return page == 0; });
+    ASSERT_TRUE(update.has_value());
+    const auto& progress = update->result();
+    ASSERT_EQ(ZenError_FW_FunctionFailed, progress.error);
+    ASSERT_EQ(0u, progress.pagesWritten);
+    ASSERT_EQ(2u, progress.retries);
+}
+
+TEST(FirmwareUpload, invalidatesCachedNegotiation) {
+    const std::string serialNumber = "lpmsig1000456";
+    NegotiationCache::get().store(serialNumber, { SensorConfig{ 0, { ComponentConfig{0, g_zenSensorType_Imu} } }, "" });
+
+    auto update = upload([](size_t) { return false; }, serialNumber);
+    ASSERT_TRUE(update.has_value());
+    ASSERT_EQ(ZenError_None, update->result().error);
+    ASSERT_FALSE(NegotiationCache::get().find(serialNumber));
+}
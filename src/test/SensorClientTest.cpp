@@ -0,0 +1,68 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "SensorClient.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace zen;
+
+namespace
+{
+    ZenSensorDesc makeDesc(const char* ioType, const char* identifier)
+    {
+        ZenSensorDesc desc{};
+        std::strncpy(desc.ioType, ioType, sizeof(desc.ioType) - 1);
+        std::strncpy(desc.identifier, identifier, sizeof(desc.identifier) - 1);
+        return desc;
+    }
+
+    /** Collects the SensorObtained events which arrive before the timeout */
+    std::vector<ZenEventData_SensorObtained> waitForObtained(SensorClient& client, size_t count)
+    {
+        std::vector<ZenEventData_SensorObtained> obtained;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (obtained.size() < count && std::chrono::steady_clock::now() < deadline)
+        {
+            if (auto event = client.pollNextEvent())
+            {
+                if (event->eventType == ZenEventType_SensorObtained)
+                    obtained.emplace_back(event->data.sensorObtained);
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+
+        return obtained;
+    }
+}
+
+TEST(SensorClient, duplicateObtainReceivesEvent) {
+    SensorClient client(1);
+
+    // the IO system does not exist, so both descriptions fail without touching any device
+    const auto desc = makeDesc("NoSuchIoSystem", "sensor1");
+    client.obtainAsync({ desc, desc });
+
+    const auto obtained = waitForObtained(client, 2);
+    ASSERT_EQ(2, obtained.size());
+    for (const auto& event : obtained)
+    {
+        ASSERT_EQ(ZenSensorInitError_UnsupportedIoType, event.error);
+        ASSERT_STREQ("sensor1", event.desc.identifier);
+    }
+}
@@ -0,0 +1,212 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "FakeSensorProperties.h"
+#include "SensorProperties.h"
+#include "communication/MockbusCommunicator.h"
+#include "properties/CorePropertyRulesV1.h"
+#include "properties/ImuPropertyRulesV1.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace zen;
+
+namespace
+{
+    /** Properties which only remember the values they have been set to */
+    class FakeProperties : public FakeSensorProperties
+    {
+    public:
+        FakeProperties()
+        {
+            types[ZenImuProperty_SamplingRate] = ZenPropertyType_Int32;
+            types[ZenImuProperty_StreamData] = ZenPropertyType_Bool;
+            types[ZenImuProperty_AccAlignment] = ZenPropertyType_Float;
+            arrayProperties.insert(ZenImuProperty_AccAlignment);
+        }
+    };
+
+    class SilentSubscriber : public IModbusFrameSubscriber
+    {
+    public:
+        ZenError processReceivedData(uint8_t, uint8_t, gsl::span<const std::byte>) noexcept override
+        {
+            return ZenError_None;
+        }
+    };
+
+    /** Counts the requests, which are answered by the test */
+    class CountingCommunicator : public ModbusCommunicator
+    {
+    public:
+        CountingCommunicator(IModbusFrameSubscriber& subscriber) noexcept
+            : ModbusCommunicator(subscriber, std::make_unique<DummyFrameFactory>(), std::make_unique<DummyFrameParser>())
+        {}
+
+        ZenError send(uint8_t, uint8_t, gsl::span<const std::byte>) noexcept override
+        {
+            ++nSent;
+            return ZenError_None;
+        }
+
+        std::atomic<size_t> nSent{ 0 };
+    };
+
+    bool waitForRequests(const std::atomic<size_t>& nSent, size_t count)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (nSent < count && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        return nSent == count;
+    }
+}
+
+TEST(SensorProperties, restoreSettingsReappliesLastValues) {
+    FakeProperties properties;
+    const std::vector<float> alignment{ 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
+
+    properties.setInt32(ZenImuProperty_SamplingRate, 100);
+    properties.setInt32(ZenImuProperty_SamplingRate, 400);
+    properties.setBool(ZenImuProperty_StreamData, true);
+    properties.setArray(ZenImuProperty_AccAlignment, ZenPropertyType_Float,
+        gsl::make_span(reinterpret_cast<const std::byte*>(alignment.data()), alignment.size()));
+
+    // the sensor forgets its configuration, e.g. after it was power cycled
+    properties.arrays.clear();
+    properties.bools.clear();
+    properties.ints.clear();
+
+    ASSERT_EQ(ZenError_None, properties.restoreSettings());
+    ASSERT_EQ(400, properties.ints[ZenImuProperty_SamplingRate]);
+    ASSERT_TRUE(properties.bools[ZenImuProperty_StreamData]);
+    ASSERT_EQ(alignment, properties.arrays[ZenImuProperty_AccAlignment]);
+}
+
+TEST(SensorProperties, batchEntriesDispatchOnType) {
+    FakeProperties properties;
+    const std::vector<float> alignment{ 0.f, 1.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+
+    std::vector<ZenPropertyValue> values(3);
+    values[0].property = ZenImuProperty_SamplingRate;
+    values[0].type = ZenPropertyType_Int32;
+    values[0].value.int32Value = 200;
+    values[1].property = ZenImuProperty_StreamData;
+    values[1].type = ZenPropertyType_Bool;
+    values[1].value.boolValue = true;
+    values[2].property = ZenImuProperty_AccAlignment;
+    values[2].type = ZenPropertyType_Float;
+    values[2].buffer = const_cast<float*>(alignment.data());
+    values[2].bufferSize = alignment.size();
+
+    for (const auto& value : values)
+        ASSERT_EQ(ZenError_None, properties.set(value));
+
+    ASSERT_EQ(200, properties.ints[ZenImuProperty_SamplingRate]);
+    ASSERT_TRUE(properties.bools[ZenImuProperty_StreamData]);
+    ASSERT_EQ(alignment, properties.arrays[ZenImuProperty_AccAlignment]);
+
+    ZenPropertyValue samplingRate{};
+    samplingRate.property = ZenImuProperty_SamplingRate;
+    samplingRate.type = ZenPropertyType_Int32;
+    ASSERT_EQ(ZenError_None, properties.get(samplingRate));
+    ASSERT_EQ(200, samplingRate.value.int32Value);
+
+    ZenPropertyValue unknown{};
+    unknown.property = ZenImuProperty_GyrRange;
+    unknown.type = ZenPropertyType_Int32;
+    ASSERT_EQ(ZenError_UnknownProperty, properties.get(unknown));
+}
+
+TEST(SensorProperties, executeWaitsForBusySensor) {
+    SilentSubscriber subscriber;
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, MockbusCommunicator::RepliesVector()));
+    SensorProperties<CorePropertyRulesV1> properties(0, communicator);
+
+    // quick replies shorten the adaptive timeout to its minimum
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto request = communicator.sendRequest(0, 1, 1, {}, true);
+        ASSERT_TRUE(request);
+        ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+        ASSERT_EQ(ZenError_None, communicator.wait(**request));
+    }
+    ASSERT_EQ(RoundTripStatistics::MIN_TIMEOUT.count(), communicator.roundTripStatistics().timeout);
+
+    auto result = std::async(std::launch::async, [&properties]() {
+        return properties.execute(ZenSensorProperty_StoreSettingsInFlash);
+    });
+
+    // writing the flash takes longer than the adaptive timeout
+    std::this_thread::sleep_for(RoundTripStatistics::MIN_TIMEOUT * 2);
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_StoreSettingsInFlash, ZenError_None));
+    ASSERT_EQ(ZenError_None, result.get());
+}
+
+TEST(SensorProperties, batchSendsAllRequestsBeforeWaiting) {
+    SilentSubscriber subscriber;
+    auto counting = std::make_unique<CountingCommunicator>(subscriber);
+    const auto& nSent = counting->nSent;
+    SyncedModbusCommunicator communicator(std::move(counting));
+    SensorProperties<ImuPropertyRulesV1> properties(0, communicator);
+
+    std::vector<float> bias(3);
+    std::vector<ZenPropertyValue> values(3);
+    values[0].property = ZenImuProperty_FilterMode;
+    values[0].type = ZenPropertyType_Int32;
+    values[1].property = ZenImuProperty_GyrUseAutoCalibration;
+    values[1].type = ZenPropertyType_Bool;
+    values[2].property = ZenImuProperty_AccBias;
+    values[2].type = ZenPropertyType_Float;
+    values[2].buffer = bias.data();
+    values[2].bufferSize = bias.size();
+
+    auto result = std::async(std::launch::async, [&properties, &values]() {
+        return properties.batch(values, false);
+    });
+
+    // all requests are on their way before the first reply arrives
+    ASSERT_TRUE(waitForRequests(nSent, 3));
+    const std::vector<float> sensorBias{ 0.1f, 0.2f, 0.3f };
+    ASSERT_EQ(ZenError_None, communicator.publishResult<int32_t>(ZenImuProperty_FilterMode, ZenError_None, 2));
+    ASSERT_EQ(ZenError_None, communicator.publishResult<bool>(ZenImuProperty_GyrUseAutoCalibration, ZenError_None, true));
+    ASSERT_EQ(ZenError_None, communicator.publishArray(ZenImuProperty_AccBias, ZenError_None, gsl::make_span(sensorBias.data(), sensorBias.size())));
+
+    ASSERT_EQ(ZenError_None, result.get());
+    ASSERT_EQ(2, values[0].value.int32Value);
+    ASSERT_TRUE(values[1].value.boolValue);
+    ASSERT_EQ(sensorBias, bias);
+
+    int32_t notifiedFilterMode = 0;
+    properties.subscribeToPropertyChanges(ZenImuProperty_FilterMode, [&notifiedFilterMode](SensorPropertyValue value) {
+        notifiedFilterMode = std::get<int32_t>(value);
+    });
+
+    values[0].value.int32Value = 1;
+    values[1].value.boolValue = false;
+    result = std::async(std::launch::async, [&properties, &values]() {
+        return properties.batch(gsl::make_span(values.data(), 2), true);
+    });
+
+    // the sensor refuses the second property, which only fails that entry
+    ASSERT_TRUE(waitForRequests(nSent, 5));
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_FW_FunctionFailed));
+
+    ASSERT_EQ(ZenError_FW_FunctionFailed, result.get());
+    ASSERT_EQ(ZenError_None, values[0].error);
+    ASSERT_EQ(ZenError_FW_FunctionFailed, values[1].error);
+    ASSERT_EQ(1, notifiedFilterMode);
+}
@@ -0,0 +1,390 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "InternalTypes.h"
+#include "Sensor.h"
+#include "SensorManager.h"
+#include "communication/Modbus.h"
+#include "communication/NegotiationCache.h"
+#include "io/IIoSystem.h"
+#include "io/IoManager.h"
+#include "utility/LockingQueue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace zen;
+
+namespace
+{
+    constexpr std::chrono::milliseconds DATA_INTERVAL(5);
+
+    struct ReceivedFrame
+    {
+        uint8_t function;
+        std::vector<std::byte> data;
+    };
+
+    class FlakySensorSystem;
+
+    /** Emulates a legacy sensor with a single IMU component, which streams frame counts once it is told to */
+    class LegacySensorInterface : public IIoInterface
+    {
+    public:
+        LegacySensorInterface(IIoDataSubscriber& subscriber, FlakySensorSystem& system);
+        ~LegacySensorInterface();
+
+        ZenError send(gsl::span<const std::byte> data) noexcept override;
+
+        nonstd::expected<int32_t, ZenError> baudRate() const noexcept override { return 921600; }
+        ZenError setBaudRate(unsigned int) noexcept override { return ZenError_None; }
+        nonstd::expected<std::vector<int32_t>, ZenError> supportedBaudRates() const noexcept override { return std::vector<int32_t>{ 921600 }; }
+        std::string_view type() const noexcept override;
+        bool equals(const ZenSensorDesc& desc) const noexcept override;
+
+        /** Stops answering and reports the lost connection from the IO thread */
+        void disconnect() noexcept;
+
+    private:
+        void run() noexcept;
+
+        void reply(const modbus::Frame& request) noexcept;
+
+        FlakySensorSystem& m_system;
+        std::unique_ptr<modbus::IFrameParser> m_parser = modbus::make_parser(modbus::ModbusFormat::LP);
+        std::unique_ptr<modbus::IFrameFactory> m_factory = modbus::make_factory(modbus::ModbusFormat::LP);
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<modbus::Frame> m_requests;
+        uint32_t m_frameCount = 0;
+        bool m_streaming = false;
+        bool m_disconnected = false;
+        bool m_terminate = false;
+        std::thread m_thread;
+    };
+
+    /** Hands out legacy sensors, of which the next obtains can be made to fail after a disconnect */
+    class FlakySensorSystem : public IIoSystem
+    {
+    public:
+        constexpr static const char KEY[] = "FlakySensor";
+
+        bool available() override { return true; }
+
+        ZenError listDevices(std::vector<ZenSensorDesc>&) override { return ZenError_None; }
+
+        nonstd::expected<std::unique_ptr<IIoInterface>, ZenSensorInitError> obtain(const ZenSensorDesc&, IIoDataSubscriber& subscriber) noexcept override
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_attempts.emplace_back(std::chrono::steady_clock::now());
+            if (m_failures > 0)
+            {
+                --m_failures;
+                return nonstd::make_unexpected(ZenSensorInitError_ConnectFailed);
+            }
+
+            // Only the frames of the latest connection are of interest
+            m_frames.clear();
+            auto ioInterface = std::make_unique<LegacySensorInterface>(subscriber, *this);
+            m_interface = ioInterface.get();
+            return std::move(ioInterface);
+        }
+
+        /** Drops the connection of the sensor, after which the next obtains fail */
+        void disconnect(unsigned int failures) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_failures = failures;
+            m_attempts.clear();
+            if (m_interface)
+                m_interface->disconnect();
+        }
+
+        /** Times of the obtains since the last disconnect */
+        std::vector<std::chrono::steady_clock::time_point> attempts() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_attempts;
+        }
+
+        /** Frames which were sent to the sensor since it was last obtained */
+        std::vector<ReceivedFrame> frames() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_frames;
+        }
+
+        void received(const ReceivedFrame& frame)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_frames.emplace_back(frame);
+        }
+
+        void released(LegacySensorInterface* ioInterface)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_interface == ioInterface)
+                m_interface = nullptr;
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        LegacySensorInterface* m_interface = nullptr;
+        unsigned int m_failures = 0;
+        std::vector<std::chrono::steady_clock::time_point> m_attempts;
+        std::vector<ReceivedFrame> m_frames;
+    };
+
+    LegacySensorInterface::LegacySensorInterface(IIoDataSubscriber& subscriber, FlakySensorSystem& system)
+        : IIoInterface(subscriber)
+        , m_system(system)
+        , m_thread(&LegacySensorInterface::run, this)
+    {}
+
+    LegacySensorInterface::~LegacySensorInterface()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_terminate = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+        m_system.released(this);
+    }
+
+    ZenError LegacySensorInterface::send(gsl::span<const std::byte> data) noexcept
+    {
+        // Frames are only sent by one thread at a time, which is the only user of the parser
+        std::vector<modbus::Frame> requests;
+        while (!data.empty())
+        {
+            if (modbus::FrameParseError_None != m_parser->parse(data))
+                return ZenError_Io_MsgCorrupt;
+
+            if (m_parser->finished())
+            {
+                requests.emplace_back(m_parser->frame());
+                m_parser->reset();
+            }
+        }
+
+        for (const auto& request : requests)
+            m_system.received({ request.function, request.data });
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.insert(m_requests.end(), requests.begin(), requests.end());
+        }
+        m_cv.notify_all();
+        return ZenError_None;
+    }
+
+    std::string_view LegacySensorInterface::type() const noexcept
+    {
+        return FlakySensorSystem::KEY;
+    }
+
+    bool LegacySensorInterface::equals(const ZenSensorDesc& desc) const noexcept
+    {
+        return std::string_view(FlakySensorSystem::KEY) == desc.ioType;
+    }
+
+    void LegacySensorInterface::disconnect() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_disconnected = true;
+        }
+        m_cv.notify_all();
+    }
+
+    void LegacySensorInterface::run() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto nextData = std::chrono::steady_clock::now() + DATA_INTERVAL;
+        while (!m_terminate)
+        {
+            if (m_disconnected)
+            {
+                lock.unlock();
+                publishError(ZenError_Io_ReadFailed);
+                lock.lock();
+
+                m_cv.wait(lock, [this]() { return m_terminate; });
+                return;
+            }
+
+            if (!m_requests.empty())
+            {
+                const auto request = std::move(m_requests.front());
+                m_requests.pop_front();
+
+                lock.unlock();
+                reply(request);
+                lock.lock();
+                continue;
+            }
+
+            if (m_streaming && std::chrono::steady_clock::now() >= nextData)
+            {
+                nextData += DATA_INTERVAL;
+                const auto frameCount = m_frameCount++;
+                lock.unlock();
+                const auto frame = m_factory->makeFrame(1, static_cast<uint8_t>(EDevicePropertyV0::GetRawSensorData),
+                    reinterpret_cast<const std::byte*>(&frameCount), sizeof(frameCount));
+                publishReceivedData(frame);
+                lock.lock();
+                continue;
+            }
+
+            if (m_streaming)
+            {
+                m_cv.wait_until(lock, nextData);
+            }
+            else
+            {
+                m_cv.wait(lock);
+                nextData = std::chrono::steady_clock::now() + DATA_INTERVAL;
+            }
+        }
+    }
+
+    void LegacySensorInterface::reply(const modbus::Frame& request) noexcept
+    {
+        // Every getter used while the sensor is initialized returns zeros, everything else is acknowledged
+        size_t replySize = 0;
+        switch (request.function)
+        {
+        case static_cast<uint8_t>(EDevicePropertyInternal::ConfigImuOutputDataBitset):
+            replySize = sizeof(uint32_t);
+            break;
+
+        case static_cast<uint8_t>(EDevicePropertyV0::GetAccBias):
+        case static_cast<uint8_t>(EDevicePropertyV0::GetGyrBias):
+        case static_cast<uint8_t>(EDevicePropertyV0::GetMagHardIronOffset):
+            replySize = sizeof(float) * 3;
+            break;
+
+        case static_cast<uint8_t>(EDevicePropertyV0::GetAccAlignment):
+        case static_cast<uint8_t>(EDevicePropertyV0::GetGyrAlignment):
+        case static_cast<uint8_t>(EDevicePropertyV0::GetMagSoftIronMatrix):
+            replySize = sizeof(float) * 9;
+            break;
+
+        case static_cast<uint8_t>(EDevicePropertyV0::SetCommandMode):
+        case static_cast<uint8_t>(EDevicePropertyV0::SetStreamMode):
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_streaming = request.function == static_cast<uint8_t>(EDevicePropertyV0::SetStreamMode);
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        const std::vector<std::byte> data(replySize);
+        const auto function = replySize == 0 ? static_cast<uint8_t>(EDevicePropertyV0::Ack) : request.function;
+        publishReceivedData(m_factory->makeFrame(request.address, function, data.data(), static_cast<uint8_t>(data.size())));
+    }
+
+    /** The IO manager keeps its systems, so the system is registered once for all test runs */
+    FlakySensorSystem& flakySensorSystem()
+    {
+        static FlakySensorSystem* system = []() {
+            auto owned = std::make_unique<FlakySensorSystem>();
+            auto system = owned.get();
+            IoManager::get().registerIoSystem(FlakySensorSystem::KEY, std::move(owned));
+            return system;
+        }();
+        return *system;
+    }
+
+    std::optional<ZenEvent> waitForEvent(LockingQueue<ZenEvent>& events, ZenEventType type)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (auto event = events.waitToPopUntil(deadline))
+            if (event->eventType == type)
+                return event;
+
+        return std::nullopt;
+    }
+}
+
+TEST(SensorSupervision, reconnectsAndRestoresSettings) {
+    auto& system = flakySensorSystem();
+
+    ZenSensorDesc desc{};
+    std::strncpy(desc.ioType, FlakySensorSystem::KEY, sizeof(desc.ioType) - 1);
+    std::strncpy(desc.identifier, "flaky", sizeof(desc.identifier) - 1);
+    std::strncpy(desc.serialNumber, "lpmscu2000123", sizeof(desc.serialNumber) - 1);
+
+    // A cached configuration only needs the sensor to enter command mode, which spares emulating the negotiation
+    NegotiationCache::get().store(desc.serialNumber, { SensorConfig{ 0, { ComponentConfig{0, g_zenSensorType_Imu} } }, "" });
+
+    // The sensor reports its disconnection when it is destroyed, so the queue has to outlive it
+    LockingQueue<ZenEvent> events;
+
+    auto sensor = SensorManager::get().obtain(desc);
+    ASSERT_TRUE(sensor.has_value());
+    (*sensor)->subscribe(events);
+    ASSERT_EQ(ZenError_None, SensorManager::get().setSupervised(**sensor, true));
+
+    auto imuProperties = (*sensor)->components().front()->properties();
+    ASSERT_EQ(ZenError_None, imuProperties->setInt32(ZenImuProperty_FilterMode, 2));
+
+    // the sensor needs to stream for a while, before frames can be missed
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const auto disconnected = std::chrono::steady_clock::now();
+    system.disconnect(2);
+
+    const auto lost = waitForEvent(events, ZenEventType_SensorConnectionLost);
+    ASSERT_TRUE(lost.has_value());
+    ASSERT_EQ(ZenError_Io_ReadFailed, lost->data.sensorConnection.error);
+
+    const auto reconnected = waitForEvent(events, ZenEventType_SensorReconnected);
+    ASSERT_TRUE(reconnected.has_value());
+    ASSERT_EQ(ZenError_None, reconnected->data.sensorConnection.error);
+    ASSERT_EQ(3u, reconnected->data.sensorConnection.reconnectAttempts);
+
+    // data stopped at the disconnect, so the frames of the whole backoff are missing
+    ASSERT_GT(reconnected->data.sensorConnection.missedFrames, lost->data.sensorConnection.missedFrames);
+
+    // the backoff starts with 100 ms and doubles after every failed attempt
+    const auto attempts = system.attempts();
+    ASSERT_EQ(3u, attempts.size());
+    ASSERT_GE(attempts[0] - disconnected, std::chrono::milliseconds(100));
+    ASSERT_GE(attempts[1] - attempts[0], std::chrono::milliseconds(200));
+    ASSERT_GE(attempts[2] - attempts[1], std::chrono::milliseconds(400));
+
+    // the filter mode is written again, and streaming is only resumed once the sensor is configured
+    const auto frames = system.frames();
+    ASSERT_EQ(3u, frames.size());
+    ASSERT_EQ(static_cast<uint8_t>(EDevicePropertyV0::SetCommandMode), frames[0].function);
+    ASSERT_EQ(static_cast<uint8_t>(EDevicePropertyV0::SetFilterMode), frames[1].function);
+    ASSERT_EQ(sizeof(uint32_t), frames[1].data.size());
+    uint32_t filterMode;
+    std::memcpy(&filterMode, frames[1].data.data(), sizeof(filterMode));
+    ASSERT_EQ(2u, filterMode);
+    ASSERT_EQ(static_cast<uint8_t>(EDevicePropertyV0::SetStreamMode), frames[2].function);
+
+    (*sensor)->unsubscribe(events);
+    NegotiationCache::get().invalidate(desc.serialNumber);
+}
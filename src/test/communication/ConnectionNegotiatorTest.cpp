@@ -79,3 +79,67 @@ TEST(ConnectionNegotiator, connectIg1Sensor) {
     ASSERT_EQ(g_zenSensorType_Gnss, sensorConfig->components[1].id);
     */
 }
+
+TEST(ConnectionNegotiator, silentSensorUsesAdaptiveTimeout) {
+    ConnectionNegotiator negotiator;
+
+    // the sensor acknowledges the command mode but never answers the firmware query
+    MockbusCommunicator mockbus(negotiator,
+      {
+        {uint8_t(0), uint8_t(EDevicePropertyV0::SetCommandMode),
+            uint8_t(EDevicePropertyV0::Ack),
+            {}
+        }
+      }
+      );
+
+    auto sensorConfig = negotiator.negotiate(mockbus, 57600);
+    ASSERT_TRUE(sensorConfig);
+    ASSERT_EQ(0, sensorConfig->version);
+
+    // the firmware query times out relative to the measured round-trip time
+    // instead of waiting the full two seconds
+    ASSERT_LT(negotiator.negotiationDuration().count(), 2000);
+}
+
+TEST(ConnectionNegotiator, refusedCommandModeFails) {
+    ConnectionNegotiator negotiator;
+
+    MockbusCommunicator mockbus(negotiator,
+      {
+        {uint8_t(0), uint8_t(EDevicePropertyV0::SetCommandMode),
+            uint8_t(EDevicePropertyV0::Nack),
+            {}
+        }
+      }
+      );
+
+    auto sensorConfig = negotiator.negotiate(mockbus, 57600);
+    ASSERT_FALSE(sensorConfig);
+    ASSERT_EQ(ZenSensorInitError_ConnectFailed, sensorConfig.error());
+}
+
+TEST(ConnectionNegotiator, ackDoesNotAnswerDataQuery) {
+    ConnectionNegotiator negotiator;
+
+    // an acknowledgement, e.g. a late one of the command mode, is no answer to the firmware query
+    MockbusCommunicator mockbus(negotiator,
+      {
+        {uint8_t(0), uint8_t(EDevicePropertyV1::GetFirmwareInfo),
+            uint8_t(EDevicePropertyV1::Ack),
+            {}
+        },
+        {uint8_t(0), uint8_t(EDevicePropertyV0::SetCommandMode),
+            uint8_t(EDevicePropertyV0::Ack),
+            {}
+        }
+      }
+      );
+
+    auto sensorConfig = negotiator.negotiate(mockbus, 57600);
+    ASSERT_TRUE(sensorConfig);
+    ASSERT_EQ(0, sensorConfig->version);
+
+    // the firmware query waited for its reply until it timed out, ten times the round-trip time of 100 ms
+    ASSERT_GE(negotiator.negotiationDuration().count(), 1000);
+}
@@ -0,0 +1,95 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "InternalTypes.h"
+#include "communication/ConnectionNegotiator.h"
+#include "communication/NegotiationCache.h"
+#include "utility/StringView.h"
+
+#include "MockbusCommunicator.h"
+
+using namespace zen;
+
+TEST(NegotiationCache, storeAndReloadFromDisk) {
+    const NegotiationCache::Entry entry{ SensorConfig{ 1,
+        { ComponentConfig{1, g_zenSensorType_Imu, SpecialOptions_SecondGyroIsPrimary},
+          ComponentConfig{1, g_zenSensorType_Gnss} } }, "LPMS-BE1" };
+
+    {
+        NegotiationCache cache(".");
+        ASSERT_FALSE(cache.find("lpmsig1000123"));
+        cache.store("lpmsig1000123", entry);
+    }
+
+    // a new cache instance needs to load the entry from the file
+    NegotiationCache cache(".");
+    auto cached = cache.find("lpmsig1000123");
+    ASSERT_TRUE(cached);
+    ASSERT_EQ("LPMS-BE1", cached->sensorModel);
+    ASSERT_EQ(1, cached->config.version);
+    ASSERT_EQ(2, cached->config.components.size());
+    ASSERT_EQ(g_zenSensorType_Imu, cached->config.components[0].id);
+    ASSERT_EQ(SpecialOptions_SecondGyroIsPrimary, cached->config.components[0].specialOptions);
+    ASSERT_EQ(g_zenSensorType_Gnss, cached->config.components[1].id);
+
+    cache.invalidate("lpmsig1000123");
+    ASSERT_FALSE(cache.find("lpmsig1000123"));
+    ASSERT_FALSE(NegotiationCache(".").find("lpmsig1000123"));
+}
+
+TEST(NegotiationCache, validateLegacySensorOnlyEntersCommandMode) {
+    ConnectionNegotiator negotiator;
+
+    // the sensor does not need to reply to the firmware or model queries
+    MockbusCommunicator mockbus(negotiator,
+      {
+        {uint8_t(0), uint8_t(EDevicePropertyV0::SetCommandMode),
+            uint8_t(EDevicePropertyV0::Ack),
+            {}
+        }
+      }
+      );
+
+    const SensorConfig cached{ 0, { ComponentConfig{0, g_zenSensorType_Imu} } };
+    auto sensorConfig = negotiator.validate(mockbus, 57600, cached, "");
+    ASSERT_TRUE(sensorConfig);
+    ASSERT_EQ(0, sensorConfig->version);
+    ASSERT_EQ(1, sensorConfig->components.size());
+    ASSERT_EQ(g_zenSensorType_Imu, sensorConfig->components[0].id);
+}
+
+TEST(NegotiationCache, validateComparesSensorModel) {
+    ConnectionNegotiator negotiator;
+
+    MockbusCommunicator mockbus(negotiator,
+      {
+        {uint8_t(0), uint8_t(EDevicePropertyV1::GetSensorModel),
+            uint8_t(EDevicePropertyV1::GetSensorModel),
+          { util::stringToBuffer("LPMS-IG1P-RS232") }
+        },
+        {uint8_t(0), uint8_t(EDevicePropertyV0::SetCommandMode),
+            uint8_t(EDevicePropertyV0::Ack),
+            {}
+        }
+      }
+      );
+
+    const SensorConfig cached{ 1, { ComponentConfig{1, g_zenSensorType_Imu} } };
+    auto sensorConfig = negotiator.validate(mockbus, 57600, cached, "LPMS-IG1P-RS232");
+    ASSERT_TRUE(sensorConfig);
+    ASSERT_EQ(1, sensorConfig->version);
+
+    // another model with the same serial number needs to be negotiated again
+    sensorConfig = negotiator.validate(mockbus, 57600, cached, "LPMS-IG1-RS232");
+    ASSERT_FALSE(sensorConfig);
+    ASSERT_EQ(ZenSensorInitError_InvalidConfig, sensorConfig.error());
+}
@@ -0,0 +1,47 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "communication/RoundTripStatistics.h"
+
+using namespace zen;
+using namespace std::chrono_literals;
+
+TEST(RoundTripStatistics, timeoutFollowsRoundTripTimes) {
+    RoundTripStatistics statistics;
+    ASSERT_EQ(RoundTripStatistics::DEFAULT_TIMEOUT, statistics.timeout());
+
+    // a fast link is limited by the floor
+    for (int i = 0; i < 100; ++i)
+        statistics.addSample(i % 2 ? 10ms : 20ms);
+    ASSERT_EQ(RoundTripStatistics::MIN_TIMEOUT, statistics.timeout());
+
+    // a slow link waits for longer than its typical round-trip time
+    for (int i = 0; i < 100; ++i)
+        statistics.addSample(i % 2 ? 800ms : 1200ms);
+    const auto timeout = statistics.timeout();
+    ASSERT_GT(timeout, 1200ms);
+    ASSERT_LT(timeout, RoundTripStatistics::MAX_TIMEOUT);
+
+    // timeouts back off until the next reply
+    statistics.addTimeout();
+    ASSERT_EQ(std::min(timeout * 2, std::chrono::milliseconds(RoundTripStatistics::MAX_TIMEOUT)), statistics.timeout());
+    statistics.addSample(1000ms);
+    ASSERT_LT(statistics.timeout(), timeout * 2);
+
+    const auto summary = statistics.summary();
+    ASSERT_EQ(201u, summary.samples);
+    ASSERT_EQ(1u, summary.timeouts);
+    ASSERT_FLOAT_EQ(10.f, summary.min);
+    ASSERT_FLOAT_EQ(1200.f, summary.max);
+    ASSERT_FLOAT_EQ(800.f, summary.median);
+    ASSERT_FLOAT_EQ(1200.f, summary.p90);
+}
@@ -0,0 +1,48 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "communication/StreamingStatistics.h"
+
+using namespace zen;
+
+TEST(StreamingStatistics, countGapsAndReordering) {
+    StreamingStatistics statistics;
+    constexpr uint64_t ms = 1000000;
+
+    statistics.addMessage("imu/a/", 0, 10 * ms, 11 * ms, 1);
+    statistics.addMessage("imu/a/", 1, 20 * ms, 23 * ms, 1);
+    // 2 and 3 are missing, 3 arrives late
+    statistics.addMessage("imu/a/", 4, 30 * ms, 31 * ms, 2);
+    statistics.addMessage("imu/a/", 3, 25 * ms, 32 * ms, 1);
+    // streams are numbered independently
+    statistics.addMessage("gnss/a/", 7, 40 * ms, 41 * ms, 1);
+    // a restarted publisher begins with 0 again
+    statistics.addMessage("imu/a/", 0, 50 * ms, 51 * ms, 1);
+    statistics.addMessage("imu/a/", 1, 60 * ms, 61 * ms, 1);
+    // send times of another host's clock are not used for the latency
+    statistics.addMessage("imu/a/", 2, 70 * ms, 1 * ms, 1);
+    statistics.addUnsequencedMessage(3);
+
+    const auto summary = statistics.summary();
+    ASSERT_EQ(9u, summary.messages);
+    ASSERT_EQ(12u, summary.events);
+    ASSERT_EQ(1u, summary.lostMessages);
+    ASSERT_EQ(1u, summary.gaps);
+    ASSERT_EQ(1u, summary.reorderedMessages);
+    ASSERT_EQ(1u, summary.unsequencedMessages);
+
+    ASSERT_EQ(7u, summary.latencySamples);
+    ASSERT_FLOAT_EQ(1.f, summary.latencyMin);
+    ASSERT_FLOAT_EQ(7.f, summary.latencyMax);
+    ASSERT_FLOAT_EQ(15.f / 7.f, summary.latencyMean);
+    ASSERT_FLOAT_EQ(1.f, summary.latencyMedian);
+}
@@ -0,0 +1,153 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "communication/SyncedModbusCommunicator.h"
+
+#include "MockbusCommunicator.h"
+
+#include <future>
+
+using namespace zen;
+
+namespace
+{
+    /** Answers every request with the function number as result */
+    class EchoSubscriber : public IModbusFrameSubscriber
+    {
+    public:
+        ZenError processReceivedData(uint8_t, uint8_t function, gsl::span<const std::byte>) noexcept override
+        {
+            return communicator->publishResult<uint32_t>(function, ZenError_None, function);
+        }
+
+        SyncedModbusCommunicator* communicator = nullptr;
+    };
+
+    class SilentSubscriber : public IModbusFrameSubscriber
+    {
+    public:
+        ZenError processReceivedData(uint8_t, uint8_t, gsl::span<const std::byte>) noexcept override
+        {
+            return ZenError_None;
+        }
+    };
+}
+
+TEST(SyncedModbusCommunicator, concurrentRequestsDoNotFail) {
+    EchoSubscriber subscriber;
+    MockbusCommunicator::RepliesVector replies;
+    for (uint8_t function = 10; function < 20; ++function)
+        replies.emplace_back(0, function, function, std::vector<std::byte>());
+
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, replies));
+    subscriber.communicator = &communicator;
+
+    std::vector<std::future<nonstd::expected<uint32_t, ZenError>>> results;
+    for (uint8_t function = 10; function < 20; ++function)
+        results.emplace_back(std::async(std::launch::async, [&communicator, function]() {
+            return communicator.sendAndWaitForResult<uint32_t>(0, function, function, {});
+        }));
+
+    for (uint32_t function = 10; function < 20; ++function)
+    {
+        auto result = results[function - 10].get();
+        ASSERT_TRUE(result);
+        ASSERT_EQ(function, *result);
+    }
+}
+
+TEST(SyncedModbusCommunicator, matchesRepliesToPendingRequests) {
+    SilentSubscriber subscriber;
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, MockbusCommunicator::RepliesVector()));
+
+    uint32_t first = 0, second = 0;
+    auto firstRequest = communicator.sendRequest(0, 1, 1, {}, false, gsl::make_span(reinterpret_cast<std::byte*>(&first), sizeof(first)));
+    auto secondRequest = communicator.sendRequest(0, 2, 2, {}, false, gsl::make_span(reinterpret_cast<std::byte*>(&second), sizeof(second)));
+    auto firstAck = communicator.sendRequest(0, 3, 3, {}, true);
+    auto secondAck = communicator.sendRequest(0, 4, 4, {}, true);
+    ASSERT_TRUE(firstRequest && secondRequest && firstAck && secondAck);
+
+    // results are matched by property, acknowledgements in order
+    ASSERT_EQ(ZenError_None, communicator.publishResult<uint32_t>(2, ZenError_None, 22));
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+    ASSERT_EQ(ZenError_None, communicator.publishResult<uint32_t>(1, ZenError_None, 11));
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_FW_FunctionFailed));
+
+    ASSERT_EQ(ZenError_None, communicator.wait(**firstRequest));
+    ASSERT_EQ(ZenError_None, communicator.wait(**secondRequest));
+    ASSERT_EQ(ZenError_None, communicator.wait(**firstAck));
+    ASSERT_EQ(ZenError_FW_FunctionFailed, communicator.wait(**secondAck));
+    ASSERT_EQ(11u, first);
+    ASSERT_EQ(22u, second);
+}
+
+TEST(SyncedModbusCommunicator, nackRejectsOldestRequest) {
+    SilentSubscriber subscriber;
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, MockbusCommunicator::RepliesVector()));
+
+    uint32_t result = 0;
+    auto resultRequest = communicator.sendRequest(0, 1, 1, {}, false, gsl::make_span(reinterpret_cast<std::byte*>(&result), sizeof(result)));
+    auto ackRequest = communicator.sendRequest(0, 2, 2, {}, true);
+    ASSERT_TRUE(resultRequest && ackRequest);
+
+    // the sensor refuses the result request, which was sent first, and then acknowledges the command
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_FW_FunctionFailed));
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+
+    ASSERT_EQ(ZenError_FW_FunctionFailed, communicator.wait(**resultRequest));
+    ASSERT_EQ(ZenError_None, communicator.wait(**ackRequest));
+}
+
+TEST(SyncedModbusCommunicator, longCommandsWaitForMinimumTimeout) {
+    SilentSubscriber subscriber;
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, MockbusCommunicator::RepliesVector()));
+
+    // quick replies shorten the adaptive timeout to its minimum
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto request = communicator.sendRequest(0, 1, 1, {}, true);
+        ASSERT_TRUE(request);
+        ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+        ASSERT_EQ(ZenError_None, communicator.wait(**request));
+    }
+    ASSERT_EQ(RoundTripStatistics::MIN_TIMEOUT.count(), communicator.roundTripStatistics().timeout);
+
+    const auto minTimeout = RoundTripStatistics::MIN_TIMEOUT * 2;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(ZenError_Io_Timeout, communicator.sendAndWaitForAck(0, 2, 2, {}, minTimeout));
+    ASSERT_GE(std::chrono::steady_clock::now() - start, minTimeout);
+}
+
+TEST(SyncedModbusCommunicator, lateAckIsNotCreditedToNextRequest) {
+    SilentSubscriber subscriber;
+    SyncedModbusCommunicator communicator(std::make_unique<MockbusCommunicator>(subscriber, MockbusCommunicator::RepliesVector()));
+
+    // quick replies shorten the adaptive timeout to its minimum
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto request = communicator.sendRequest(0, 1, 1, {}, true);
+        ASSERT_TRUE(request);
+        ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+        ASSERT_EQ(ZenError_None, communicator.wait(**request));
+    }
+
+    ASSERT_EQ(ZenError_Io_Timeout, communicator.sendAndWaitForAck(0, 2, 2, {}));
+
+    // the acknowledgement of the timed out command arrives while the next command is pending
+    auto next = communicator.sendRequest(0, 3, 3, {}, true);
+    ASSERT_TRUE(next);
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_None));
+
+    // the sensor refuses the next command, which therefore must not have been acknowledged
+    ASSERT_EQ(ZenError_None, communicator.publishAck(ZenSensorProperty_Invalid, ZenError_FW_FunctionFailed));
+    ASSERT_EQ(ZenError_FW_FunctionFailed, communicator.wait(**next));
+}
@@ -0,0 +1,116 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "io/IoCapture.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace zen;
+
+TEST(IoCapture, recordAndReadBack) {
+    const std::string path = "IoCaptureTest.zcap";
+    const std::vector<std::byte> received = { std::byte(0x3a), std::byte(0x01), std::byte(0x02) };
+    const std::vector<std::byte> sent = { std::byte(0x3a), std::byte(0x06) };
+
+    {
+        // use a small buffer to force a hand-over to the flush thread
+        auto capture = IoCapture::open(path, 256);
+        ASSERT_TRUE(capture);
+
+        for (int i = 0; i < 10; ++i) {
+            (*capture)->record(IoCaptureDirection::Received, received);
+            (*capture)->record(IoCaptureDirection::Sent, sent);
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(path.c_str());
+
+    ASSERT_GE(content.size(), IoCaptureFormat::FileHeaderSize);
+    ASSERT_EQ(0, std::memcmp(content.data(), IoCaptureFormat::Magic, sizeof(IoCaptureFormat::Magic)));
+
+    size_t offset = IoCaptureFormat::FileHeaderSize;
+    size_t nRecords = 0;
+    uint64_t lastTimestamp = 0;
+    while (offset + IoCaptureFormat::RecordHeaderSize <= content.size()) {
+        uint64_t timestamp;
+        uint8_t direction;
+        uint32_t size;
+        std::memcpy(&timestamp, content.data() + offset, sizeof(timestamp));
+        std::memcpy(&direction, content.data() + offset + 8, sizeof(direction));
+        std::memcpy(&size, content.data() + offset + 9, sizeof(size));
+
+        ASSERT_GE(timestamp, lastTimestamp);
+        const auto& expected = direction == uint8_t(IoCaptureDirection::Received) ? received : sent;
+        ASSERT_EQ(expected.size(), size);
+        ASSERT_EQ(0, std::memcmp(expected.data(), content.data() + offset + IoCaptureFormat::RecordHeaderSize, size));
+
+        lastTimestamp = timestamp;
+        offset += IoCaptureFormat::RecordHeaderSize + size;
+        ++nRecords;
+    }
+
+    ASSERT_EQ(content.size(), offset);
+    ASSERT_EQ(20, nRecords);
+}
+
+TEST(IoCapture, loadSkipsTruncatedRecord) {
+    const std::string path = "IoCaptureTruncatedTest.zcap";
+    const std::vector<std::byte> received(64, std::byte(0x3a));
+
+    {
+        auto capture = IoCapture::open(path, 256);
+        ASSERT_TRUE(capture);
+        (*capture)->record(IoCaptureDirection::Received, received);
+        (*capture)->record(IoCaptureDirection::Received, received);
+    }
+
+    auto records = IoCapture::load(path);
+    ASSERT_TRUE(records);
+    ASSERT_EQ(2, records->size());
+
+    // cut the file within the payload of the second record
+    std::ifstream input(path, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    content.resize(content.size() - received.size() / 2);
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), content.size());
+
+    // the records which were written completely are kept
+    records = IoCapture::load(path);
+    ASSERT_TRUE(records);
+    ASSERT_EQ(1, records->size());
+    ASSERT_EQ(received, records->front().data);
+
+    // the same applies to a partial record header
+    content.resize(IoCaptureFormat::FileHeaderSize + IoCaptureFormat::RecordHeaderSize + received.size() + 5);
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), content.size());
+
+    records = IoCapture::load(path);
+    ASSERT_TRUE(records);
+    ASSERT_EQ(1, records->size());
+
+    // a corrupt size must not be allocated
+    const uint32_t hugeSize = 0xffffffff;
+    std::memcpy(content.data() + IoCaptureFormat::FileHeaderSize + 9, &hugeSize, sizeof(hugeSize));
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), content.size());
+
+    records = IoCapture::load(path);
+    std::remove(path.c_str());
+    ASSERT_TRUE(records);
+    ASSERT_TRUE(records->empty());
+}
@@ -0,0 +1,165 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "io/systems/linux/LinuxDeviceMonitor.h"
+
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace zen;
+
+namespace
+{
+    using Devices = LinuxDeviceTable::Devices;
+    using Change = std::tuple<std::string, std::string, bool>;
+
+    /** Builds a uevent from its strings, each of which is null-terminated */
+    std::string uevent(const std::vector<std::string>& entries)
+    {
+        std::string message;
+        for (const auto& entry : entries)
+            message.append(entry).push_back('\0');
+        return message;
+    }
+
+    bool isRelevant(const std::string& message)
+    {
+        return LinuxDeviceMonitor::isRelevantUevent(message.data(), message.size());
+    }
+
+    /** Table whose scans return the devices of the test, and which records the reported changes */
+    struct TestTable
+    {
+        Devices devices;
+        size_t nScans = 0;
+        std::vector<Change> changes;
+
+        LinuxDeviceTable table{
+            [this]() { ++nScans; return devices; },
+            [this](const std::string& serialNumber, const std::string& ttyDevice, bool attached) {
+                changes.emplace_back(serialNumber, ttyDevice, attached);
+            }
+        };
+    };
+}
+
+TEST(LinuxDeviceMonitor, filtersUevents) {
+    ASSERT_TRUE(isRelevant(uevent({ "add@/devices/usb1/1-1", "ACTION=add", "SUBSYSTEM=usb" })));
+    ASSERT_TRUE(isRelevant(uevent({ "remove@/devices/usb1/1-1/tty/ttyUSB0", "ACTION=remove", "SUBSYSTEM=tty" })));
+    ASSERT_TRUE(isRelevant(uevent({ "add@/devices/usb1/1-1/ttyUSB0", "SUBSYSTEM=usb-serial", "ACTION=add" })));
+
+    // other actions and subsystems do not change the connected sensors
+    ASSERT_FALSE(isRelevant(uevent({ "bind@/devices/usb1/1-1", "ACTION=bind", "SUBSYSTEM=usb" })));
+    ASSERT_FALSE(isRelevant(uevent({ "add@/devices/block/sda", "ACTION=add", "SUBSYSTEM=block" })));
+
+    // the header names the action, but is not an entry
+    ASSERT_FALSE(isRelevant(uevent({ "add@/devices/usb1/1-1", "SUBSYSTEM=usb" })));
+
+    // the last entry of a truncated message is not terminated
+    auto truncated = uevent({ "add@/devices/usb1/1-1", "ACTION=add", "SUBSYSTEM=usb" });
+    truncated.pop_back();
+    ASSERT_TRUE(isRelevant(truncated));
+    ASSERT_FALSE(isRelevant(truncated.substr(0, truncated.size() - 1)));
+}
+
+TEST(LinuxDeviceMonitor, listsChangedDevices) {
+    const Devices previous = { { "A", { "/dev/ttyUSB0" } }, { "B", { "/dev/ttyUSB1" } } };
+    const Devices current = { { "A", { "/dev/ttyUSB0", "/dev/ttyUSB2" } }, { "C", { "/dev/ttyUSB3" } } };
+
+    std::vector<Change> changes;
+    for (const auto& change : LinuxDeviceTable::changes(previous, current))
+        changes.emplace_back(change.serialNumber, change.ttyDevice, change.attached);
+
+    // detached devices come first, so a tty device which moved to another sensor is released before it is reused
+    const std::vector<Change> expected = {
+        { "B", "/dev/ttyUSB1", false },
+        { "A", "/dev/ttyUSB2", true },
+        { "C", "/dev/ttyUSB3", true }
+    };
+    ASSERT_EQ(expected, changes);
+    ASSERT_TRUE(LinuxDeviceTable::changes(current, current).empty());
+}
+
+TEST(LinuxDeviceMonitor, monitoredTableReportsChanges) {
+    TestTable test;
+    test.devices = { { "A", { "/dev/ttyUSB0" } } };
+    test.table.startMonitoring();
+    ASSERT_TRUE(test.table.monitoring());
+    ASSERT_EQ(1u, test.nScans);
+
+    // the initial scan is not reported, and queries are answered from the table
+    ASSERT_EQ(test.devices, test.table.devices());
+    ASSERT_EQ(std::vector<std::string>{ "/dev/ttyUSB0" }, test.table.devicesForSerial("A"));
+    ASSERT_EQ(1u, test.nScans);
+    ASSERT_TRUE(test.changes.empty());
+
+    test.devices = { { "B", { "/dev/ttyUSB0" } } };
+    test.table.rescan();
+    const std::vector<Change> expected = { { "A", "/dev/ttyUSB0", false }, { "B", "/dev/ttyUSB0", true } };
+    ASSERT_EQ(expected, test.changes);
+    ASSERT_EQ(test.devices, test.table.devices());
+
+    // a serial number which is not known yet might have been attached before its uevent arrived
+    test.devices["C"] = { "/dev/ttyUSB1" };
+    ASSERT_EQ(std::vector<std::string>{ "/dev/ttyUSB1" }, test.table.devicesForSerial("C"));
+    ASSERT_EQ(3u, test.nScans);
+}
+
+TEST(LinuxDeviceMonitor, unmonitoredTableScansOnEveryQuery) {
+    TestTable test;
+    test.devices = { { "A", { "/dev/ttyUSB0" } } };
+    test.table.startMonitoring();
+
+    // e.g. the uevent socket failed
+    test.table.stopMonitoring();
+    ASSERT_FALSE(test.table.monitoring());
+
+    test.devices = { { "B", { "/dev/ttyUSB0" } } };
+    ASSERT_EQ(test.devices, test.table.devices());
+    ASSERT_EQ(2u, test.nScans);
+    ASSERT_EQ(std::vector<std::string>{ "/dev/ttyUSB0" }, test.table.devicesForSerial("B"));
+    ASSERT_EQ(3u, test.nScans);
+
+    // changes noticed while listing are not reported as events
+    ASSERT_TRUE(test.changes.empty());
+}
+
+TEST(LinuxDeviceMonitor, settleDeadlineIsNotPostponed) {
+    using namespace std::chrono_literals;
+    const auto start = UeventSettleDeadline::Clock::now();
+
+    UeventSettleDeadline deadline;
+    ASSERT_EQ(-1, deadline.pollTimeout(start));
+    ASSERT_FALSE(deadline.expired(start));
+
+    deadline.changed(start);
+    ASSERT_EQ(100, deadline.pollTimeout(start));
+
+    // later uevents of the burst keep the first deadline
+    deadline.changed(start + 60ms);
+    ASSERT_EQ(40, deadline.pollTimeout(start + 60ms));
+    ASSERT_FALSE(deadline.expired(start + 60ms));
+
+    // poll must not return before the deadline, so the timeout is rounded up
+    ASSERT_EQ(1, deadline.pollTimeout(start + 99500us));
+    ASSERT_EQ(0, deadline.pollTimeout(start + 150ms));
+
+    ASSERT_TRUE(deadline.expired(start + 100ms));
+    ASSERT_FALSE(deadline.expired(start + 100ms));
+    ASSERT_EQ(-1, deadline.pollTimeout(start + 100ms));
+
+    // the next burst starts a new deadline
+    deadline.changed(start + 200ms);
+    ASSERT_EQ(100, deadline.pollTimeout(start + 200ms));
+}
@@ -0,0 +1,138 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include "io/interfaces/ReplayInterface.h"
+#include "io/systems/ReplaySystem.h"
+#include "utility/LittleEndian.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace zen;
+
+namespace {
+    class RecordingSubscriber : public IIoDataSubscriber {
+    public:
+        ZenError processData(gsl::span<const std::byte> data) noexcept override {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_received.emplace_back(data.begin(), data.end());
+            m_receiveTimes.emplace_back(std::chrono::steady_clock::now());
+            return ZenError_None;
+        }
+
+        size_t count() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_received.size();
+        }
+
+        std::vector<std::chrono::steady_clock::time_point> receiveTimes() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_receiveTimes;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<std::vector<std::byte>> m_received;
+        std::vector<std::chrono::steady_clock::time_point> m_receiveTimes;
+    };
+
+    /** Writes a capture file with the given timestamps, which a recording could not control */
+    void writeCapture(const std::string& path, const std::vector<IoCaptureRecord>& records) {
+        std::vector<std::byte> content(IoCaptureFormat::FileHeaderSize);
+        std::memcpy(content.data(), IoCaptureFormat::Magic, sizeof(IoCaptureFormat::Magic));
+        auto dst = writeLittleEndian(content.data() + sizeof(IoCaptureFormat::Magic), IoCaptureFormat::Version);
+        writeLittleEndian(dst, int64_t(0));
+
+        for (const auto& record : records) {
+            const auto offset = content.size();
+            content.resize(offset + IoCaptureFormat::RecordHeaderSize);
+            dst = writeLittleEndian(content.data() + offset, record.timestamp);
+            dst = writeLittleEndian(dst, static_cast<uint8_t>(record.direction));
+            writeLittleEndian(dst, static_cast<uint32_t>(record.data.size()));
+            content.insert(content.end(), record.data.begin(), record.data.end());
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    }
+
+    template <typename Predicate>
+    bool waitFor(Predicate predicate) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+TEST(ReplayInterface, answersCommandsFromRecording) {
+    const std::vector<std::byte> command = { std::byte(0x3a), std::byte(0x06) };
+
+    std::vector<IoCaptureRecord> records = {
+        { 0, IoCaptureDirection::Received, { std::byte(0x01) } },
+        { 1000, IoCaptureDirection::Sent, command },
+        { 2000, IoCaptureDirection::Received, { std::byte(0x02) } },
+        { 3000, IoCaptureDirection::Received, { std::byte(0x03) } }
+    };
+
+    RecordingSubscriber subscriber;
+    ReplayInterface replay(subscriber, "test.zcap@max", std::move(records), 0.0, 115200);
+
+    // the replay stops at the recorded command until the host sends it
+    ASSERT_TRUE(waitFor([&]() { return subscriber.count() == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(1, subscriber.count());
+    ASSERT_FALSE(replay.finished());
+
+    ASSERT_EQ(ZenError_None, replay.send(command));
+    ASSERT_TRUE(waitFor([&]() { return replay.finished(); }));
+    ASSERT_EQ(3, subscriber.count());
+}
+
+TEST(ReplayInterface, pacesReplayBySpeed) {
+    using namespace std::chrono_literals;
+
+    // the chunks were received 100 ms apart
+    const std::string path = "ReplayPacingTest.zcap";
+    writeCapture(path, {
+        { 0, IoCaptureDirection::Received, { std::byte(0x01) } },
+        { 100'000'000, IoCaptureDirection::Received, { std::byte(0x02) } },
+        { 200'000'000, IoCaptureDirection::Received, { std::byte(0x03) } }
+    });
+
+    // real-time and four times faster
+    const std::vector<std::pair<std::string, std::chrono::milliseconds>> cases = { { path, 200ms }, { path + "@4", 50ms } };
+    for (const auto& [identifier, expected] : cases) {
+        ZenSensorDesc desc{};
+        std::strncpy(desc.identifier, identifier.c_str(), sizeof(desc.identifier) - 1);
+
+        RecordingSubscriber subscriber;
+        ReplaySystem system;
+        auto replay = system.obtain(desc, subscriber);
+        ASSERT_TRUE(replay);
+        ASSERT_TRUE(waitFor([&]() { return subscriber.count() == 3; }));
+
+        const auto times = subscriber.receiveTimes();
+        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(times.back() - times.front());
+        ASSERT_NEAR(expected.count(), duration.count(), 30) << identifier;
+    }
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,156 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/can.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "io/can/SocketCanChannel.h"
+#include "io/interfaces/CanInterface.h"
+
+using namespace zen;
+
+namespace
+{
+    /** The tests need a virtual CAN interface:
+     *
+     *  sudo ip link add dev vcan0 type vcan
+     *  sudo ip link set up vcan0
+     */
+    constexpr const char* VCAN_INTERFACE = "vcan0";
+
+    /** Raw CAN socket which sends frames to the virtual bus, like a sensor */
+    class BusSender
+    {
+    public:
+        BusSender()
+            : m_fd(::socket(PF_CAN, SOCK_RAW, CAN_RAW))
+        {
+            struct sockaddr_can address;
+            std::memset(&address, 0, sizeof(address));
+            address.can_family = AF_CAN;
+            address.can_ifindex = static_cast<int>(::if_nametoindex(VCAN_INTERFACE));
+            ::bind(m_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+        }
+
+        ~BusSender() { ::close(m_fd); }
+
+        bool send(uint32_t id, std::vector<uint8_t> data)
+        {
+            struct can_frame frame;
+            std::memset(&frame, 0, sizeof(frame));
+            frame.can_id = id;
+            frame.can_dlc = static_cast<uint8_t>(data.size());
+            std::memcpy(frame.data, data.data(), data.size());
+            return ::write(m_fd, &frame, sizeof(frame)) == sizeof(frame);
+        }
+
+    private:
+        const int m_fd;
+    };
+
+    class DataCollector : public IIoDataSubscriber
+    {
+    public:
+        ZenError processData(gsl::span<const std::byte> data) noexcept override
+        {
+            for (auto byte : data)
+                received.emplace_back(std::to_integer<uint8_t>(byte));
+            return ZenError_None;
+        }
+
+        std::vector<uint8_t> received;
+    };
+
+    bool hasVirtualBus()
+    {
+        return ::if_nametoindex(VCAN_INTERFACE) != 0;
+    }
+}
+
+TEST(SocketCanChannel, dispatchesSubscribedFrames) {
+    if (!hasVirtualBus())
+        GTEST_SKIP() << VCAN_INTERFACE << " is not available";
+
+    auto channel = SocketCanChannel::open(VCAN_INTERFACE);
+    ASSERT_TRUE(channel.has_value());
+    ASSERT_TRUE((*channel)->equalsBus(VCAN_INTERFACE));
+    ASSERT_FALSE((*channel)->equalsBus("can0"));
+
+    DataCollector collector;
+    CanInterface canInterface(collector, **channel, 0x123);
+    ASSERT_TRUE((*channel)->subscribe(canInterface));
+
+    // frames of other IDs are filtered by the kernel
+    BusSender sender;
+    ASSERT_TRUE(sender.send(0x124, { 9, 9 }));
+    ASSERT_TRUE(sender.send(0x123, { 1, 2, 3 }));
+
+    ASSERT_TRUE((*channel)->waitForData());
+    ASSERT_EQ(ZenError_None, (*channel)->poll());
+    ASSERT_EQ((std::vector<uint8_t>{ 1, 2, 3 }), collector.received);
+}
+
+TEST(SocketCanChannel, cancelWaitEndsWait) {
+    if (!hasVirtualBus())
+        GTEST_SKIP() << VCAN_INTERFACE << " is not available";
+
+    auto channel = SocketCanChannel::open(VCAN_INTERFACE);
+    ASSERT_TRUE(channel.has_value());
+
+    auto waiting = std::async(std::launch::async, [&channel]() { return (*channel)->waitForData(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    (*channel)->cancelWait();
+
+    ASSERT_EQ(std::future_status::ready, waiting.wait_for(std::chrono::seconds(1)));
+    ASSERT_FALSE(waiting.get());
+    ASSERT_FALSE((*channel)->waitForData());
+}
+
+TEST(SocketCanChannel, listsSensorsOnTheBus) {
+    if (!hasVirtualBus())
+        GTEST_SKIP() << VCAN_INTERFACE << " is not available";
+
+    auto channel = SocketCanChannel::open(VCAN_INTERFACE);
+    ASSERT_TRUE(channel.has_value());
+
+    // the sensor keeps sending while the channel listens for a moment
+    std::atomic_bool listing(true);
+    std::thread sensor([&listing]() {
+        BusSender sender;
+        while (listing)
+        {
+            sender.send(0x55, { 0 });
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    std::vector<ZenSensorDesc> devices;
+    const auto error = (*channel)->listDevices(devices);
+    listing = false;
+    sensor.join();
+
+    ASSERT_EQ(ZenError_None, error);
+    ASSERT_TRUE(std::any_of(devices.begin(), devices.end(), [](const ZenSensorDesc& desc) {
+        return std::string(desc.identifier) == std::to_string(0x55) + "@" + VCAN_INTERFACE;
+    }));
+}
@@ -12,6 +12,7 @@
 
 #include "ZenTypes.h"
 
+#include "streaming/FixedLayoutArchive.h"
 #include "streaming/ZenTypesSerialization.h"
 
 #include <cereal/cereal.hpp>
@@ -91,4 +92,84 @@ TEST(Serialization, serializeAndDeserializeGps) {
     ASSERT_EQ(gnssData.longitude, gnssDataLoaded.longitude);
     ASSERT_EQ(gnssData.fixType, gnssDataLoaded.fixType);
     ASSERT_EQ(gnssData.carrierPhaseSolution, gnssDataLoaded.carrierPhaseSolution);
-}
\ No newline at end of file
+}
+
+TEST(Serialization, fixedLayoutRoundTripImu) {
+    zen::Serialization::ZenEventImuSerialization imuData{};
+    imuData.sensor = 3;
+    imuData.component = 1;
+    imuData.data.frameCount = 42;
+    imuData.data.timestamp = 0.105;
+    imuData.data.a[2] = -9.81f;
+    imuData.data.g[0] = 0.004f;
+    imuData.data.q[0] = 0.5f;
+    imuData.data.q[3] = -0.5f;
+    imuData.data.rotOffsetM[8] = 1.0f;
+    imuData.data.heaveMotion = 55.1f;
+
+    // every field is written with the size of its type, without padding
+    const size_t size = zen::Streaming::fixedLayoutSize<zen::Serialization::ZenEventImuSerialization>();
+    ASSERT_EQ(2 * sizeof(uint64_t) + sizeof(int) + sizeof(double) + 54 * sizeof(float), size);
+
+    std::vector<std::byte> buffer(size);
+    zen::Streaming::writeFixedLayout(imuData, buffer.data());
+    // little-endian, independent of the host
+    ASSERT_EQ(std::byte(3), buffer[0]);
+    ASSERT_EQ(std::byte(42), buffer[2 * sizeof(uint64_t)]);
+    ASSERT_EQ(std::byte(0), buffer[2 * sizeof(uint64_t) + 3]);
+
+    zen::Serialization::ZenEventImuSerialization imuDataLoaded{};
+    ASSERT_TRUE(zen::Streaming::readFixedLayout(gsl::make_span(buffer), imuDataLoaded));
+    ASSERT_EQ(imuData.sensor, imuDataLoaded.sensor);
+    ASSERT_EQ(imuData.component, imuDataLoaded.component);
+    ASSERT_EQ(imuData.data.frameCount, imuDataLoaded.data.frameCount);
+    ASSERT_EQ(imuData.data.timestamp, imuDataLoaded.data.timestamp);
+    checkArray3(imuData.data.a, imuDataLoaded.data.a);
+    checkArray3(imuData.data.g, imuDataLoaded.data.g);
+    ASSERT_EQ(imuData.data.q[0], imuDataLoaded.data.q[0]);
+    ASSERT_EQ(imuData.data.q[3], imuDataLoaded.data.q[3]);
+    ASSERT_EQ(imuData.data.rotOffsetM[8], imuDataLoaded.data.rotOffsetM[8]);
+    ASSERT_EQ(imuData.data.heaveMotion, imuDataLoaded.data.heaveMotion);
+
+    // truncated messages are rejected
+    ASSERT_FALSE(zen::Streaming::readFixedLayout(gsl::make_span(buffer.data(), size - 1), imuDataLoaded));
+}
+
+TEST(Serialization, fixedLayoutRoundTripGnss) {
+    zen::Serialization::ZenEventGnssSerialization gnssData{};
+    gnssData.sensor = 3;
+    gnssData.component = 2;
+    gnssData.data.frameCount = 42;
+    gnssData.data.latitude = 35.6635894;
+    gnssData.data.longitude = 139.7242735;
+    gnssData.data.fixType = ZenGnssFixType::ZenGnssFixType_3dFix;
+    gnssData.data.numberSatellitesUsed = 17;
+    gnssData.data.year = 2020;
+    gnssData.data.nanoSecondCorrection = -12345;
+
+    // every field is written with the size of its type, without padding
+    const size_t size = zen::Streaming::fixedLayoutSize<zen::Serialization::ZenEventGnssSerialization>();
+    ASSERT_EQ(2 * sizeof(uint64_t) + sizeof(int) + 11 * sizeof(double) + sizeof(ZenGnssFixType) + sizeof(ZenGnssFixCarrierPhaseSolution) + 6 * sizeof(uint8_t)
+        + sizeof(uint16_t) + sizeof(int32_t), size);
+
+    std::vector<std::byte> buffer(size);
+    zen::Streaming::writeFixedLayout(gnssData, buffer.data());
+    // little-endian, independent of the host
+    ASSERT_EQ(std::byte(3), buffer[0]);
+    ASSERT_EQ(std::byte(0), buffer[7]);
+
+    zen::Serialization::ZenEventGnssSerialization gnssDataLoaded{};
+    ASSERT_TRUE(zen::Streaming::readFixedLayout(gsl::make_span(buffer), gnssDataLoaded));
+    ASSERT_EQ(gnssData.sensor, gnssDataLoaded.sensor);
+    ASSERT_EQ(gnssData.component, gnssDataLoaded.component);
+    ASSERT_EQ(gnssData.data.frameCount, gnssDataLoaded.data.frameCount);
+    ASSERT_EQ(gnssData.data.latitude, gnssDataLoaded.data.latitude);
+    ASSERT_EQ(gnssData.data.longitude, gnssDataLoaded.data.longitude);
+    ASSERT_EQ(gnssData.data.fixType, gnssDataLoaded.data.fixType);
+    ASSERT_EQ(gnssData.data.numberSatellitesUsed, gnssDataLoaded.data.numberSatellitesUsed);
+    ASSERT_EQ(gnssData.data.year, gnssDataLoaded.data.year);
+    ASSERT_EQ(gnssData.data.nanoSecondCorrection, gnssDataLoaded.data.nanoSecondCorrection);
+
+    // truncated messages are rejected
+    ASSERT_FALSE(zen::Streaming::readFixedLayout(gsl::make_span(buffer.data(), size - 1), gnssDataLoaded));
+}
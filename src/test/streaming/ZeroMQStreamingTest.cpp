@@ -11,12 +11,15 @@
 #include <gtest/gtest.h>
 
 #include "OpenZen.h"
+#include "processors/ZmqPublisherHub.h"
 #include "streaming/StreamingProtocol.h"
 #include "streaming/ZenTypesSerialization.h"
 
 #include <cereal/cereal.hpp>
 #include <cereal/archives/binary.hpp>
+#include <cstring>
 #include <sstream>
+#include <thread>
 
 TEST(ZeroMQStreming, acquireAndRelease) {
     // create high-level sensor
@@ -183,3 +186,191 @@ TEST(ZeroMQStreaming, parseGnssMessage) {
     ASSERT_EQ(unpackedMessage->payload.gnssData.sensor, 3);
     ASSERT_EQ(unpackedMessage->payload.gnssData.component, 4);
 }
+
+TEST(ZeroMQStreaming, encodeAndParseBothEncodings) {
+    ZenEvent evt{};
+    evt.eventType = ZenEventType_ImuData;
+    evt.sensor.handle = 3;
+    evt.component.handle = 1;
+    evt.data.imuData.frameCount = 7;
+    evt.data.imuData.g[2] = 25.0f;
+    evt.data.imuData.q[0] = 1.0f;
+
+    for (auto encoding : { zen::Streaming::StreamingEncoding_Cereal, zen::Streaming::StreamingEncoding_FixedLayoutV1,
+                           zen::Streaming::StreamingEncoding_FixedLayoutV2 }) {
+        zmq::message_t msg;
+        ASSERT_TRUE(zen::Streaming::toZmqMessage(evt, msg, encoding));
+        ASSERT_EQ(std::byte(encoding), *static_cast<const std::byte*>(msg.data()));
+
+        auto unpackedMessage = zen::Streaming::fromZmqMessage(msg);
+        ASSERT_TRUE(unpackedMessage.has_value());
+        auto unpackedEvent = zen::Streaming::streamingMessageToZenEvent(*unpackedMessage);
+        ASSERT_TRUE(unpackedEvent.has_value());
+        ASSERT_EQ(ZenEventType_ImuData, unpackedEvent->eventType);
+        ASSERT_EQ(3u, unpackedEvent->sensor.handle);
+        ASSERT_EQ(7, unpackedEvent->data.imuData.frameCount);
+        ASSERT_EQ(25.0f, unpackedEvent->data.imuData.g[2]);
+        ASSERT_EQ(1.0f, unpackedEvent->data.imuData.q[0]);
+    }
+}
+
+TEST(ZeroMQStreaming, rejectTruncatedMessage) {
+    ZenEvent evt{};
+    evt.eventType = ZenEventType_GnssData;
+    evt.component.handle = 2;
+
+    zmq::message_t msg;
+    ASSERT_TRUE(zen::Streaming::toZmqMessage(evt, msg));
+
+    zmq::message_t truncated(msg.data(), msg.size() - 1);
+    ASSERT_FALSE(zen::Streaming::fromZmqMessage(truncated).has_value());
+
+    zmq::message_t headerOnly(msg.data(), zen::Streaming::STREAMING_HEADER_SIZE - 1);
+    ASSERT_FALSE(zen::Streaming::fromZmqMessage(headerOnly).has_value());
+}
+
+TEST(ZeroMQStreaming, packAndUnpackBatch) {
+    std::vector<ZenEvent> events(3);
+    events[0].component.handle = 1;
+    events[0].data.imuData.frameCount = 1;
+    // not streamable, skipped
+    events[1].component.handle = 5;
+    events[2].component.handle = 2;
+    events[2].data.gnssData.frameCount = 2;
+    events[2].data.gnssData.latitude = 35.6635894;
+
+    zmq::message_t msg;
+    ASSERT_EQ(2u, zen::Streaming::toZmqBatchMessage(events, msg));
+
+    std::vector<zen::Streaming::StreamingMessage> unpackedMessages;
+    ASSERT_TRUE(zen::Streaming::unpackZmqMessage(msg, [&unpackedMessages](const zen::Streaming::StreamingMessage& unpacked) {
+        unpackedMessages.push_back(unpacked);
+    }));
+    ASSERT_EQ(2u, unpackedMessages.size());
+    ASSERT_EQ(zen::Streaming::StreamingMessageType_ZenEventImu, unpackedMessages[0].type);
+    ASSERT_EQ(1, unpackedMessages[0].payload.imuData.data.frameCount);
+    ASSERT_EQ(zen::Streaming::StreamingMessageType_ZenEventGnss, unpackedMessages[1].type);
+    ASSERT_EQ(2, unpackedMessages[1].payload.gnssData.data.frameCount);
+    ASSERT_EQ(35.6635894, unpackedMessages[1].payload.gnssData.data.latitude);
+
+    zmq::message_t truncated(msg.data(), msg.size() - 1);
+    ASSERT_FALSE(zen::Streaming::unpackZmqMessage(truncated, [](const zen::Streaming::StreamingMessage&) {}));
+}
+
+TEST(ZeroMQStreaming, sequenceInHeader) {
+    std::vector<ZenEvent> events(2);
+    events[0].component.handle = 1;
+    events[1].component.handle = 1;
+
+    zmq::message_t single;
+    ASSERT_TRUE(zen::Streaming::toZmqMessage(events[0], single, zen::Streaming::StreamingEncoding_FixedLayoutV2));
+    zmq::message_t batch;
+    ASSERT_EQ(2u, zen::Streaming::toZmqBatchMessage(events, batch, zen::Streaming::StreamingEncoding_FixedLayoutV2));
+
+    for (auto* msg : { &single, &batch }) {
+        ASSERT_TRUE(zen::Streaming::setStreamingSequence(*msg, { 42, 123456789 }));
+        const auto sequence = zen::Streaming::streamingSequence(*msg);
+        ASSERT_TRUE(sequence.has_value());
+        ASSERT_EQ(42u, sequence->sequence);
+        ASSERT_EQ(123456789u, sequence->sendTimeNs);
+
+        size_t nMessages = 0;
+        ASSERT_TRUE(zen::Streaming::unpackZmqMessage(*msg, [&nMessages](const zen::Streaming::StreamingMessage&) {
+            ++nMessages;
+        }));
+        ASSERT_EQ(msg == &single ? 1u : 2u, nMessages);
+    }
+
+    // the default encoding carries no sequence, so earlier subscribers can decode it
+    zmq::message_t unsequenced;
+    ASSERT_TRUE(zen::Streaming::toZmqMessage(events[0], unsequenced));
+    ASSERT_FALSE(zen::Streaming::streamingSequence(unsequenced).has_value());
+    ASSERT_FALSE(zen::Streaming::setStreamingSequence(unsequenced, { 1, 1 }));
+}
+
+TEST(ZeroMQStreaming, topicSubscriptions) {
+    ASSERT_EQ("imu/LPMSB2-1234/", zen::Streaming::streamingTopic(zen::Streaming::StreamingMessageType_ZenEventImu, "LPMSB2-1234"));
+
+    using Subscriptions = std::vector<std::string>;
+    ASSERT_EQ(Subscriptions{ "" }, zen::Streaming::streamingSubscriptions(""));
+    ASSERT_EQ(Subscriptions{ "" }, zen::Streaming::streamingSubscriptions("*"));
+    ASSERT_EQ((Subscriptions{ "imu/s1/", "gnss/s1/" }), zen::Streaming::streamingSubscriptions("s1"));
+    ASSERT_EQ(Subscriptions{ "gnss/s1/" }, zen::Streaming::streamingSubscriptions("s1/gnss"));
+    ASSERT_EQ(Subscriptions{ "imu/" }, zen::Streaming::streamingSubscriptions("*/imu"));
+    ASSERT_TRUE(zen::Streaming::streamingSubscriptions("s1/unknown").empty());
+    ASSERT_TRUE(zen::Streaming::streamingSubscriptions("/imu").empty());
+}
+
+TEST(ZeroMQStreaming, sensorsShareEndpoint) {
+    ZenPublishOptions options{};
+    auto hub = zen::ZmqPublisherHub::obtain("tcp://*:8898", options);
+    ASSERT_TRUE(hub.has_value());
+
+    const uintptr_t firstSensor = 1;
+    const uintptr_t secondSensor = 2;
+    std::strcpy(options.sensorTopic, "first");
+    ASSERT_EQ(ZenError_None, (*hub)->add(firstSensor, options));
+
+    // topics identify the sensors on a shared endpoint
+    ASSERT_EQ(ZenError_InvalidArgument, (*hub)->add(secondSensor, options));
+    std::strcpy(options.sensorTopic, "second");
+    ASSERT_EQ(ZenError_None, (*hub)->add(secondSensor, options));
+
+    // a sensor is only published under one topic
+    std::strcpy(options.sensorTopic, "third");
+    ASSERT_EQ(ZenError_InvalidArgument, (*hub)->add(firstSensor, options));
+
+    // the remote sensor only subscribes to the events of the second sensor
+    auto remoteClient = zen::make_client();
+    auto remoteSensor = remoteClient.second.obtainSensorByName("ZeroMQ", "tcp://127.0.0.1:8898#second");
+    ASSERT_EQ(ZenError_None, remoteSensor.first);
+
+    auto imuEvent = [](uintptr_t sensor) {
+        ZenEvent event{};
+        event.eventType = ZenEventType_ImuData;
+        event.sensor.handle = sensor;
+        event.component.handle = 1;
+        event.data.imuData.timestamp = static_cast<double>(sensor);
+        return event;
+    };
+
+    // keep publishing until the subscription has been established
+    for (int idx = 0; idx < 20; ++idx)
+    {
+        (*hub)->eventQueue().push(imuEvent(firstSensor));
+        (*hub)->eventQueue().push(imuEvent(secondSensor));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    auto sensorData = remoteClient.second.pollNextEvent();
+    ASSERT_TRUE(sensorData.has_value());
+    do
+    {
+        ASSERT_EQ(ZenEventType_ImuData, sensorData->eventType);
+        ASSERT_EQ(static_cast<double>(secondSensor), sensorData->data.imuData.timestamp);
+    } while ((sensorData = remoteClient.second.pollNextEvent()));
+}
+
+TEST(ZeroMQStreaming, publisherSocketOptions) {
+    auto localClient = zen::make_client();
+    auto sensor = localClient.second.obtainSensorByName("TestSensor", "");
+    ASSERT_EQ(ZenError_None, sensor.first);
+    ASSERT_EQ(ZenError_NotSupported, sensor.second.publishStatistics().first);
+
+    // conflated messages cannot carry topic frames
+    ZenPublishOptions options{};
+    options.conflate = true;
+    std::strcpy(options.sensorTopic, "conflated");
+    ASSERT_EQ(ZenError_InvalidArgument, sensor.second.publishEvents("tcp://*:8899", options));
+
+    options.sensorTopic[0] = '\0';
+    options.sendHighWaterMark = 10;
+    options.lingerMs = -1;
+    options.countDrops = true;
+    ASSERT_EQ(ZenError_None, sensor.second.publishEvents("tcp://*:8899", options));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const auto statistics = sensor.second.publishStatistics();
+    ASSERT_EQ(ZenError_None, statistics.first);
+    ASSERT_GT(statistics.second.sentMessages + statistics.second.droppedMessages, 0u);
+}
@@ -0,0 +1,120 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "streaming/StreamingMessage.h"
+#include "utility/linux/SharedMemoryRing.h"
+
+using namespace zen;
+using namespace std::chrono_literals;
+
+namespace {
+    std::string uniqueRingName(const char* test) {
+        return std::string("test-") + test + "-" + std::to_string(::getpid());
+    }
+
+    std::vector<std::byte> entryOf(uint8_t value, size_t size) {
+        return std::vector<std::byte>(size, std::byte(value));
+    }
+}
+
+TEST(SharedMemoryRing, readEntriesInOrder) {
+    const auto name = uniqueRingName("order");
+    auto writer = SharedMemoryRing::create(name, 16, 8);
+    ASSERT_TRUE(writer.has_value());
+
+    // only one writer per name
+    ASSERT_FALSE(SharedMemoryRing::create(name, 16, 8).has_value());
+
+    auto reader = SharedMemoryRing::open(name);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(16u, (*reader)->slotSize());
+
+    std::vector<std::byte> buffer(16);
+    ASSERT_EQ(0u, (*reader)->read(buffer, 0ms));
+    ASSERT_EQ(ZenError_InvalidArgument, (*writer)->write(entryOf(1, 17)));
+
+    ASSERT_EQ(ZenError_None, (*writer)->write(entryOf(1, 4)));
+    ASSERT_EQ(ZenError_None, (*writer)->write(entryOf(2, 16)));
+
+    ASSERT_EQ(4u, (*reader)->read(buffer, 0ms));
+    ASSERT_EQ(std::byte(1), buffer[3]);
+    ASSERT_EQ(16u, (*reader)->read(buffer, 0ms));
+    ASSERT_EQ(std::byte(2), buffer[15]);
+    ASSERT_EQ(0u, (*reader)->lostEntries());
+
+    // a waiting reader is woken up by the writer
+    std::thread delayedWriter([&writer]() {
+        std::this_thread::sleep_for(20ms);
+        (*writer)->write(entryOf(3, 8));
+    });
+    ASSERT_EQ(8u, (*reader)->read(buffer, 5000ms));
+    ASSERT_EQ(std::byte(3), buffer[0]);
+    delayedWriter.join();
+
+    writer->reset();
+    ASSERT_TRUE((*reader)->closed());
+    ASSERT_EQ(0u, (*reader)->read(buffer, 5000ms));
+    ASSERT_FALSE(SharedMemoryRing::open(name).has_value());
+}
+
+TEST(SharedMemoryRing, skipOverwrittenEntries) {
+    const auto name = uniqueRingName("lapped");
+    auto writer = SharedMemoryRing::create(name, 8, 4);
+    ASSERT_TRUE(writer.has_value());
+    auto reader = SharedMemoryRing::open(name);
+    ASSERT_TRUE(reader.has_value());
+
+    // the writer laps the reader, which resumes with entries that are still in the ring
+    for (uint8_t value = 0; value < 10; ++value)
+        ASSERT_EQ(ZenError_None, (*writer)->write(entryOf(value, 8)));
+
+    std::vector<std::byte> buffer(8);
+    ASSERT_EQ(8u, (*reader)->read(buffer, 0ms));
+    ASSERT_EQ(std::byte(8), buffer[0]);
+    ASSERT_EQ(8u, (*reader)->lostEntries());
+    ASSERT_EQ(8u, (*reader)->read(buffer, 0ms));
+    ASSERT_EQ(std::byte(9), buffer[0]);
+    ASSERT_EQ(0u, (*reader)->read(buffer, 0ms));
+}
+
+TEST(SharedMemoryRing, transportStreamingRecords) {
+    const auto name = uniqueRingName("records");
+    auto writer = SharedMemoryRing::create(name, static_cast<uint32_t>(Streaming::maxRecordSize()));
+    ASSERT_TRUE(writer.has_value());
+    auto reader = SharedMemoryRing::open(name);
+    ASSERT_TRUE(reader.has_value());
+
+    ZenEvent imuEvent{};
+    imuEvent.component.handle = 1;
+    imuEvent.sensor.handle = 7;
+    imuEvent.data.imuData.timestamp = 12.5;
+
+    std::vector<std::byte> record((*writer)->slotSize());
+    const size_t size = Streaming::writeRecord(imuEvent, record.data());
+    ASSERT_EQ(ZenError_None, (*writer)->write(gsl::make_span(record.data(), size)));
+
+    std::vector<std::byte> buffer((*reader)->slotSize());
+    ASSERT_EQ(size, (*reader)->read(buffer, 0ms));
+
+    Streaming::StreamingMessage message;
+    ASSERT_EQ(size, Streaming::readRecord(buffer.data(), size, message));
+    const auto received = Streaming::streamingMessageToZenEvent(message);
+    ASSERT_TRUE(received.has_value());
+    ASSERT_EQ(7u, received->sensor.handle);
+    ASSERT_EQ(12.5, received->data.imuData.timestamp);
+}
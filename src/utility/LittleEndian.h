@@ -0,0 +1,56 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_UTILITY_LITTLEENDIAN_H_
+#define ZEN_UTILITY_LITTLEENDIAN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace zen
+{
+    /** Unsigned integer of the same size, to encode scalars byte by byte */
+    template <size_t Size> struct UnsignedOfSize {};
+    template <> struct UnsignedOfSize<1> { using type = uint8_t; };
+    template <> struct UnsignedOfSize<2> { using type = uint16_t; };
+    template <> struct UnsignedOfSize<4> { using type = uint32_t; };
+    template <> struct UnsignedOfSize<8> { using type = uint64_t; };
+
+    template <typename T>
+    using Unsigned = typename UnsignedOfSize<sizeof(T)>::type;
+
+    /** Writes a scalar in little-endian byte order, independent of the host, and returns the position after it */
+    template <typename T>
+    std::byte* writeLittleEndian(std::byte* dst, T value) noexcept
+    {
+        Unsigned<T> raw;
+        std::memcpy(&raw, &value, sizeof(T));
+
+        for (size_t idx = 0; idx < sizeof(T); ++idx)
+            *dst++ = static_cast<std::byte>((raw >> (8 * idx)) & 0xff);
+
+        return dst;
+    }
+
+    /** Reads a scalar in little-endian byte order, independent of the host, and returns the position after it */
+    template <typename T>
+    const std::byte* readLittleEndian(const std::byte* src, T& value) noexcept
+    {
+        Unsigned<T> raw = 0;
+        for (size_t idx = 0; idx < sizeof(T); ++idx)
+            raw |= static_cast<Unsigned<T>>(std::to_integer<Unsigned<T>>(*src++) << (8 * idx));
+
+        std::memcpy(&value, &raw, sizeof(T));
+        return src;
+    }
+}
+
+#endif
@@ -11,6 +11,7 @@
 #ifndef ZEN_UTILITY_LOCKINGQUEUE_H_
 #define ZEN_UTILITY_LOCKINGQUEUE_H_
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -106,6 +107,31 @@ namespace zen
             return result;
         }
 
+        /** Like waitToPop, but also returns an empty optional when the deadline passes */
+        template <class Clock, class Duration>
+        std::optional<T> waitToPopUntil(const std::chrono::time_point<Clock, Duration>& deadline) noexcept
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            ++m_nWaiters;
+            const bool ready = m_cv.wait_until(lock, deadline, [this]() { return !m_container.empty() || m_terminate; });
+            --m_nWaiters;
+
+            if (m_terminate)
+            {
+                lock.unlock();
+                m_cv.notify_all();
+                return std::nullopt;
+            }
+
+            if (!ready)
+                return std::nullopt;
+
+            std::optional<T> result(std::move(m_container.front()));
+            m_container.pop_front();
+            return result;
+        }
+
     private:
         Container m_container;
         std::condition_variable m_cv;
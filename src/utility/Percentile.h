@@ -0,0 +1,28 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_UTILITY_PERCENTILE_H_
+#define ZEN_UTILITY_PERCENTILE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace zen
+{
+    /** Returns the nearest-rank percentile of ascending, non-empty samples, with fraction in (0, 1] */
+    inline float percentile(const std::vector<float>& sorted, double fraction) noexcept
+    {
+        const auto index = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<size_t>(index, 1)) - 1];
+    }
+}
+
+#endif
@@ -12,6 +12,8 @@
 #define ZEN_UTILITY_STRING_H_
 
 #include <algorithm>
+#include <cctype>
+#include <string>
 #include <string_view>
 #include <vector>
 #include <sstream>
@@ -90,6 +92,17 @@ namespace util
             return false;
         }
     }
+
+    /** Replaces every character except letters, digits, '-' and '_', so the name can be part of a file name */
+    inline std::string sanitizeFileName(std::string_view name)
+    {
+        std::string result(name);
+        for (auto& c : result)
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_')
+                c = '_';
+
+        return result;
+    }
 }
 
 #endif
@@ -0,0 +1,355 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#include "utility/linux/SharedMemoryRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace zen
+{
+    namespace
+    {
+        constexpr uint32_t RING_MAGIC = 0x5a524e47; // "ZRNG"
+        constexpr uint32_t RING_VERSION = 1;
+        constexpr size_t CACHE_LINE_SIZE = 64;
+
+        /** Longest ring name, well below NAME_MAX of the shared memory file system */
+        constexpr size_t MAX_NAME_LENGTH = 200;
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+            "Atomics in shared memory need to be lock-free");
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The futex word needs to be 32 bits");
+
+        std::string sharedMemoryPath(const std::string& name)
+        {
+            return "/openzen-" + name;
+        }
+
+        bool isValidName(const std::string& name) noexcept
+        {
+            return !name.empty() && name.size() <= MAX_NAME_LENGTH && name.find('/') == std::string::npos;
+        }
+
+        size_t roundUpToCacheLine(size_t size) noexcept
+        {
+            return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        }
+
+        // the futex is not process-private, because the ring is mapped by several processes
+        void futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) noexcept
+        {
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+            struct timespec relative;
+            relative.tv_sec = static_cast<time_t>(seconds.count());
+            relative.tv_nsec = static_cast<long>((timeout - seconds).count());
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+        }
+
+        void futexWakeAll(std::atomic<uint32_t>& word) noexcept
+        {
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+    struct SharedMemoryRing::Header
+    {
+        /** Written last by the writer, so readers never see a partially initialized ring */
+        std::atomic<uint32_t> magic;
+        uint32_t version;
+        uint32_t slotSize;
+        uint32_t slotCount;
+        uint32_t slotStride;
+        int32_t writerPid;
+
+        /** Sequence number of the next entry, all entries before it are complete */
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writeSequence;
+
+        /** Futex word, which is incremented whenever waiting readers are woken up */
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> wakeCount;
+        std::atomic<uint32_t> waiters;
+        std::atomic<uint32_t> closed;
+    };
+
+    struct SharedMemoryRing::Slot
+    {
+        /** Sequence number of the entry plus one, or zero while the slot is empty or being written */
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint32_t> size;
+
+        std::byte* data() noexcept { return reinterpret_cast<std::byte*>(this) + sizeof(Slot); }
+    };
+
+    namespace
+    {
+        /** Removes the shared memory object of a ring whose writer died without cleaning up. Returns whether it was removed. */
+        template <typename Header>
+        bool removeStaleRing(const std::string& path) noexcept
+        {
+            const int fd = ::shm_open(path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+            if (fd == -1)
+                return errno == ENOENT;
+
+            struct stat info;
+            void* memory = MAP_FAILED;
+            if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header))
+                memory = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+
+            if (memory == MAP_FAILED)
+                return false;
+
+            const auto* header = static_cast<const Header*>(memory);
+            const bool stale = header->magic.load(std::memory_order_acquire) == RING_MAGIC &&
+                ::kill(header->writerPid, 0) == -1 && errno == ESRCH;
+            ::munmap(memory, sizeof(Header));
+
+            return stale && ::shm_unlink(path.c_str()) == 0;
+        }
+    }
+
+    nonstd::expected<std::unique_ptr<SharedMemoryRing>, ZenError> SharedMemoryRing::create(const std::string& name, uint32_t slotSize,
+        uint32_t slotCount) noexcept
+    {
+        if (!isValidName(name) || slotSize == 0 || slotCount == 0)
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+        const auto path = sharedMemoryPath(name);
+        int fd = ::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        if (fd == -1 && errno == EEXIST && removeStaleRing<Header>(path))
+        {
+            spdlog::warn("Removed shared memory ring {0} of a terminated process", name);
+            fd = ::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        }
+
+        if (fd == -1)
+        {
+            const int error = errno;
+            spdlog::error("Cannot create shared memory ring {0} because: {1}", name, std::strerror(error));
+            return nonstd::make_unexpected(error == EEXIST ? ZenError_InvalidArgument : ZenError_Io_InitFailed);
+        }
+
+        const size_t stride = roundUpToCacheLine(sizeof(Slot) + slotSize);
+        const size_t size = sizeof(Header) + stride * slotCount;
+
+        void* memory = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+            memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (memory == MAP_FAILED)
+        {
+            spdlog::error("Cannot map shared memory ring {0} because: {1}", name, std::strerror(errno));
+            ::shm_unlink(path.c_str());
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        // the slots are zeroed by ftruncate, i.e. empty
+        auto* header = new (memory) Header;
+        header->version = RING_VERSION;
+        header->slotSize = slotSize;
+        header->slotCount = slotCount;
+        header->slotStride = static_cast<uint32_t>(stride);
+        header->writerPid = static_cast<int32_t>(::getpid());
+        header->writeSequence.store(0, std::memory_order_relaxed);
+        header->wakeCount.store(0, std::memory_order_relaxed);
+        header->waiters.store(0, std::memory_order_relaxed);
+        header->closed.store(0, std::memory_order_relaxed);
+        header->magic.store(RING_MAGIC, std::memory_order_release);
+
+        return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(name, memory, size, true));
+    }
+
+    nonstd::expected<std::unique_ptr<SharedMemoryRing>, ZenError> SharedMemoryRing::open(const std::string& name) noexcept
+    {
+        if (!isValidName(name))
+            return nonstd::make_unexpected(ZenError_InvalidArgument);
+
+        const int fd = ::shm_open(sharedMemoryPath(name).c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            spdlog::error("Cannot open shared memory ring {0} because: {1}", name, std::strerror(errno));
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        struct stat info;
+        void* memory = MAP_FAILED;
+        const size_t size = ::fstat(fd, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+        if (size >= sizeof(Header))
+            memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (memory == MAP_FAILED)
+        {
+            spdlog::error("Cannot map shared memory ring {0}", name);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        // the layout comes from another process, so it is checked against the mapped size
+        const auto* header = static_cast<const Header*>(memory);
+        const bool valid = header->magic.load(std::memory_order_acquire) == RING_MAGIC &&
+            header->version == RING_VERSION && header->slotSize != 0 && header->slotCount != 0 &&
+            header->slotStride >= sizeof(Slot) + header->slotSize && header->slotStride % CACHE_LINE_SIZE == 0 &&
+            sizeof(Header) + size_t(header->slotStride) * header->slotCount <= size;
+        if (!valid)
+        {
+            spdlog::error("Shared memory ring {0} has an unsupported layout", name);
+            ::munmap(memory, size);
+            return nonstd::make_unexpected(ZenError_Io_InitFailed);
+        }
+
+        return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(name, memory, size, false));
+    }
+
+    SharedMemoryRing::SharedMemoryRing(std::string name, void* memory, size_t size, bool writer) noexcept
+        : m_name(std::move(name))
+        , m_memory(memory)
+        , m_size(size)
+        , m_header(static_cast<Header*>(memory))
+        , m_slots(static_cast<std::byte*>(memory) + sizeof(Header))
+        , m_writer(writer)
+        , m_slotSize(m_header->slotSize)
+        , m_slotCount(m_header->slotCount)
+        , m_slotStride(m_header->slotStride)
+        , m_cursor(m_header->writeSequence.load(std::memory_order_acquire))
+        , m_lostEntries(0)
+    {}
+
+    SharedMemoryRing::~SharedMemoryRing()
+    {
+        if (m_writer)
+        {
+            // readers which still map the ring notice that no more entries follow
+            m_header->closed.store(1, std::memory_order_seq_cst);
+            m_header->wakeCount.fetch_add(1, std::memory_order_seq_cst);
+            futexWakeAll(m_header->wakeCount);
+
+            ::shm_unlink(sharedMemoryPath(m_name).c_str());
+        }
+
+        ::munmap(m_memory, m_size);
+    }
+
+    ZenError SharedMemoryRing::write(gsl::span<const std::byte> entry) noexcept
+    {
+        if (!m_writer)
+            return ZenError_NotSupported;
+        if (entry.empty() || entry.size() > m_slotSize)
+            return ZenError_InvalidArgument;
+
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        const uint64_t sequence = m_header->writeSequence.load(std::memory_order_relaxed);
+        Slot& target = slot(sequence);
+
+        // readers which copy the previous entry of the slot meanwhile discard their copy
+        target.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        target.size.store(static_cast<uint32_t>(entry.size()), std::memory_order_relaxed);
+        std::memcpy(target.data(), entry.data(), entry.size());
+        target.sequence.store(sequence + 1, std::memory_order_release);
+
+        m_header->writeSequence.store(sequence + 1, std::memory_order_seq_cst);
+        if (m_header->waiters.load(std::memory_order_seq_cst) != 0)
+        {
+            m_header->wakeCount.fetch_add(1, std::memory_order_seq_cst);
+            futexWakeAll(m_header->wakeCount);
+        }
+
+        return ZenError_None;
+    }
+
+    size_t SharedMemoryRing::read(gsl::span<std::byte> buffer, std::chrono::milliseconds timeout) noexcept
+    {
+        if (m_writer || buffer.size() < m_slotSize)
+            return 0;
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            // the wake count is loaded first, so a wake-up after the check below is not missed
+            const uint32_t wakeCount = m_header->wakeCount.load(std::memory_order_seq_cst);
+            const uint64_t written = m_header->writeSequence.load(std::memory_order_seq_cst);
+
+            if (m_cursor < written)
+            {
+                if (written - m_cursor <= m_slotCount)
+                {
+                    Slot& source = slot(m_cursor);
+                    const uint64_t stamp = source.sequence.load(std::memory_order_acquire);
+                    if (stamp == m_cursor + 1)
+                    {
+                        const size_t size = std::min(source.size.load(std::memory_order_relaxed), m_slotSize);
+                        std::memcpy(buffer.data(), source.data(), size);
+
+                        // the copy is only valid if the writer did not start to overwrite the slot meanwhile
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (source.sequence.load(std::memory_order_relaxed) == stamp)
+                        {
+                            ++m_cursor;
+                            return size;
+                        }
+                    }
+                }
+
+                skipLostEntries();
+                continue;
+            }
+
+            if (closed())
+                return 0;
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+                return 0;
+
+            m_header->waiters.fetch_add(1, std::memory_order_seq_cst);
+            if (m_header->writeSequence.load(std::memory_order_seq_cst) == written)
+                futexWait(m_header->wakeCount, wakeCount, deadline - now);
+            m_header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+    bool SharedMemoryRing::closed() const noexcept
+    {
+        return m_header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    SharedMemoryRing::Slot& SharedMemoryRing::slot(uint64_t sequence) const noexcept
+    {
+        return *reinterpret_cast<Slot*>(m_slots + (sequence % m_slotCount) * m_slotStride);
+    }
+
+    void SharedMemoryRing::skipLostEntries() noexcept
+    {
+        // resume half a lap behind the writer, so the next entries are not overwritten right away
+        const uint64_t written = m_header->writeSequence.load(std::memory_order_acquire);
+        const uint64_t resume = std::max(m_cursor + 1, written - std::min<uint64_t>(written, m_slotCount / 2));
+
+        m_lostEntries += resume - m_cursor;
+        m_cursor = resume;
+    }
+}
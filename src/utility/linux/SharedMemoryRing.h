@@ -0,0 +1,105 @@
+//===========================================================================//
+//
+// Copyright (C) 2020 LP-Research Inc.
+//
+// This file is part of OpenZen, under the MIT License.
+// See https://bitbucket.org/lpresearch/openzen/src/master/LICENSE for details
+// SPDX-License-Identifier: MIT
+//
+//===========================================================================//
+
+#ifndef ZEN_UTILITY_LINUX_SHAREDMEMORYRING_H_
+#define ZEN_UTILITY_LINUX_SHAREDMEMORYRING_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <gsl/span>
+#include <nonstd/expected.hpp>
+
+#include "ZenTypes.h"
+
+namespace zen
+{
+    /**
+    Ring buffer of fixed-size slots in a named POSIX shared memory object (/dev/shm/openzen-<name>),
+    which one process writes and any number of processes read.
+
+    Every entry gets the next sequence number. A slot is stamped with the sequence number of its
+    entry after the entry was copied into it and cleared before it is overwritten, so a reader
+    detects entries which were overwritten while it copied them. Readers do not hold the writer
+    back: a reader which falls more than a lap behind skips the overwritten entries and counts
+    them as lost. Waiting readers are woken with a futex, which the writer only signals if there
+    are waiting readers.
+    */
+    class SharedMemoryRing
+    {
+    public:
+        constexpr static uint32_t DEFAULT_SLOT_COUNT = 4096;
+
+        /** Creates the ring and its shared memory object, which is removed when the ring is destroyed.
+         * Fails if another living process writes a ring of the same name.
+         */
+        static nonstd::expected<std::unique_ptr<SharedMemoryRing>, ZenError> create(const std::string& name, uint32_t slotSize,
+            uint32_t slotCount = DEFAULT_SLOT_COUNT) noexcept;
+
+        /** Opens the ring of a writer for reading, starting with the next entry it writes */
+        static nonstd::expected<std::unique_ptr<SharedMemoryRing>, ZenError> open(const std::string& name) noexcept;
+
+        ~SharedMemoryRing();
+
+        /** Appends an entry of at most slotSize() bytes and wakes up waiting readers. Thread-safe. */
+        ZenError write(gsl::span<const std::byte> entry) noexcept;
+
+        /** Copies the next entry into a buffer of at least slotSize() bytes and returns its size.
+         * Returns 0 if no entry was written within the timeout or the writer closed the ring.
+         */
+        size_t read(gsl::span<std::byte> buffer, std::chrono::milliseconds timeout) noexcept;
+
+        /** Returns whether the writer destroyed the ring */
+        bool closed() const noexcept;
+
+        /** Number of entries the reader skipped because the writer overwrote them */
+        uint64_t lostEntries() const noexcept { return m_lostEntries; }
+
+        uint32_t slotSize() const noexcept { return m_slotSize; }
+
+        const std::string& name() const noexcept { return m_name; }
+
+    private:
+        struct Header;
+        struct Slot;
+
+        SharedMemoryRing(std::string name, void* memory, size_t size, bool writer) noexcept;
+
+        Slot& slot(uint64_t sequence) const noexcept;
+
+        /** Moves the reader's cursor past the entries which the writer overwrote */
+        void skipLostEntries() noexcept;
+
+        const std::string m_name;
+        void* const m_memory;
+        const size_t m_size;
+        Header* const m_header;
+        std::byte* const m_slots;
+        const bool m_writer;
+
+        /** Layout of the ring, which is not read from the shared memory again */
+        const uint32_t m_slotSize;
+        const uint32_t m_slotCount;
+        const size_t m_slotStride;
+
+        /** Serializes the writing threads of this process */
+        std::mutex m_writeMutex;
+
+        /** Sequence number of the next entry to read */
+        uint64_t m_cursor;
+        uint64_t m_lostEntries;
+    };
+}
+
+#endif